@@ -0,0 +1,74 @@
+#!/bin/bash
+
+### Builds and runs the micro benchmarks, optionally comparing them against a
+### baseline produced by an earlier run.
+### Usage: ./bench.sh [baseline.json] [max_slowdown_percent]
+### The results are written to build/bench.json, copy that file to keep it as
+### a baseline. Exits with a non-zero status if any benchmark got slower than
+### the baseline by more than max_slowdown_percent (default: 10).
+
+function catch_errors() {
+    printf "\nbench.sh failed!\n" >&2
+    exit 1
+}
+
+trap catch_errors ERR;
+
+# Directory containing this bash script
+readonly DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
+
+readonly PREV_DIR=$(pwd)
+
+readonly BASELINE=$1
+readonly MAX_SLOWDOWN_PERCENT=${2:-10}
+
+readonly RESULT=$DIR/build/bench.json
+
+$DIR/build.sh Release
+
+cd $DIR/build
+
+# The median of several repetitions is robust against the occasional outlier.
+./vector_clocks_bench \
+    --benchmark_repetitions=5 \
+    --benchmark_report_aggregates_only=true \
+    --benchmark_out=$RESULT \
+    --benchmark_out_format=json
+
+cd $PREV_DIR
+
+if [ -z "$BASELINE" ]; then
+    exit 0
+fi
+
+python3 - "$BASELINE" "$RESULT" "$MAX_SLOWDOWN_PERCENT" <<'PYTHON'
+import json
+import sys
+
+def medians(path):
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+    return {b["run_name"]: b["cpu_time"] for b in benchmarks
+            if b.get("aggregate_name") == "median"}
+
+baseline = medians(sys.argv[1])
+current = medians(sys.argv[2])
+max_slowdown = float(sys.argv[3])
+regressions = 0
+
+for name, cpu_time in sorted(current.items()):
+    if name not in baseline:
+        continue
+    change = (cpu_time / baseline[name] - 1.0) * 100.0
+    is_regression = change > max_slowdown
+    regressions += is_regression
+    print("{:<64} {:>+8.1f}%{}".format(
+        name, change, "  REGRESSION" if is_regression else ""))
+
+if regressions:
+    print("{} benchmarks got slower by more than {}%.".format(
+        regressions, max_slowdown))
+    sys.exit(1)
+PYTHON
+
+exit 0
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+#include <random>
+#include <unordered_map>
+
+#include <benchmark/benchmark.h>
+
+#include "vector_timestamp.hpp"
+
+namespace vc::bench {
+/**
+ * How the actor_ids of the generated vector timestamps are distributed.
+ */
+enum class key_distribution : int64_t {
+  dense = 0, /**< Consecutive actor_ids, starting at 1 */
+  random = 1 /**< Uniformly distributed 64 bit actor_ids */
+};
+
+/**
+ * Creates the actor_id / clock pairs of a vector timestamp.
+ * @param actor_count The amount of actors.
+ * @param distribution How the actor_ids are distributed.
+ * @param seed The seed of the random numbers, so that the same keys can be
+ *             generated again.
+ * @return The actor_id / clock pairs.
+ */
+inline std::unordered_map<actor_id, uint64_t>
+make_entries(int64_t actor_count, key_distribution distribution,
+             uint64_t seed = 1) {
+  std::mt19937_64 engine(seed);
+  std::uniform_int_distribution<uint64_t> clocks(0, 1000000);
+  std::unordered_map<actor_id, uint64_t> entries;
+  entries.reserve(static_cast<size_t>(actor_count));
+
+  for (int64_t i = 0; static_cast<int64_t>(entries.size()) < actor_count;
+       ++i) {
+    const auto aid = distribution == key_distribution::dense
+                       ? static_cast<uint64_t>(i + 1)
+                       : engine();
+    entries.emplace(actor_id(aid), clocks(engine));
+  }
+
+  return entries;
+}
+
+/**
+ * Creates the vector timestamp described by the arguments of a benchmark.
+ * @param state The state of the benchmark, whose first argument is the
+ *              amount of actors and whose second one the key_distribution.
+ * @param seed The seed of the random numbers.
+ * @return The vector timestamp.
+ */
+inline vector_timestamp make_vstamp(const benchmark::State& state,
+                                    uint64_t seed = 1) {
+  return vector_timestamp::from_entries(make_entries(
+    state.range(0), static_cast<key_distribution>(state.range(1)), seed));
+}
+
+/**
+ * Registers the actor counts 1 to 10000 and both key distributions as the
+ * arguments of a benchmark.
+ * @param b The benchmark.
+ */
+inline void actor_counts(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"actors", "random_keys"});
+
+  for (int64_t distribution = 0; distribution <= 1; ++distribution)
+    for (int64_t actor_count = 1; actor_count <= 10000; actor_count *= 10)
+      b->Args({actor_count, distribution});
+}
+} // namespace vc::bench
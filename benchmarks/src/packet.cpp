@@ -0,0 +1,42 @@
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_vstamps.hpp"
+#include "packet.hpp"
+
+namespace {
+constexpr char payload[] = "GIEVTIMEPLX";
+
+vc::packet make_packet(const benchmark::State& state) {
+  const auto vstamp_binary = vc::bench::make_vstamp(state)
+                               .serialize_to_binary();
+  return vc::packet(vc::opcode::time, 0, vstamp_binary.data(),
+                    vstamp_binary.size(), payload, sizeof(payload));
+}
+
+void bm_packet_serialize_to_binary(benchmark::State& state) {
+  const auto pkt = make_packet(state);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(pkt.serialize_to_binary());
+
+  state.SetBytesProcessed(
+    state.iterations()
+    * static_cast<int64_t>(pkt.serialize_to_binary().size()));
+}
+
+void bm_packet_deserialize_from_binary(benchmark::State& state) {
+  const auto binary = make_packet(state).serialize_to_binary();
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+      vc::packet::deserialize_from_binary(binary.data(), binary.size()));
+
+  state.SetBytesProcessed(state.iterations()
+                          * static_cast<int64_t>(binary.size()));
+}
+} // namespace
+
+BENCHMARK(bm_packet_serialize_to_binary)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_packet_deserialize_from_binary)->Apply(vc::bench::actor_counts);
@@ -0,0 +1,95 @@
+#include <cstdint>
+
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_vstamps.hpp"
+#include "vector_timestamp.hpp"
+
+namespace {
+void bm_from_entries(benchmark::State& state) {
+  const auto entries = vc::bench::make_entries(
+    state.range(0), static_cast<vc::bench::key_distribution>(state.range(1)));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(vc::vector_timestamp::from_entries(entries));
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_tick(benchmark::State& state) {
+  auto vstamp = vc::bench::make_vstamp(state);
+  const auto aid = vstamp.entries().begin()->first;
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(vstamp.tick(aid));
+}
+
+void bm_merge(benchmark::State& state) {
+  // Same actors, different clocks, which is the steady state of a server.
+  auto vstamp = vc::bench::make_vstamp(state, 1);
+  auto other = vstamp;
+
+  for (const auto& [aid, clock] : vstamp.entries())
+    for (uint64_t i = 0; i < clock % 3U; ++i)
+      (void) other.tick(aid);
+
+  for (auto _ : state) {
+    vstamp.merge(other);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_equal(benchmark::State& state) {
+  // Equal vector timestamps, so that every entry is compared.
+  const auto lhs = vc::bench::make_vstamp(state);
+  const auto rhs = lhs;
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(lhs == rhs);
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_serialize_to_binary(benchmark::State& state) {
+  const auto vstamp = vc::bench::make_vstamp(state);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(vstamp.serialize_to_binary());
+
+  state.SetBytesProcessed(
+    state.iterations()
+    * static_cast<int64_t>(vstamp.serialize_to_binary().size()));
+}
+
+void bm_deserialize_from_binary(benchmark::State& state) {
+  const auto binary = vc::bench::make_vstamp(state).serialize_to_binary();
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(vc::vector_timestamp::deserialize_from_binary(
+      binary.data(), binary.size()));
+
+  state.SetBytesProcessed(state.iterations()
+                          * static_cast<int64_t>(binary.size()));
+}
+
+void bm_to_json(benchmark::State& state) {
+  const auto vstamp = vc::bench::make_vstamp(state);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(vstamp.to_json());
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+BENCHMARK(bm_from_entries)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_tick)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_merge)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_equal)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_serialize_to_binary)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_deserialize_from_binary)->Apply(vc::bench::actor_counts);
+BENCHMARK(bm_to_json)->Apply(vc::bench::actor_counts);
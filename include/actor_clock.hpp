@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <functional>
+#include <memory_resource>
+
+#include <tl/expected.hpp>
+
+#include "actor_id.hpp"
+#include "byte_order.hpp"
+#include "error.hpp"
+#include "opcode.hpp"
+#include "packet.hpp"
+#include "vector_timestamp.hpp"
+
+namespace vc {
+/**
+ * Takes the packets an actor_clock sends, e.g. to queue them for a socket or
+ * to deliver them over a simulated network. The sink may amend the packet,
+ * e.g. with a trace context, which is only valid during the call.
+ */
+using packet_sink = std::function<void(packet&)>;
+
+/**
+ * Which entries of the own vector timestamp are sent along with a packet.
+ */
+enum class sent_entries {
+  all, /**< The whole vector timestamp */
+  own  /**< Only the sending actor's own entry */
+};
+
+/**
+ * Applies the vector clock rules of an actor to the packets it receives and
+ * sends, regardless of how the packets travel.
+ *
+ * Receiving a packet decodes its vector timestamp, ticks the own clock and
+ * merges. Sending a packet ticks the own clock and encodes the vector
+ * timestamp into the packet, which is handed to a packet_sink. The client and
+ * the server exchange their packets this way over sockets, the simulator
+ * over a simulated network.
+ */
+class actor_clock {
+public:
+  /**
+   * Creates an actor_clock.
+   * @param aid The actor_id of the actor.
+   * @param vstamp The vector timestamp of the actor, must outlive the
+   *               actor_clock.
+   * @param resource The memory resource to decode and encode in, e.g. an
+   *                 arena released after each packet.
+   */
+  actor_clock(actor_id aid, vector_timestamp& vstamp,
+              std::pmr::memory_resource* resource) noexcept;
+
+  /**
+   * Handles a packet as a receive event.
+   * @param pkt The packet received.
+   * @return An expected containing the amount of entries of the vector
+   *         timestamp merged; an error if the vector timestamp couldn't be
+   *         decoded or, with errc::missing_own_clock, if the own clock couldn't
+   *         be ticked.
+   */
+  [[nodiscard]] tl::expected<size_t, error> receive(const packet& pkt);
+
+  /**
+   * Sends a packet as a send event.
+   * @param op The opcode of the packet.
+   * @param flags The flags of the packet, packet::little_endian_vstamp_flag
+   *              is added if `order` is little-endian.
+   * @param order The byte order to encode the vector timestamp in.
+   * @param entries Which entries of the vector timestamp to send.
+   * @param payload_data Pointer to the start of the payload.
+   * @param payload_byte_count Size of the payload in bytes.
+   * @param sink Takes the packet.
+   * @return true on success; false if the own clock couldn't be ticked.
+   */
+  [[nodiscard]] bool send(opcode op, uint16_t flags, byte_order order,
+                          sent_entries entries, const void* payload_data,
+                          size_t payload_byte_count, const packet_sink& sink);
+
+  /**
+   * Responds to a request whose response doesn't depend on the actor's
+   * state: an echo request is sent its payload back, a clock_sync request an
+   * acknowledgement, as the merged vector timestamp is the actual response.
+   * @param request The request, which must have been received already.
+   * @param order The byte order to encode the vector timestamp in.
+   * @param entries Which entries of the vector timestamp to send.
+   * @param sink Takes the response.
+   * @return true on success; false if the request is neither an echo nor a
+   *         clock_sync request or the own clock couldn't be ticked.
+   */
+  [[nodiscard]] bool answer(const packet& request, byte_order order,
+                            sent_entries entries, const packet_sink& sink);
+
+private:
+  actor_id aid_;
+  vector_timestamp& vstamp_;
+  std::pmr::memory_resource* resource_;
+};
+} // namespace vc
@@ -5,6 +5,8 @@
 
 #include <QString>
 
+#include <fmt/format.h>
+
 #include <pl/total_order.hpp>
 
 namespace vc {
@@ -81,3 +83,21 @@ struct hash<::vc::actor_id> {
   }
 };
 } // namespace std
+
+namespace fmt {
+/**
+ * Formats an actor_id like operator<<, without creating a QString.
+ */
+template <>
+struct formatter<::vc::actor_id> {
+  constexpr auto parse(format_parse_context& ctx) -> decltype(ctx.begin()) {
+    return ctx.begin();
+  }
+
+  template <class FormatContext>
+  auto format(const ::vc::actor_id& aid, FormatContext& ctx) const
+    -> decltype(ctx.out()) {
+    return format_to(ctx.out(), "actor{}", aid.value());
+  }
+};
+} // namespace fmt
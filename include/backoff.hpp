@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+#include <chrono>
+#include <random>
+
+namespace vc {
+/**
+ * The parameters of an exponential backoff.
+ */
+struct backoff_policy {
+  std::chrono::milliseconds initial_delay{100}; /**< Delay of the 1st retry */
+  std::chrono::milliseconds max_delay{30000};   /**< Upper bound of a delay */
+  double multiplier{2.0}; /**< Growth of the delay per failed attempt */
+};
+
+/**
+ * Jittered exponential backoff.
+ *
+ * The n-th delay is drawn uniformly from [d / 2, d], where
+ * d = min(max_delay, initial_delay * multiplier^n). The jitter spreads the
+ * retries of many clients that lost their connections at the same time, so
+ * that a restarted server isn't hit by all of them at once.
+ */
+class backoff {
+public:
+  /**
+   * Creates a backoff.
+   * @param policy The parameters to use.
+   * @param seed The seed of the random number generator used for the jitter.
+   */
+  explicit backoff(backoff_policy policy = backoff_policy{},
+                   uint64_t seed = std::random_device{}());
+
+  /**
+   * Calculates the delay before the next attempt and counts the attempt.
+   * @return The delay to wait before the next attempt.
+   */
+  std::chrono::milliseconds next_delay();
+
+  /**
+   * Starts over with the initial delay, e.g. after a successful attempt.
+   */
+  void reset() noexcept;
+
+  /**
+   * Read accessor for the amount of attempts since the last reset.
+   * @return The amount of attempts.
+   */
+  [[nodiscard]] uint32_t attempt_count() const noexcept;
+
+private:
+  backoff_policy policy_;
+  std::mt19937_64 random_engine_;
+  uint32_t attempt_count_;
+};
+} // namespace vc
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <tl/expected.hpp>
+#include <tl/optional.hpp>
+
+#include "error.hpp"
+#include "log_record.hpp"
+#include "log_sink.hpp"
+
+namespace vc {
+/**
+ * Writes log entries in the compact binary log format.
+ *
+ * The file starts with the magic "VCLOG" followed by a version byte. Every
+ * record after that is prefixed with its length as a varint and starts with
+ * its type:
+ * - string (1): varint id, followed by the bytes of the string.
+ * - event (2): varint log level, varint actor_id, varint function string id,
+ *   varint file string id, varint line, varint pair count, the actor_id /
+ *   clock pairs sorted by actor_id as varint actor_id delta and varint clock,
+ *   followed by the bytes of the message.
+ *
+ * Function and file names are interned: each one is written once as a string
+ * record and referred to by its id from then on.
+ */
+class binary_log_sink : public log_sink {
+public:
+  /**
+   * Creates a binary_log_sink.
+   * @param os The ostream to write to, should be opened in binary mode.
+   *
+   * Writes the file header to `os`.
+   */
+  explicit binary_log_sink(std::ostream& os);
+
+  void write(const log_record& record) override;
+
+  void flush() override;
+
+private:
+  /**
+   * Looks up the id of a string, writing its string record if it's new.
+   * @param str The string to look up.
+   * @return The id of the string.
+   */
+  uint64_t intern(const char* str);
+
+  /**
+   * Writes `body_` as a length-prefixed record.
+   */
+  void write_body();
+
+  std::ostream* os_;
+  std::unordered_map<std::string_view, uint64_t> string_ids_;
+  std::string body_;
+};
+
+/**
+ * Reads log entries in the binary log format written by binary_log_sink.
+ */
+class binary_log_reader {
+public:
+  /**
+   * Creates a binary_log_reader.
+   * @param is The istream to read from, should be opened in binary mode.
+   */
+  explicit binary_log_reader(std::istream& is);
+
+  /**
+   * Reads the next log entry.
+   * @return An expected containing the next log entry, or tl::nullopt at the
+   *         end of the log; an error if the log is malformed.
+   * @note The function and file of the log entry returned remain valid for
+   *       the lifetime of this binary_log_reader.
+   */
+  tl::expected<tl::optional<log_record>, error> next();
+
+private:
+  /**
+   * Reads and checks the file header.
+   * @return An expected containing nothing on success; otherwise an error.
+   */
+  tl::expected<void, error> read_header();
+
+  std::istream* is_;
+  bool has_read_header_;
+  std::unordered_map<uint64_t, std::string> strings_;
+  std::string body_;
+};
+} // namespace vc
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <type_traits>
+
+#include <QtGlobal>
+
+namespace vc {
+/**
+ * The instruction sets that the bulk byte swap may use.
+ */
+enum class bswap_isa {
+  scalar, /**< One element at a time */
+  ssse3,  /**< 16 bytes at a time using pshufb */
+  avx2    /**< 32 bytes at a time using vpshufb */
+};
+
+/**
+ * Determines the instruction set used by the bulk byte swap.
+ * @return The best instruction set supported by the CPU, detected once.
+ */
+bswap_isa active_bswap_isa() noexcept;
+
+/**
+ * Reverses the bytes of every element of an array.
+ * @param dest The destination, may be equal to `src` but must not overlap it
+ *             otherwise. Needn't be aligned.
+ * @param src The elements to swap. Needn't be aligned.
+ * @param count The amount of elements.
+ * @param element_byte_count The size of an element, 2, 4 or 8.
+ */
+void bswap_copy(void* dest, const void* src, size_t count,
+                size_t element_byte_count) noexcept;
+
+/**
+ * Like bswap_copy, but always uses the given instruction set.
+ * @param isa The instruction set to use, must be supported by the CPU.
+ * @param dest The destination, may be equal to `src` but must not overlap it
+ *             otherwise.
+ * @param src The elements to swap.
+ * @param count The amount of elements.
+ * @param element_byte_count The size of an element, 2, 4 or 8.
+ *
+ * Exists so that the implementations can be tested against each other.
+ */
+void bswap_copy(bswap_isa isa, void* dest, const void* src, size_t count,
+                size_t element_byte_count) noexcept;
+
+namespace detail {
+/**
+ * Copies an array of integers, converting between host and network byte
+ * order.
+ * @tparam T The integral type of the elements.
+ * @param dest The destination.
+ * @param src The elements to convert.
+ * @param count The amount of elements.
+ */
+template <class T>
+inline void convert_copy(void* dest, const void* src, size_t count) noexcept {
+  static_assert(std::is_integral_v<T>, "T must be an integral type.");
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  if constexpr (sizeof(T) == 1)
+    memmove(dest, src, count);
+  else
+    bswap_copy(dest, src, count, sizeof(T));
+#elif Q_BYTE_ORDER == Q_BIG_ENDIAN
+  memmove(dest, src, count * sizeof(T));
+#else
+#  error "The host byte order is not supported."
+#endif
+}
+} // namespace detail
+
+/**
+ * Converts an array of integers to network byte order in place.
+ * @tparam T The integral type of the elements.
+ * @param first Pointer to the first element.
+ * @param count The amount of elements.
+ */
+template <class T>
+inline void hton_range(T* first, size_t count) noexcept {
+  detail::convert_copy<T>(first, first, count);
+}
+
+/**
+ * Converts an array of integers to host byte order in place.
+ * @tparam T The integral type of the elements.
+ * @param first Pointer to the first element.
+ * @param count The amount of elements.
+ * @warning The elements must be in network byte order!
+ */
+template <class T>
+inline void ntoh_range(T* first, size_t count) noexcept {
+  detail::convert_copy<T>(first, first, count);
+}
+
+/**
+ * Copies an array of integers to a byte buffer in network byte order.
+ * @tparam T The integral type of the elements.
+ * @param dest The destination, needn't be aligned, must not overlap `src`.
+ * @param src Pointer to the first element.
+ * @param count The amount of elements.
+ */
+template <class T>
+inline void hton_copy(void* dest, const T* src, size_t count) noexcept {
+  detail::convert_copy<T>(dest, src, count);
+}
+
+/**
+ * Copies integers in network byte order from a byte buffer to an array.
+ * @tparam T The integral type of the elements.
+ * @param dest Pointer to the first element of the destination.
+ * @param src The integers in network byte order, needn't be aligned, must
+ *            not overlap `dest`.
+ * @param count The amount of elements.
+ */
+template <class T>
+inline void ntoh_copy(T* dest, const void* src, size_t count) noexcept {
+  detail::convert_copy<T>(dest, src, count);
+}
+} // namespace vc
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <QtGlobal>
+
+#include "bswap_range.hpp"
+
+namespace vc {
+/**
+ * The byte orders a vector timestamp may be encoded in on the wire.
+ *
+ * The enumerators are distinct bits, so that a set of byte orders can be
+ * offered in a single byte.
+ */
+enum class byte_order : uint8_t {
+  big_endian = 1U << 0U,   /**< Network byte order, the default */
+  little_endian = 1U << 1U /**< Only used if negotiated */
+};
+
+/**
+ * The byte order of the host.
+ */
+constexpr byte_order host_byte_order =
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  byte_order::little_endian;
+#elif Q_BYTE_ORDER == Q_BIG_ENDIAN
+  byte_order::big_endian;
+#else
+#  error "The host byte order is not supported."
+#endif
+
+/**
+ * The set of byte orders this host offers when negotiating: big-endian,
+ * which every peer understands, and the host's own byte order.
+ */
+constexpr uint8_t offered_byte_orders
+  = static_cast<uint8_t>(byte_order::big_endian)
+    | static_cast<uint8_t>(host_byte_order);
+
+/**
+ * Picks the byte order to use with a peer.
+ * @param peer_byte_orders The set of byte orders offered by the peer.
+ * @return The host's byte order if the peer offered it, so that neither
+ *         side needs to swap bytes; otherwise big-endian.
+ */
+constexpr byte_order negotiate_byte_order(uint8_t peer_byte_orders) noexcept {
+  return (peer_byte_orders & static_cast<uint8_t>(host_byte_order)) != 0
+           ? host_byte_order
+           : byte_order::big_endian;
+}
+
+/**
+ * Copies an array of integers to a byte buffer in the given byte order.
+ * @tparam T The integral type of the elements.
+ * @param dest The destination, needn't be aligned, must not overlap `src`.
+ * @param src Pointer to the first element.
+ * @param count The amount of elements.
+ * @param order The byte order to write; a plain copy if it is the host's.
+ */
+template <class T>
+inline void store_in_order(void* dest, const T* src, size_t count,
+                           byte_order order) noexcept {
+  if (order == host_byte_order)
+    memcpy(dest, src, count * sizeof(T));
+  else
+    bswap_copy(dest, src, count, sizeof(T));
+}
+
+/**
+ * Copies integers in the given byte order from a byte buffer to an array.
+ * @tparam T The integral type of the elements.
+ * @param dest Pointer to the first element of the destination.
+ * @param src The integers, needn't be aligned, must not overlap `dest`.
+ * @param count The amount of elements.
+ * @param order The byte order of `src`; a plain copy if it is the host's.
+ */
+template <class T>
+inline void load_in_order(T* dest, const void* src, size_t count,
+                          byte_order order) noexcept {
+  if (order == host_byte_order)
+    memcpy(dest, src, count * sizeof(T));
+  else
+    bswap_copy(dest, src, count, sizeof(T));
+}
+} // namespace vc
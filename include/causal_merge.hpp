@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+#include "actor_id.hpp"
+#include "log_record.hpp"
+
+namespace vc {
+/**
+ * Merges log entries from several sources into an order consistent with
+ * their vector timestamps.
+ *
+ * Every source must hand over its entries in the order they were created,
+ * e.g. a source per thread. An entry is only released once no pending entry
+ * of another source happened before it.
+ *
+ * An entry that happened before another one was created before it, but may
+ * still sit in its source when the later one is collected. Therefore an
+ * entry is held back until all sources have been drained completely once
+ * more after it was collected, which the caller signals using
+ * complete_round().
+ *
+ * Whether an entry has a pending predecessor is decided from the own clocks
+ * of the actors that created the pending entries: an entry e of actor X
+ * happened before an entry r if r has seen X's clock of e. Each source keeps
+ * the least own clock of its pending entries per actor, so that checking an
+ * entry takes time proportional to the amount of actors with pending
+ * entries, not to the amount of pending entries.
+ */
+class causal_merge {
+public:
+  /**
+   * Creates an empty causal_merge.
+   */
+  causal_merge();
+
+  /**
+   * Adds an entry collected from a source.
+   * @param source The identifier of the source.
+   * @param record The entry.
+   */
+  void push(uint64_t source, log_record record);
+
+  /**
+   * Signals that every source was drained completely since the previous
+   * call; releases the entries collected before the previous call.
+   */
+  void complete_round() noexcept;
+
+  /**
+   * Releases every pending entry, to be called once no more entries will be
+   * collected.
+   */
+  void release_all() noexcept;
+
+  /**
+   * Hands the released entries to a callable in causal order.
+   * @param consumer Invoked with each entry that can be written.
+   * @return The amount of entries handed to `consumer`.
+   *
+   * Released entries that still have a pending causal predecessor stay
+   * pending.
+   */
+  size_t pop(const std::function<void(log_record&&)>& consumer);
+
+  /**
+   * Read accessor for the amount of pending entries.
+   * @return The amount of entries not handed out yet.
+   */
+  [[nodiscard]] size_t size() const noexcept;
+
+private:
+  struct entry {
+    uint64_t round;
+    log_record record;
+  };
+
+  /**
+   * The pending entries of a source.
+   */
+  struct source_entries {
+    std::deque<entry> entries; /**< Oldest first */
+
+    /**
+     * The own clocks of the pending entries per actor, oldest first. An
+     * actor's own clock never decreases within a source, so the first is the
+     * least. Entries created before their actor's first tick are left out,
+     * as no other entry can have seen them.
+     */
+    std::unordered_map<actor_id, std::deque<uint64_t>> own_clocks;
+  };
+
+  /**
+   * Checks whether an entry of a source other than `source` happened before
+   * `record`.
+   * @param source The source of `record`.
+   * @param record The entry to check.
+   * @return true if `record` must wait; otherwise false.
+   */
+  [[nodiscard]] bool has_pending_predecessor(uint64_t source,
+                                             const log_record& record) const;
+
+  /**
+   * Hands the oldest entry of a source to a callable.
+   * @param entries The source's pending entries, mustn't be empty.
+   * @param consumer The callable to invoke with the entry.
+   */
+  void pop_front(source_entries& entries,
+                 const std::function<void(log_record&&)>& consumer);
+
+  std::map<uint64_t, source_entries> sources_;
+  uint64_t round_;
+  uint64_t released_round_;
+  size_t size_;
+};
+} // namespace vc
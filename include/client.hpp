@@ -1,21 +1,83 @@
 #pragma once
+#include <cstddef>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QHostAddress>
 #include <QObject>
 #include <QTcpSocket>
+#include <QTimer>
 
 #include <jaegertracing/Tracer.h>
 
+#include <tl/optional.hpp>
+
 #include <pl/annotations.hpp>
 #include <pl/noncopyable.hpp>
 
+#include "actor_clock.hpp"
 #include "actor_id.hpp"
+#include "backoff.hpp"
+#include "byte_order.hpp"
+#include "future.hpp"
+#include "latency_histogram.hpp"
 #include "logger.hpp"
+#include "opcode.hpp"
 #include "vector_timestamp.hpp"
 
 namespace vc {
+/**
+ * The ways in which a client can get the time from the server.
+ */
+enum class client_mode {
+  poll,     /**< Request the time once per request interval */
+  subscribe /**< Subscribe once and have the server push the time */
+};
+
+/**
+ * The state of one of the connections of a client.
+ */
+enum class connection_state {
+  disconnected, /**< Not connected and no reconnection is scheduled */
+  connecting,   /**< Waiting for the TCP connection to be established */
+  connected,    /**< Ready to send requests */
+  backing_off   /**< Waiting for the backoff delay before reconnecting */
+};
+
+/**
+ * The result of a request made with client::request.
+ */
+struct response {
+  vector_timestamp vstamp; /**< The client's clock after the receive event */
+  std::string payload;     /**< The payload of the server's response */
+};
+
+/**
+ * The default interval at which a polling client requests the time.
+ */
+constexpr std::chrono::milliseconds default_request_interval{1000};
+
+/**
+ * The default interval at which a client prints its round trip time
+ * percentiles.
+ */
+constexpr std::chrono::milliseconds default_rtt_report_interval{10000};
+
 /**
  * Client type.
  *
- * Repeatedly requests a time stamp from the server.
+ * Repeatedly requests a time stamp from the server or subscribes to the time
+ * stamps published by the server.
+ *
+ * Uses a pool of one or more connections to the server and spreads the
+ * requests across the connections that are established. A lost or failed
+ * connection is reestablished after a jittered exponential backoff. Requests
+ * due while no connection is established are skipped rather than queued, so
+ * that a restarted server isn't flooded with them.
  */
 class client : public QObject {
   Q_OBJECT
@@ -32,30 +94,199 @@ public:
   client(actor_id aid, logger& l, QObject* parent = PL_NO_PARENT);
 
   /**
-   * Disconnects the client from the server if it has been connected.
+   * Disconnects the client from the server and stops reconnecting.
    */
   ~client() override;
 
+  /**
+   * Connects the client to the server at 127.0.0.1 and the server_port.
+   * @param mode Whether to poll the server or to subscribe to it.
+   */
+  void connect(client_mode mode = client_mode::poll);
+
   /**
    * Connects the client to the server.
+   * @param address The address of the server.
+   * @param port The TCP port the server listens on.
+   * @param mode Whether to poll the server or to subscribe to it.
+   * @param request_interval The interval at which to request the time when
+   *                         polling.
+   * @param pool_size The amount of connections to open, at least 1.
+   */
+  void connect(const QHostAddress& address, quint16 port, client_mode mode,
+               std::chrono::milliseconds request_interval
+               = default_request_interval,
+               size_t pool_size = 1);
+
+  /**
+   * Sends an echo request to the server.
+   * @param payload The payload to send.
+   * @return A future that resolves to the response once it arrives; or to an
+   *         error if no connection is established or the connection is lost
+   *         before the response arrives.
+   *
+   * Any amount of requests may be in flight at the same time, they're spread
+   * across the connections of the pool like the time requests.
+   */
+  [[nodiscard]] future<response> request(const std::string& payload);
+
+  /**
+   * Sets the backoff used to reconnect.
+   * @param policy The backoff policy to use.
+   * @note Only affects connections opened after the call.
+   */
+  void set_backoff_policy(backoff_policy policy);
+
+  /**
+   * Sets whether connections negotiate the byte order of the vector
+   * timestamps with a hello request once they're established.
+   * @param negotiate true to let both sides skip swapping bytes if they share
+   *                  the same byte order; false to always use big-endian.
+   *                  A server that doesn't know the hello request leaves the
+   *                  connection big-endian.
+   * @note Only affects connections established after the call.
+   */
+  void set_negotiate_byte_order(bool negotiate);
+
+  /**
+   * Read accessor for the states of the connections of the pool.
+   * @return The state of every connection.
+   */
+  [[nodiscard]] std::vector<connection_state> connection_states() const;
+
+  /**
+   * Read accessor for the amount of established connections.
+   * @return The amount of connections in the connected state.
    */
-  void connect();
+  [[nodiscard]] size_t connected_count() const noexcept;
+
+  /**
+   * Read accessor for the round trip times of the requests, measured
+   * from sending the request to receiving the matching response.
+   * @return The histogram of the round trip times in microseconds.
+   */
+  [[nodiscard]] const latency_histogram& rtt_histogram() const noexcept;
+
+  /**
+   * Sets the interval at which the round trip time percentiles are printed.
+   * @param interval The interval to use, 0 disables printing.
+   */
+  void set_rtt_report_interval(std::chrono::milliseconds interval);
+
+  /**
+   * Prints the round trip time percentiles to stdout.
+   */
+  void print_rtt_report() const;
+
+signals:
+  /**
+   * Emitted when the state of a connection of the pool changes.
+   * @param index The index of the connection within the pool.
+   * @param state The new state of the connection.
+   */
+  void connection_state_changed(size_t index, connection_state state);
 
 private:
+  /**
+   * A request that awaits its response.
+   */
+  struct pending_request {
+    opcode op;
+    std::chrono::steady_clock::time_point sent_at;
+    tl::optional<promise<response>> completion; /**< Only for request() */
+  };
+
+  /**
+   * A connection of the pool.
+   */
+  struct connection {
+    size_t index;
+    connection_state state;
+    backoff reconnect_backoff;
+    QTimer reconnect_timer;
+    std::deque<pending_request> pending; /**< Oldest first */
+    byte_order order; /**< Of the vector timestamps sent and received */
+    QTcpSocket socket; /**< Last, so that it's destroyed first */
+  };
+
+  /**
+   * Handles state changes of a connection's socket.
+   * @param conn The connection.
+   * @param socket_state The new state of the socket.
+   */
+  void on_socket_state_changed(connection& conn,
+                               QAbstractSocket::SocketState socket_state);
+
+  /**
+   * Sets the state of a connection.
+   * @param conn The connection.
+   * @param state The new state.
+   */
+  void set_state(connection& conn, connection_state state);
+
+  /**
+   * Picks the connection to send the next request over, round robin.
+   * @return The connection or nullptr if no connection is established.
+   */
+  connection* next_connection();
+
   /**
    * Requests time stamp from the server.
    */
   void request_time_from_server();
 
   /**
-   * Handles response from the server.
+   * Subscribes to the time stamps published by the server.
+   * @param conn The connection to subscribe over.
+   */
+  void subscribe_to_server(connection& conn);
+
+  /**
+   * Offers the byte orders of the host to the server.
+   * @param conn The connection whose byte order to negotiate.
+   */
+  void say_hello(connection& conn);
+
+  /**
+   * Sends a request to the server as a send event.
+   * @param conn The connection to send the request over.
+   * @param op The opcode of the request.
+   * @param payload_data The payload to send.
+   * @param payload_byte_count The size of the payload in bytes.
+   * @param span The span of the request, whose context is sent along, so
+   *             that the server's spans become its children; nullptr if the
+   *             request isn't traced.
+   * @return true on success; otherwise false.
+   */
+  bool send_request(connection& conn, opcode op, const char* payload_data,
+                    size_t payload_byte_count, const opentracing::Span* span);
+
+  /**
+   * Handles responses from the server.
+   * @param conn The connection that became readable.
+   */
+  void on_ready_read(connection& conn);
+
+  /**
+   * Handles a single response from the server.
+   * @param conn The connection the response arrived on.
    */
-  void on_ready_read();
+  void handle_response(connection& conn);
 
   actor_id aid_;
   logger& logger_;
-  bool is_connected_;
-  QTcpSocket socket_;
+  QHostAddress address_;
+  quint16 port_;
+  client_mode mode_;
+  backoff_policy backoff_policy_;
+  bool is_closing_;
+  bool negotiate_byte_order_;
+  std::vector<std::unique_ptr<connection>> connections_;
+  size_t next_connection_;
+  connection* subscription_; /**< The connection subscribed over, if any */
   vector_timestamp vstamp_;
+  latency_histogram rtt_histogram_;
+  QTimer rtt_report_timer_;
+  actor_clock clock_;
 };
 } // namespace vc
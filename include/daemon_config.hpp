@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <tl/expected.hpp>
+#include <tl/optional.hpp>
+
+#include <pl/string_view.hpp>
+
+#include "actor_id.hpp"
+#include "client.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "mesh_config.hpp"
+#include "server.hpp"
+
+namespace vc {
+/**
+ * The configuration of the server run by the daemon.
+ */
+struct daemon_server_config {
+  actor_id aid{1};               /**< The unique actor_id of the server */
+  std::string host{"127.0.0.1"}; /**< The host name or IP to listen on */
+  quint16 port{0};               /**< The TCP port to listen on */
+  std::chrono::milliseconds publish_interval{
+    default_publish_interval}; /**< Time between publications */
+};
+
+/**
+ * The configuration of a group of clients run by the daemon.
+ * The clients get consecutive actor_ids starting with `first_aid`.
+ */
+struct daemon_client_config {
+  actor_id first_aid{2};               /**< The actor_id of the first client */
+  size_t count{1};                     /**< The amount of clients */
+  peer_address server{"127.0.0.1", 0}; /**< The server to connect to */
+  client_mode mode{client_mode::poll}; /**< Whether to poll or subscribe */
+  std::chrono::milliseconds request_interval{
+    default_request_interval}; /**< Time between requests when polling */
+  size_t pool_size{1}; /**< The amount of connections per client */
+};
+
+/**
+ * The configuration of the headless daemon.
+ */
+struct daemon_config {
+  tl::optional<daemon_server_config> server; /**< The server to run, if any */
+  std::vector<daemon_client_config> clients; /**< The clients to run */
+  tl::optional<mesh_config> mesh; /**< The mesh node to run, if any */
+  std::string log_file; /**< The log file, "-" to log to stdout */
+  logger_options log_options; /**< How to write to the log file */
+  bool log_binary = false; /**< Whether to use the binary log format */
+  size_t log_segment_byte_count = 0; /**< Rotate the log file if non-zero */
+  size_t log_max_segment_count = 4; /**< Log segments kept when rotating */
+  std::string metrics_host{"127.0.0.1"}; /**< Host name or IP of the metrics */
+  quint16 metrics_port{0}; /**< Port serving the metrics, 0 to disable */
+};
+
+/**
+ * Reads the daemon configuration from the `daemon` and `mesh` sections of a
+ * YAML file.
+ * @param config_filepath The path to the YAML file.
+ * @return An expected containing the daemon configuration; an error if the
+ *         file couldn't be read, a section is invalid or there is nothing to
+ *         run.
+ *
+ * The `mesh` section is read using parse_mesh_config.
+ * The log file defaults to the one of the mesh node if there is one;
+ * otherwise to "vector_clocks_daemon.log".
+ * A binary log can be converted for ShiViz using vector_clocks_log2shiviz.
+ * If log_segment_bytes is set the text log is written to memory-mapped
+ * segments of that size, keeping log_max_segments of them, see
+ * mmap_log_sink.
+ * If metrics_port is set the metrics of server, clients and logger are
+ * served in the Prometheus text format on http://metrics_host:metrics_port
+ * /metrics, see metrics_endpoint.
+ *
+ * Example:
+ * ```yaml
+ * daemon:
+ *   log_file: daemon.log
+ *   log_async: true
+ *   log_flush_interval_ms: 100
+ *   log_echo: false
+ *   log_per_thread: false
+ *   log_binary: false
+ *   log_level: info
+ *   log_segment_bytes: 67108864
+ *   log_max_segments: 4
+ *   metrics_host: 127.0.0.1
+ *   metrics_port: 9100
+ *   server:
+ *     actor_id: 1
+ *     host: 0.0.0.0
+ *     port: 12345
+ *     publish_interval_ms: 100
+ *   clients:
+ *     - first_actor_id: 2
+ *       count: 100
+ *       server:
+ *         host: 127.0.0.1
+ *         port: 12345
+ *       mode: subscribe
+ *       pool_size: 2
+ *     - first_actor_id: 102
+ *       server:
+ *         port: 12345
+ *       request_interval_ms: 10
+ * ```
+ */
+tl::expected<daemon_config, error>
+parse_daemon_config(pl::string_view config_filepath);
+} // namespace vc
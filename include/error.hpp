@@ -1,13 +1,53 @@
 #pragma once
+#include <cstdint>
+
 #include <string>
 
 #include <tl/expected.hpp>
 
+#include <pl/current_function.hpp>
+
 #include "source_location.hpp"
 
 namespace vc {
+/**
+ * Codes of the errors that may be caused by malformed or hostile input.
+ *
+ * Creating an error from a code doesn't allocate, so that garbage received
+ * from the network is rejected as cheaply as possible.
+ */
+enum class errc : uint8_t {
+  generic,                    /**< Described by its message only */
+  too_few_bytes,              /**< The input is shorter than its header */
+  too_few_vstamp_bytes,       /**< A vector timestamp lacks its pair count */
+  invalid_pair_count,         /**< A vector timestamp's pair count is wrong */
+  empty_vstamp,               /**< A packet's vector timestamp is empty */
+  empty_payload,              /**< A packet's payload is empty */
+  truncated_vstamp,           /**< A packet's vector timestamp is cut off */
+  truncated_payload,          /**< A packet's payload is cut off */
+  missing_trace_context_size, /**< The trace context's size is cut off */
+  truncated_trace_context,    /**< A packet's trace context is cut off */
+  vstamp_too_large,           /**< A vector timestamp exceeds the limit */
+  payload_too_large,          /**< A payload exceeds the limit */
+  packet_too_large,           /**< A packet exceeds the limit */
+  read_failed,                /**< Reading from a device failed */
+  missing_own_clock           /**< A vector timestamp lacks the own clock */
+};
+
+/**
+ * Describes an error code.
+ * @param code The error code.
+ * @return The description, a string literal.
+ */
+const char* to_string(errc code) noexcept;
+
 /**
  * Error type used to indicate failures employing tl::expected.
+ *
+ * An error either carries a message or an error code along with the source
+ * location that created it. The message of the latter is formatted anew
+ * whenever it's asked for, so that a const error may be shared between
+ * threads.
  */
 class error {
 public:
@@ -17,11 +57,30 @@ public:
    */
   explicit error(std::string error_message);
 
+  /**
+   * Creates a new error object from an error code, without allocating.
+   * @param code The error code, must not be errc::generic.
+   * @param file The source file that created the error, a string literal.
+   * @param line The source line that created the error.
+   * @param function The function that created the error, must outlive the
+   *                 error, e.g. a string literal.
+   */
+  error(errc code, const char* file, unsigned line,
+        const char* function) noexcept;
+
+  /**
+   * Read accessor for this error's error code.
+   * @return The error code; errc::generic if the error only carries a
+   *         message.
+   */
+  [[nodiscard]] errc code() const noexcept;
+
   /**
    * Read accessor for this error's error message string.
-   * @return A reference to the error message string.
+   * @return The error message string, formatted from the error code and
+   *         source location if the error was created from an error code.
    */
-  [[nodiscard]] const std::string& message() const;
+  [[nodiscard]] std::string message() const;
 
   /**
    * Throws an exception of type `Exception` using this
@@ -34,6 +93,10 @@ public:
   }
 
 private:
+  errc code_;
+  const char* file_;
+  unsigned line_;
+  const char* function_;
   std::string error_message_;
 };
 } // namespace vc
@@ -56,3 +119,22 @@ private:
  * Expects the error message to use as an argument.
  */
 #define VC_UNEXPECTED(message) ::tl::make_unexpected(VC_MAKE_ERROR(message))
+
+/**
+ * @def VC_MAKE_ERROR_CODE
+ * Macro to create a vc::error object from a vc::errc and the current source
+ * location, without allocating.
+ *
+ * Expects the error code to use as an argument.
+ */
+#define VC_MAKE_ERROR_CODE(code)                                               \
+  ::vc::error(code, __FILE__, __LINE__, PL_CURRENT_FUNCTION)
+
+/**
+ * @def VC_UNEXPECTED_CODE
+ * Macro to create a tl::expected with an error created from a vc::errc.
+ *
+ * Expects the error code to use as an argument.
+ */
+#define VC_UNEXPECTED_CODE(code)                                               \
+  ::tl::make_unexpected(VC_MAKE_ERROR_CODE(code))
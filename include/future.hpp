@@ -0,0 +1,207 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <tl/expected.hpp>
+#include <tl/optional.hpp>
+
+#include "error.hpp"
+
+namespace vc {
+template <class T>
+class future;
+
+template <class T>
+class promise;
+
+namespace detail {
+/**
+ * Determines the type of the value of the future returned by future::then.
+ * @tparam R The return type of the continuation.
+ */
+template <class R>
+struct continuation_traits {
+  using value_type = R;
+};
+
+template <class U>
+struct continuation_traits<future<U>> {
+  using value_type = U;
+};
+
+template <class U>
+struct continuation_traits<tl::expected<U, error>> {
+  using value_type = U;
+};
+
+template <class R>
+struct is_future : std::false_type {};
+
+template <class U>
+struct is_future<future<U>> : std::true_type {};
+} // namespace detail
+
+/**
+ * The eventual result of an asynchronous operation.
+ * @tparam T The type of the value produced by the operation.
+ *
+ * Resolves to a tl::expected, either holding the value or the error that
+ * made the operation fail. A future is meant to be used on the thread of the
+ * Qt event loop that fulfills it; it is not thread-safe.
+ *
+ * The result is consumed with then(), which returns a future of the
+ * continuation's result, so that asynchronous operations can be chained
+ * without nesting callbacks:
+ * ```cpp
+ * c.request("first")
+ *   .then([&c](const vc::future<vc::response>::result_type& first) {
+ *     if (!first.has_value())
+ *       return vc::future<vc::response>::make_ready(
+ *         tl::make_unexpected(first.error()));
+ *
+ *     return c.request(first->payload);
+ *   })
+ *   .then([](const vc::future<vc::response>::result_type& second) {
+ *     // ...
+ *   });
+ * ```
+ */
+template <class T>
+class future {
+public:
+  /**
+   * The type of the result.
+   */
+  using result_type = tl::expected<T, error>;
+
+  /**
+   * Creates a future that is ready right away.
+   * @param result The result.
+   * @return The future.
+   */
+  [[nodiscard]] static future make_ready(result_type result) {
+    future f(std::make_shared<state>());
+    f.state_->result = std::move(result);
+    return f;
+  }
+
+  /**
+   * Checks whether the result is available.
+   * @return true if the operation completed; otherwise false.
+   */
+  [[nodiscard]] bool is_ready() const noexcept {
+    return state_->result.has_value();
+  }
+
+  /**
+   * Read accessor for the result.
+   * @return A reference to the result.
+   * @warning The future must be ready.
+   */
+  [[nodiscard]] const result_type& get() const {
+    return *state_->result;
+  }
+
+  /**
+   * Registers the continuation to invoke with the result.
+   * @tparam Callable The type of the continuation.
+   * @param callable The continuation, invoked with a const reference to the
+   *                 result. Invoked right away if the future is ready.
+   * @return A future of the continuation's result. If the continuation
+   *         returns a future, the returned future resolves along with it; if
+   *         it returns a tl::expected<U, error>, to that result; if it
+   *         returns void, to an empty value.
+   *
+   * Replaces the continuation that was previously registered, if any.
+   */
+  template <class Callable>
+  auto then(Callable&& callable) {
+    using continuation_result = std::invoke_result_t<Callable&,
+                                                     const result_type&>;
+    using value_type =
+      typename detail::continuation_traits<continuation_result>::value_type;
+
+    promise<value_type> next;
+    auto next_future = next.get_future();
+
+    auto chained = [callable = std::forward<Callable>(callable),
+                    next](const result_type& result) mutable {
+      if constexpr (std::is_void_v<continuation_result>) {
+        callable(result);
+        next.set_result({});
+      }
+      else if constexpr (detail::is_future<continuation_result>::value) {
+        callable(result).then(
+          [next](const typename continuation_result::result_type&
+                   inner) mutable { next.set_result(inner); });
+      }
+      else {
+        next.set_result(callable(result));
+      }
+    };
+
+    if (is_ready())
+      chained(*state_->result);
+    else
+      state_->continuation = std::move(chained);
+
+    return next_future;
+  }
+
+private:
+  friend class promise<T>;
+
+  struct state {
+    tl::optional<result_type> result;
+    std::function<void(const result_type&)> continuation;
+  };
+
+  explicit future(std::shared_ptr<state> s) : state_(std::move(s)) {
+  }
+
+  std::shared_ptr<state> state_;
+};
+
+/**
+ * The producing end of a future.
+ * @tparam T The type of the value produced.
+ */
+template <class T>
+class promise {
+public:
+  /**
+   * Creates a promise whose future isn't ready.
+   */
+  promise() : state_(std::make_shared<typename future<T>::state>()) {
+  }
+
+  /**
+   * Creates a future sharing the result of this promise.
+   * @return The future.
+   */
+  [[nodiscard]] future<T> get_future() const {
+    return future<T>(state_);
+  }
+
+  /**
+   * Fulfills the promise and invokes the continuation, if any.
+   * @param result The result.
+   * @warning Must be called at most once.
+   */
+  void set_result(typename future<T>::result_type result) {
+    // The continuation may drop the last future, keep the state alive.
+    const auto s = state_;
+    s->result = std::move(result);
+
+    if (s->continuation) {
+      const auto continuation = std::move(s->continuation);
+      continuation(*s->result);
+    }
+  }
+
+private:
+  std::shared_ptr<typename future<T>::state> state_;
+};
+} // namespace vc
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+
+#include <pl/noncopyable.hpp>
+
+namespace vc {
+/**
+ * Log-bucketed histogram in the style of HdrHistogram.
+ *
+ * Values below 2^sub_bucket_bits are counted exactly. Each power of two
+ * above that is split into 2^sub_bucket_bits linear sub-buckets, which bounds
+ * the relative error of every reported value to 2^-sub_bucket_bits
+ * (about 3 %), across the whole range of uint64_t.
+ *
+ * record() is lock-free and doesn't allocate, so that it can be called from
+ * any thread on every request. Reading while recording is allowed, but a
+ * percentile may then miss the values recorded concurrently.
+ */
+class latency_histogram {
+public:
+  PL_NONCOPYABLE(latency_histogram);
+
+  /**
+   * log2 of the amount of linear sub-buckets per power of two.
+   */
+  static constexpr unsigned sub_bucket_bits = 5U;
+
+  /**
+   * The amount of buckets needed to cover all values of uint64_t.
+   */
+  static constexpr size_t bucket_count = size_t(64U - sub_bucket_bits + 1U)
+                                         << sub_bucket_bits;
+
+  /**
+   * Creates an empty latency_histogram.
+   */
+  latency_histogram() noexcept;
+
+  /**
+   * Records a value.
+   * @param value The value to record, e.g. a round trip time in
+   *              microseconds.
+   */
+  void record(uint64_t value) noexcept;
+
+  /**
+   * Read accessor for the amount of values recorded.
+   * @return The amount of values recorded.
+   */
+  [[nodiscard]] uint64_t count() const noexcept;
+
+  /**
+   * Read accessor for the largest value recorded.
+   * @return The largest value recorded, or 0 if the histogram is empty.
+   */
+  [[nodiscard]] uint64_t max() const noexcept;
+
+  /**
+   * Calculates a percentile of the values recorded.
+   * @param percentile The percentile to calculate, in the range [0, 100].
+   * @return The highest value that falls into the same bucket as the
+   *         percentile, capped at max(), or 0 if the histogram is empty.
+   */
+  [[nodiscard]] uint64_t value_at_percentile(double percentile) const noexcept;
+
+  /**
+   * Removes all of the values recorded.
+   */
+  void reset() noexcept;
+
+  /**
+   * Calculates the bucket a value is counted in.
+   * @param value The value.
+   * @return The index of the bucket.
+   */
+  [[nodiscard]] static size_t bucket_index(uint64_t value) noexcept;
+
+  /**
+   * Calculates the highest value counted in a bucket.
+   * @param index The index of the bucket.
+   * @return The highest value counted in the bucket.
+   */
+  [[nodiscard]] static uint64_t bucket_upper_bound(size_t index) noexcept;
+
+private:
+  std::array<std::atomic<uint64_t>, bucket_count> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> max_;
+};
+} // namespace vc
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+
+#include <chrono>
+#include <iosfwd>
+#include <vector>
+
+namespace vc {
+/**
+ * Summary of a load generator run.
+ */
+struct load_report {
+  uint64_t sent_count;         /**< The amount of requests sent */
+  uint64_t received_count;     /**< The amount of responses received */
+  uint64_t error_count;        /**< The amount of failed requests */
+  double throughput;           /**< Responses received per second */
+  uint64_t latency_p50_us;     /**< Median round trip time */
+  uint64_t latency_p90_us;     /**< 90th percentile round trip time */
+  uint64_t latency_p99_us;     /**< 99th percentile round trip time */
+  uint64_t latency_p999_us;    /**< 99.9th percentile round trip time */
+  uint64_t latency_max_us;     /**< Maximum round trip time */
+};
+
+/**
+ * Calculates a percentile using the nearest-rank method.
+ * @param sorted_values The values, sorted in ascending order.
+ * @param percentile The percentile to calculate, in the range [0, 100].
+ * @return The smallest value that is greater than or equal to `percentile`
+ *         percent of the values, or 0 if `sorted_values` is empty.
+ */
+[[nodiscard]] uint64_t nearest_rank(const std::vector<uint64_t>& sorted_values,
+                                    double percentile);
+
+/**
+ * Creates a load_report.
+ * @param latencies_us The round trip times of the responses received in
+ *                     microseconds, in any order.
+ * @param sent_count The amount of requests sent.
+ * @param error_count The amount of failed requests.
+ * @param elapsed The duration of the run.
+ * @return The resulting load_report.
+ */
+[[nodiscard]] load_report make_load_report(std::vector<uint64_t> latencies_us,
+                                           uint64_t sent_count,
+                                           uint64_t error_count,
+                                           std::chrono::microseconds elapsed);
+
+/**
+ * Prints a load_report in a human readable format.
+ * @param os The ostream to print to.
+ * @param report The load_report to print.
+ * @return `os`
+ */
+std::ostream& operator<<(std::ostream& os, const load_report& report);
+} // namespace vc
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <pl/annotations.hpp>
+#include <pl/byte.hpp>
+#include <pl/noncopyable.hpp>
+
+#include "actor_id.hpp"
+#include "vector_timestamp.hpp"
+
+namespace vc {
+/**
+ * The ways in which the load generator paces its requests.
+ */
+enum class load_mode {
+  open,  /**< Send at a fixed rate, regardless of outstanding responses */
+  closed /**< Keep a fixed amount of requests outstanding per connection */
+};
+
+/**
+ * The options of a load_worker.
+ */
+struct load_options {
+  QHostAddress host{QHostAddress::LocalHost}; /**< The server's address */
+  quint16 port{0};                   /**< The TCP port of the server */
+  actor_id first_aid{2};             /**< The actor_id of the first actor */
+  size_t actor_count{1};             /**< The amount of simulated clients */
+  load_mode mode{load_mode::closed}; /**< How the requests are paced */
+  double rate{1000.0}; /**< Requests per second of this worker (open loop) */
+  size_t window{1}; /**< Outstanding requests per actor (closed loop) */
+  size_t payload_byte_count{16}; /**< The size of each echo payload */
+  size_t clock_size{1}; /**< The amount of actors in each vector timestamp */
+};
+
+/**
+ * Simulates many clients that send echo requests to the server.
+ *
+ * Meant to live in its own QThread, so that a few workers can drive thousands
+ * of actors. The actors don't log and every actor carries a vector timestamp
+ * of `clock_size` entries, so that the request size resembles a system of
+ * that many actors.
+ */
+class load_worker : public QObject {
+  Q_OBJECT
+
+public:
+  PL_NONCOPYABLE(load_worker);
+
+  /**
+   * Creates a load_worker.
+   * @param options The options to use.
+   * @param parent The QObject parent to use.
+   */
+  explicit load_worker(load_options options, QObject* parent = PL_NO_PARENT);
+
+  /**
+   * Connects the actors and starts sending requests.
+   * @note Must be invoked in the thread the load_worker lives in.
+   */
+  void start();
+
+  /**
+   * Stops sending requests and closes the connections.
+   * @note Must be invoked in the thread the load_worker lives in.
+   */
+  void stop();
+
+  /**
+   * Read accessor for the round trip times measured.
+   * @return The round trip times of the responses received in microseconds.
+   * @warning Must not be called before stop() has returned.
+   */
+  [[nodiscard]] const std::vector<uint64_t>& latencies_us() const noexcept;
+
+  /**
+   * Read accessor for the amount of requests sent.
+   * @return The amount of requests sent.
+   */
+  [[nodiscard]] uint64_t sent_count() const noexcept;
+
+  /**
+   * Read accessor for the amount of requests that failed.
+   * @return The amount of failed requests.
+   */
+  [[nodiscard]] uint64_t error_count() const noexcept;
+
+  /**
+   * Forgets the round trip times and counts measured so far, e.g. once the
+   * connections have warmed up. Requests that are in flight at the time
+   * aren't measured when they complete or fail afterwards.
+   * @note Must be invoked in the thread the load_worker lives in.
+   */
+  void clear_statistics();
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * A simulated client.
+   */
+  struct actor {
+    actor_id aid;
+    std::unique_ptr<QTcpSocket> socket;
+    vector_timestamp vstamp;
+    std::deque<clock::time_point> in_flight; /**< Send times, oldest first */
+  };
+
+  /**
+   * Sends the requests that are due according to the open loop rate.
+   */
+  void on_pace_timeout();
+
+  /**
+   * Handles responses arriving for an actor.
+   * @param a The actor whose socket became readable.
+   */
+  void on_ready_read(actor& a);
+
+  /**
+   * Sends an echo request on behalf of an actor.
+   * @param a The actor to send the request for.
+   */
+  void send_request(actor& a);
+
+  load_options options_;
+  std::vector<std::unique_ptr<actor>> actors_;
+  std::vector<pl::byte> payload_;
+  QTimer pace_timer_;
+  clock::time_point start_time_;
+  size_t next_actor_;
+  uint64_t offered_count_; /**< Requests due so far in open loop mode */
+  bool is_running_;
+  std::vector<uint64_t> latencies_us_;
+  clock::time_point statistics_start_; /**< Earlier requests aren't measured */
+  uint64_t sent_count_;
+  uint64_t error_count_;
+};
+} // namespace vc
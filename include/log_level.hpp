@@ -1,15 +1,23 @@
 #pragma once
+#include <algorithm>
 #include <iosfwd>
+#include <string>
+
+#include <fmt/format.h>
 
 namespace vc {
 /**
- * The log levels.
- *
- * The log levels.
- * Right now only info shall be used.
+ * The log levels, in increasing order of severity.
  */
 enum class log_level { trace, debug, info, warning, error, critical };
 
+/**
+ * Returns the name of a log_level enumerator.
+ * @param ll The log_level.
+ * @return The name of `ll` in upper case, e.g. "INFO".
+ */
+[[nodiscard]] const char* to_string(log_level ll) noexcept;
+
 /**
  * Prints a log_level enumerator to an ostream.
  * @param os The ostream to print to.
@@ -18,3 +26,23 @@ enum class log_level { trace, debug, info, warning, error, critical };
  */
 std::ostream& operator<<(std::ostream& os, log_level ll);
 } // namespace vc
+
+namespace fmt {
+/**
+ * Formats a log_level like operator<<.
+ */
+template <>
+struct formatter<::vc::log_level> {
+  constexpr auto parse(format_parse_context& ctx) -> decltype(ctx.begin()) {
+    return ctx.begin();
+  }
+
+  template <class FormatContext>
+  auto format(::vc::log_level ll, FormatContext& ctx) const
+    -> decltype(ctx.out()) {
+    const char* name = ::vc::to_string(ll);
+    return std::copy(name, name + std::char_traits<char>::length(name),
+                     ctx.out());
+  }
+};
+} // namespace fmt
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+
+#include "actor_id.hpp"
+#include "log_level.hpp"
+#include "vector_timestamp.hpp"
+
+namespace vc {
+/**
+ * The regex that ShiViz uses to parse the text log format.
+ */
+constexpr char shiviz_regex[]
+  = R"~((?<clock>{.+}) (?<level>TRACE|DEBUG|INFO|WARNING|ERROR|CRITICAL) (?<host>\w+\d+) (?<function>.+) (?<file>.+):(?<line>\d+) (?<event>.+))~";
+
+/**
+ * A single log entry.
+ */
+struct log_record {
+  vector_timestamp vstamp; /**< The clock of the actor creating the entry */
+  log_level level;         /**< The log level */
+  actor_id aid;            /**< The actor creating the entry */
+  const char* function;    /**< The function creating the entry */
+  const char* file;        /**< The file of the calling context */
+  unsigned line;           /**< The line of the calling context */
+  std::string message;     /**< The formatted message */
+};
+
+/**
+ * Renders a log_record in the text format parsed by shiviz_regex.
+ * @param record The log_record to render.
+ * @return The resulting line, without a trailing newline.
+ */
+[[nodiscard]] std::string to_shiviz(const log_record& record);
+} // namespace vc
@@ -0,0 +1,53 @@
+#pragma once
+#include <iosfwd>
+
+#include <pl/noncopyable.hpp>
+
+#include "log_record.hpp"
+
+namespace vc {
+/**
+ * Interface of the destinations of log entries.
+ * A log_sink is only ever used by one thread at a time.
+ */
+class log_sink {
+public:
+  PL_NONCOPYABLE(log_sink);
+
+  log_sink() = default;
+
+  virtual ~log_sink();
+
+  /**
+   * Writes a log entry.
+   * @param record The log entry to write.
+   */
+  virtual void write(const log_record& record) = 0;
+
+  /**
+   * Flushes the entries written so far.
+   */
+  virtual void flush() = 0;
+};
+
+/**
+ * Writes log entries in the ShiViz text format.
+ */
+class text_log_sink : public log_sink {
+public:
+  /**
+   * Creates a text_log_sink.
+   * @param os The ostream to write to.
+   *
+   * Writes the ShiViz-compatible regex to `os`.
+   */
+  explicit text_log_sink(std::ostream& os);
+
+  void write(const log_record& record) override;
+
+  void flush() override;
+
+private:
+  std::ostream* os_;
+};
+} // namespace vc
@@ -1,32 +1,118 @@
 #pragma once
-#include <cstdio>
+#include <cstddef>
+#include <cstdint>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <ostream>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
 #include <pl/current_function.hpp>
-#include <pl/source_line.hpp>
+#include <pl/noncopyable.hpp>
 
 #include "log_level.hpp"
+#include "log_record.hpp"
+#include "log_sink.hpp"
+#include "mpsc_queue.hpp"
 #include "vector_timestamp.hpp"
 
 namespace vc {
+/**
+ * Options of the logger.
+ */
+struct logger_options {
+  bool asynchronous{false}; /**< Write from a background thread */
+  size_t queue_capacity{64U * 1024U}; /**< Entries buffered when async */
+  std::chrono::milliseconds flush_interval{100}; /**< Max. time unflushed */
+  bool echo_to_stdout{true}; /**< Also print every entry to stdout */
+  log_level level{log_level::info}; /**< Least severe level to write */
+  bool per_thread_buffers{false}; /**< Causal merge of per-thread buffers */
+  size_t thread_buffer_capacity{4096U}; /**< Entries buffered per thread */
+};
+
 /**
  * Type for the logger.
+ *
+ * In the asynchronous mode the calling thread only formats the entry and
+ * pushes it into a lock-free queue. A background thread writes the entries
+ * to the sink in batches and flushes the sink at most once per flush
+ * interval. If the queue is full the calling thread waits for the writer
+ * rather than dropping the entry.
+ *
+ * If per_thread_buffers is enabled as well, every thread logging gets its own
+ * single-producer queue instead, so that threads don't contend with one
+ * another at all. The background thread merges the queues so that the sink
+ * receives the entries in an order consistent with their vector timestamps,
+ * see causal_merge. The queue of a thread that exits is dropped once the
+ * background thread has drained it.
+ *
+ * Entries should be created using the VC_LOG_* macros, which check the log
+ * level before evaluating any of their arguments. Log levels below
+ * VC_LOG_MIN_LEVEL aren't compiled in at all.
  */
 class logger {
 public:
+  PL_NONCOPYABLE(logger);
+
   /**
-   * Creates a logger using the given ostream.
+   * Creates a logger writing the ShiViz text format to the given ostream.
    * @param sink The ostream to write log entries to.
+   * @param options The options to use.
    *
    * Writes the ShiViz-compatible regex to `sink`.
+   * Starts the background writer thread in the asynchronous mode.
+   */
+  explicit logger(std::ostream& sink, logger_options options = {});
+
+  /**
+   * Creates a logger using the given log_sink.
+   * @param sink The log_sink to write log entries to.
+   * @param options The options to use.
+   *
+   * Starts the background writer thread in the asynchronous mode.
+   */
+  explicit logger(std::unique_ptr<log_sink> sink,
+                  logger_options options = {});
+
+  /**
+   * Writes the remaining entries to the sink and stops the background
+   * writer thread, if any.
+   */
+  ~logger();
+
+  /**
+   * Changes the least severe log level to write, may be called from any
+   * thread.
+   * @param ll The new log level.
    */
-  explicit logger(std::ostream& sink);
+  void set_level(log_level ll) noexcept {
+    level_.store(ll, std::memory_order_relaxed);
+  }
+
+  /**
+   * Read accessor for the least severe log level to write.
+   * @return The log level.
+   */
+  [[nodiscard]] log_level level() const noexcept {
+    return level_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Checks whether entries of a log level are written.
+   * @param ll The log level to check.
+   * @return true if `ll` is at least as severe as level(); otherwise false.
+   */
+  [[nodiscard]] bool is_enabled(log_level ll) const noexcept {
+    return ll >= level();
+  }
 
   /**
    * Writes a log entry to the log sink.
@@ -43,60 +129,144 @@ public:
    * @param format_string The format string to pass to fmt::format.
    * @param xs The arguments to pass to fmt::format.
    * @return A reference to this object.
+   * @note Doesn't check the log level, use the VC_LOG_* macros instead.
    */
   template <class FormatString, class... Ts>
   logger& log(const vector_timestamp& vstamp, log_level logger_level,
               actor_id aid, const char* function, const char* file,
-              const char* line, FormatString&& format_string, Ts&&... xs) {
-    // log_level shall be info, as that's the only level that the regex will
-    // accept right now.
-    if (logger_level != log_level::info) {
-      fprintf(stderr, "Log level isn't info!\n");
-      return *this;
-    }
+              unsigned line, FormatString&& format_string, Ts&&... xs) {
+    write(log_record{vstamp, logger_level, aid, function, file, line,
+                     fmt::format(std::forward<FormatString>(format_string),
+                                 std::forward<Ts>(xs)...)});
+
+    return *this;
+  }
 
-    std::lock_guard<std::mutex> lock_guard(mu_);
-    (void) lock_guard;
+private:
+  /**
+   * Writes an entry to the sink, or hands it to the background writer thread
+   * in the asynchronous mode.
+   * @param record The entry.
+   */
+  void write(log_record record);
 
-    const auto str
-      = fmt::format("{} {} {} {} {}:{} \"{}\"", vstamp, logger_level, aid,
-                    function, file, line,
-                    fmt::format(std::forward<FormatString>(format_string),
-                                std::forward<Ts>(xs)...));
+  /**
+   * Prints an entry to stdout if echo_to_stdout is enabled.
+   * @param record The entry.
+   */
+  void echo(const log_record& record) const;
 
-    (*sink_) << str << std::endl;
+  /**
+   * The routine of the background writer thread.
+   */
+  void run_writer();
 
-    std::printf("Wrote \"%s\" to log.\n", str.data());
+  /**
+   * The routine of the background writer thread with per-thread buffers.
+   */
+  void run_merging_writer();
 
-    return *this;
-  }
+  /**
+   * The queue of a thread writing to this logger.
+   */
+  struct thread_buffer;
 
-private:
+  /**
+   * Fetches the queue of the calling thread, creating it on first use.
+   * @return The queue of the calling thread.
+   */
+  thread_buffer& local_buffer();
+
+  const uint64_t id_;
   std::mutex mu_;
-  std::ostream* sink_;
+  std::unique_ptr<log_sink> sink_;
+  logger_options options_;
+  std::atomic<log_level> level_;
+  std::unique_ptr<mpsc_queue<log_record>> queue_;
+  std::mutex buffers_mu_;
+  std::vector<std::shared_ptr<thread_buffer>> buffers_;
+  uint64_t next_buffer_id_;
+  std::atomic<uint64_t> buffers_version_;
+  std::atomic<bool> is_stopping_;
+  std::thread writer_;
 };
 } // namespace vc
 
+/**
+ * The numeric values of the log levels, for use in VC_LOG_MIN_LEVEL.
+ */
+#define VC_LOG_LEVEL_TRACE 0
+#define VC_LOG_LEVEL_DEBUG 1
+#define VC_LOG_LEVEL_INFO 2
+#define VC_LOG_LEVEL_WARNING 3
+#define VC_LOG_LEVEL_ERROR 4
+#define VC_LOG_LEVEL_CRITICAL 5
+
+/**
+ * The least severe log level compiled in. The VC_LOG_* macros of less severe
+ * levels expand to a no-op, their arguments aren't even evaluated.
+ */
+#ifndef VC_LOG_MIN_LEVEL
+#define VC_LOG_MIN_LEVEL VC_LOG_LEVEL_TRACE
+#endif
+
+static_assert(VC_LOG_LEVEL_CRITICAL
+                == static_cast<int>(::vc::log_level::critical),
+              "VC_LOG_LEVEL_* don't match vc::log_level.");
+
+#define VC_LOG_DISABLED()                                                      \
+  do {                                                                         \
+  } while (false)
+
 #define VC_LOG_IMPL(logger, vstamp, log_level, aid, fmt_str, ...)              \
-  (logger).log(vstamp, log_level, aid, PL_CURRENT_FUNCTION, __FILE__,          \
-               PL_SOURCE_LINE, fmt_str, __VA_ARGS__)
+  do {                                                                         \
+    auto& vc_log_logger = (logger);                                            \
+                                                                               \
+    if (vc_log_logger.is_enabled(log_level))                                   \
+      vc_log_logger.log(vstamp, log_level, aid, PL_CURRENT_FUNCTION, __FILE__, \
+                        __LINE__, fmt_str, __VA_ARGS__);                       \
+  } while (false)
 
+#if VC_LOG_MIN_LEVEL <= VC_LOG_LEVEL_TRACE
 #define VC_LOG_TRACE(logger, vstamp, aid, fmt_str, ...)                        \
   VC_LOG_IMPL(logger, vstamp, ::vc::log_level::trace, aid, fmt_str, __VA_ARGS__)
+#else
+#define VC_LOG_TRACE(logger, vstamp, aid, fmt_str, ...) VC_LOG_DISABLED()
+#endif
 
+#if VC_LOG_MIN_LEVEL <= VC_LOG_LEVEL_DEBUG
 #define VC_LOG_DEBUG(logger, vstamp, aid, fmt_str, ...)                        \
   VC_LOG_IMPL(logger, vstamp, ::vc::log_level::debug, aid, fmt_str, __VA_ARGS__)
+#else
+#define VC_LOG_DEBUG(logger, vstamp, aid, fmt_str, ...) VC_LOG_DISABLED()
+#endif
 
+#if VC_LOG_MIN_LEVEL <= VC_LOG_LEVEL_INFO
 #define VC_LOG_INFO(logger, vstamp, aid, fmt_str, ...)                         \
   VC_LOG_IMPL(logger, vstamp, ::vc::log_level::info, aid, fmt_str, __VA_ARGS__)
+#else
+#define VC_LOG_INFO(logger, vstamp, aid, fmt_str, ...) VC_LOG_DISABLED()
+#endif
 
+#if VC_LOG_MIN_LEVEL <= VC_LOG_LEVEL_WARNING
 #define VC_LOG_WARNING(logger, vstamp, aid, fmt_str, ...)                      \
   VC_LOG_IMPL(logger, vstamp, ::vc::log_level::warning, aid, fmt_str,          \
               __VA_ARGS__)
+#else
+#define VC_LOG_WARNING(logger, vstamp, aid, fmt_str, ...) VC_LOG_DISABLED()
+#endif
 
+#if VC_LOG_MIN_LEVEL <= VC_LOG_LEVEL_ERROR
 #define VC_LOG_ERROR(logger, vstamp, aid, fmt_str, ...)                        \
   VC_LOG_IMPL(logger, vstamp, ::vc::log_level::error, aid, fmt_str, __VA_ARGS__)
+#else
+#define VC_LOG_ERROR(logger, vstamp, aid, fmt_str, ...) VC_LOG_DISABLED()
+#endif
 
+#if VC_LOG_MIN_LEVEL <= VC_LOG_LEVEL_CRITICAL
 #define VC_LOG_CRITICAL(logger, vstamp, aid, fmt_str, ...)                     \
   VC_LOG_IMPL(logger, vstamp, ::vc::log_level::critical, aid, fmt_str,         \
               __VA_ARGS__)
+#else
+#define VC_LOG_CRITICAL(logger, vstamp, aid, fmt_str, ...) VC_LOG_DISABLED()
+#endif
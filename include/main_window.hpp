@@ -1,6 +1,4 @@
 #pragma once
-#include <fstream>
-
 #include <QMainWindow>
 
 #include <pl/annotations.hpp>
@@ -19,8 +17,8 @@ public:
    * Creates the main_window.
    * @param parent The QWidget parent.
    *
-   * Opens the log file.
-   * Initializes the logger.
+   * Initializes the logger, which writes to rotated memory-mapped log
+   * segments.
    * Creates the "Run"-button.
    */
   explicit main_window(QWidget* parent = PL_NO_PARENT);
@@ -31,7 +29,6 @@ private:
    */
   void on_button_click();
 
-  std::ofstream ofs_; /**< The output filestream for the logger */
   logger logger_;
 };
 } // namespace vc
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <QtGlobal>
+
+#include <tl/expected.hpp>
+#include <tl/optional.hpp>
+
+#include <pl/string_view.hpp>
+
+#include "actor_id.hpp"
+#include "error.hpp"
+
+namespace vc {
+/**
+ * The address of another node of the mesh.
+ */
+struct peer_address {
+  std::string host; /**< The host name or IP address of the peer */
+  quint16 port;     /**< The TCP port the peer listens on */
+};
+
+/**
+ * The configuration of a node of the mesh.
+ */
+struct mesh_config {
+  actor_id aid{0};                 /**< The unique actor_id of the node */
+  std::string host{"127.0.0.1"};   /**< The host name or IP to listen on */
+  quint16 port{0};                 /**< The TCP port to listen on */
+  std::vector<peer_address> peers; /**< The other nodes of the mesh */
+  size_t fanout{2}; /**< The amount of peers to gossip to per round */
+  std::chrono::milliseconds gossip_interval{100}; /**< Time between rounds */
+  std::chrono::milliseconds merge_interval{50}; /**< Time between batches */
+  std::chrono::milliseconds stats_interval{1000}; /**< Time between stats */
+  std::string log_file; /**< The log file, derived from `aid` if empty */
+};
+
+/**
+ * Reads the mesh configuration from the `mesh` section of a YAML file.
+ * @param config_filepath The path to the YAML file.
+ * @return An expected containing the mesh configuration or tl::nullopt if the
+ *         file has no `mesh` section; an error if the file couldn't be read or
+ *         the `mesh` section is invalid.
+ *
+ * Example:
+ * ```yaml
+ * mesh:
+ *   actor_id: 1
+ *   port: 20001
+ *   fanout: 2
+ *   gossip_interval_ms: 100
+ *   merge_interval_ms: 50
+ *   peers:
+ *     - port: 20002
+ *     - host: 127.0.0.1
+ *       port: 20003
+ * ```
+ */
+tl::expected<tl::optional<mesh_config>, error>
+parse_mesh_config(pl::string_view config_filepath);
+} // namespace vc
@@ -0,0 +1,158 @@
+#pragma once
+#include <cstdint>
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <tl/optional.hpp>
+
+#include <pl/annotations.hpp>
+#include <pl/noncopyable.hpp>
+
+#include "actor_id.hpp"
+#include "logger.hpp"
+#include "mesh_config.hpp"
+#include "packet.hpp"
+#include "vector_timestamp.hpp"
+
+namespace vc {
+/**
+ * A node of a peer-to-peer mesh that gossips its vector timestamp.
+ *
+ * Every gossip interval the node ticks its own clock and sends its vector
+ * timestamp to `fanout` randomly chosen peers. Incoming vector timestamps are
+ * collected and merged into the own vector timestamp in batches, once per
+ * merge interval, as a single receive event.
+ *
+ * To measure how long clock values take to propagate through the mesh, every
+ * gossip message carries the wall clock time at which each of its entries was
+ * ticked by its owner. A node records the propagation latency of a peer's
+ * entry when it first sees a new value of it, no matter how many hops it
+ * took. This requires the nodes to share a wall clock, e.g. a local mesh.
+ */
+class mesh_node : public QObject {
+  Q_OBJECT
+
+public:
+  PL_NONCOPYABLE(mesh_node);
+
+  /**
+   * Creates a mesh_node.
+   * @param config The configuration to use.
+   * @param l The logger to write to.
+   * @param parent The QObject parent to use.
+   */
+  mesh_node(mesh_config config, logger& l, QObject* parent = PL_NO_PARENT);
+
+  /**
+   * Closes all of the connections.
+   */
+  ~mesh_node() override;
+
+  /**
+   * Listens for connections from peers and starts gossiping.
+   * @return true on success; otherwise false, e.g. if the host to listen on
+   *         can't be resolved.
+   */
+  [[nodiscard]] bool start();
+
+private:
+  /**
+   * An outbound connection to a peer.
+   */
+  struct peer_connection {
+    peer_address address;
+    std::unique_ptr<QTcpSocket> socket;
+  };
+
+  /**
+   * When an actor ticked its clock to a value.
+   */
+  struct clock_origin {
+    uint64_t clock;   /**< The value of the actor's clock */
+    uint64_t tick_us; /**< Wall clock time of the tick in microseconds */
+  };
+
+  using origin_map = std::unordered_map<actor_id, clock_origin>;
+
+  /**
+   * Callback to handle incoming connections from peers.
+   */
+  void on_new_connection();
+
+  /**
+   * Callback to handle incoming data on a socket connected to a peer.
+   */
+  void on_peer_ready_read();
+
+  /**
+   * Sends the own vector timestamp to `fanout` randomly chosen peers.
+   */
+  void gossip();
+
+  /**
+   * Merges the batch of vector timestamps received since the last merge.
+   */
+  void merge_pending();
+
+  /**
+   * Prints statistics about the bandwidth and the clock propagation.
+   */
+  void print_stats();
+
+  /**
+   * Connects to the peers that aren't connected.
+   */
+  void connect_to_peers();
+
+  /**
+   * Handles a gossip packet received from a peer.
+   * @param pkt The packet received.
+   */
+  void handle_gossip(const packet& pkt);
+
+  /**
+   * Ticks the own clock and remembers when.
+   * @return true on success; otherwise false.
+   */
+  [[nodiscard]] bool tick();
+
+  /**
+   * Determines the highest value of an actor's clock received so far, merged
+   * or not.
+   * @param aid The actor.
+   * @return The highest value; 0 if none has been received.
+   */
+  [[nodiscard]] uint64_t seen_clock(actor_id aid) const;
+
+  mesh_config config_;
+  logger& logger_;
+  QTcpServer tcp_server_;
+  std::vector<QTcpSocket*> inbound_;
+  std::vector<peer_connection> peers_;
+  vector_timestamp vstamp_;
+  origin_map origins_; /**< The origins of the entries of vstamp_ */
+  tl::optional<vector_timestamp> pending_;
+  origin_map pending_origins_; /**< The origins of the entries of pending_ */
+  uint64_t pending_count_;
+  QTimer gossip_timer_;
+  QTimer merge_timer_;
+  QTimer stats_timer_;
+  std::mt19937 random_engine_;
+  uint64_t bytes_sent_;
+  uint64_t bytes_received_;
+  uint64_t gossip_sent_;
+  uint64_t gossip_received_;
+  uint64_t batches_merged_;
+  uint64_t propagation_count_;
+  uint64_t propagation_sum_us_;
+  uint64_t propagation_max_us_;
+};
+} // namespace vc
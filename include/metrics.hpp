@@ -0,0 +1,276 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <pl/noncopyable.hpp>
+
+namespace vc {
+/**
+ * The amount of shards of every counter and histogram, must be a power of
+ * two.
+ */
+constexpr size_t metric_shard_count = 16;
+
+/**
+ * Determines the shard the calling thread updates.
+ * @return The index of the calling thread's shard.
+ *
+ * The threads are assigned the shards round-robin, so that threads updating
+ * the same metric rarely share a cache line.
+ */
+size_t metric_shard_index() noexcept;
+
+/**
+ * Creates the upper bounds of histogram buckets that grow exponentially.
+ * @param start The upper bound of the first bucket, must not be 0.
+ * @param factor The factor between consecutive upper bounds, greater than 1.
+ * @param count The amount of buckets.
+ * @return The upper bounds, e.g. 1, 2, 4, 8 for (1, 2, 4).
+ */
+std::vector<uint64_t> exponential_buckets(uint64_t start, uint64_t factor,
+                                          size_t count);
+
+/**
+ * Monotonically increasing count, e.g. of requests handled.
+ *
+ * Every thread increments its own shard, so that incrementing is a single
+ * uncontended atomic addition. Reading sums up the shards.
+ */
+class counter {
+public:
+  PL_NONCOPYABLE(counter);
+
+  /**
+   * Creates a counter of 0.
+   */
+  counter() noexcept;
+
+  /**
+   * Increments the counter, may be called from any thread.
+   * @param amount The amount to add.
+   */
+  void add(uint64_t amount = 1U) noexcept {
+    shards_[metric_shard_index()].value.fetch_add(amount,
+                                                  std::memory_order_relaxed);
+  }
+
+  /**
+   * Read accessor for the count.
+   * @return The sum of the shards.
+   */
+  [[nodiscard]] uint64_t value() const noexcept;
+
+private:
+  struct alignas(64) shard {
+    std::atomic<uint64_t> value;
+  };
+
+  std::array<shard, metric_shard_count> shards_;
+};
+
+/**
+ * Value that may go up and down, e.g. the size of a vector clock.
+ */
+class gauge {
+public:
+  PL_NONCOPYABLE(gauge);
+
+  /**
+   * Creates a gauge of 0.
+   */
+  gauge() noexcept;
+
+  /**
+   * Replaces the value, may be called from any thread.
+   * @param value The new value.
+   */
+  void set(int64_t value) noexcept {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Adds to the value, may be called from any thread.
+   * @param amount The amount to add, negative to subtract.
+   */
+  void add(int64_t amount) noexcept {
+    value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  /**
+   * Read accessor for the value.
+   * @return The value.
+   */
+  [[nodiscard]] int64_t value() const noexcept;
+
+private:
+  alignas(64) std::atomic<int64_t> value_;
+};
+
+/**
+ * Distribution of values across buckets with fixed upper bounds, e.g. of
+ * the amount of entries of the vector timestamps merged.
+ *
+ * Like counter, every thread updates its own shard.
+ */
+class histogram {
+public:
+  PL_NONCOPYABLE(histogram);
+
+  /**
+   * Creates an empty histogram.
+   * @param upper_bounds The inclusive upper bounds of the buckets in
+   *                     ascending order. Values above the last bound are
+   *                     only counted in the implicit +Inf bucket.
+   */
+  explicit histogram(std::vector<uint64_t> upper_bounds);
+
+  /**
+   * Records a value, may be called from any thread.
+   * @param value The value to record.
+   */
+  void observe(uint64_t value) noexcept;
+
+  /**
+   * Read accessor for the upper bounds of the buckets.
+   * @return The upper bounds, excluding +Inf.
+   */
+  [[nodiscard]] const std::vector<uint64_t>& upper_bounds() const noexcept;
+
+  /**
+   * Calculates the cumulative bucket counts.
+   * @return The amount of values less than or equal to each upper bound,
+   *         followed by the amount of all values.
+   */
+  [[nodiscard]] std::vector<uint64_t> cumulative_counts() const;
+
+  /**
+   * Read accessor for the sum of the values recorded.
+   * @return The sum.
+   */
+  [[nodiscard]] uint64_t sum() const noexcept;
+
+private:
+  /**
+   * Accesses a cell of a shard.
+   * @param shard The index of the shard.
+   * @param index The index of the bucket, upper_bounds().size() + 1 for
+   *              the sum.
+   * @return The cell.
+   */
+  std::atomic<uint64_t>& cell(size_t shard, size_t index) const noexcept;
+
+  const std::vector<uint64_t> upper_bounds_;
+
+  /**
+   * The amount of cells per shard: the buckets including +Inf and the sum,
+   * rounded up to a multiple of a cache line.
+   */
+  const size_t stride_;
+  const std::unique_ptr<std::atomic<uint64_t>[]> cells_;
+};
+
+/**
+ * Set of named metrics that can be written in the Prometheus text format.
+ *
+ * Registering takes a lock, it is meant to be done once, keeping the
+ * reference returned. Updating the metrics is lock-free.
+ *
+ * A metric may consist of several series told apart by their labels, e.g.
+ * one per server of a process.
+ */
+class metrics_registry {
+public:
+  PL_NONCOPYABLE(metrics_registry);
+
+  /**
+   * Creates an empty metrics_registry.
+   */
+  metrics_registry();
+
+  /**
+   * Accessor for the registry that server, client and logger update.
+   * @return The global metrics_registry.
+   */
+  static metrics_registry& global();
+
+  /**
+   * Registers a counter, or looks it up if it was registered before.
+   * @param name The name of the counter, should end in "_total".
+   * @param help The description of the counter.
+   * @param labels The labels of the series, e.g. `actor_id="1"`; empty if
+   *               the counter has a single series.
+   * @return The counter, valid as long as the registry.
+   * @warning `name` must not be the name of another type of metric.
+   */
+  counter& add_counter(const std::string& name, const std::string& help,
+                       const std::string& labels = std::string());
+
+  /**
+   * Registers a gauge, or looks it up if it was registered before.
+   * @param name The name of the gauge.
+   * @param help The description of the gauge.
+   * @param labels The labels of the series, e.g. `actor_id="1"`; empty if
+   *               the gauge has a single series.
+   * @return The gauge, valid as long as the registry.
+   * @warning `name` must not be the name of another type of metric.
+   */
+  gauge& add_gauge(const std::string& name, const std::string& help,
+                   const std::string& labels = std::string());
+
+  /**
+   * Registers a histogram, or looks it up if it was registered before.
+   * @param name The name of the histogram.
+   * @param help The description of the histogram.
+   * @param upper_bounds The upper bounds of the buckets in ascending order,
+   *                     ignored if the histogram was registered before.
+   * @param labels The labels of the series, e.g. `actor_id="1"`; empty if
+   *               the histogram has a single series.
+   * @return The histogram, valid as long as the registry.
+   * @warning `name` must not be the name of another type of metric.
+   */
+  histogram& add_histogram(const std::string& name, const std::string& help,
+                           std::vector<uint64_t> upper_bounds,
+                           const std::string& labels = std::string());
+
+  /**
+   * Writes all of the metrics in the Prometheus text exposition format.
+   * @return The metrics, sorted by name.
+   */
+  [[nodiscard]] std::string to_prometheus() const;
+
+private:
+  /**
+   * Registers a metric, or looks it up if it was registered before.
+   * @tparam Metric The type of the metric.
+   * @tparam Args The types of the arguments of the constructor.
+   * @param name The name of the metric.
+   * @param help The description of the metric.
+   * @param labels The labels of the series.
+   * @param args The arguments of the constructor of the metric.
+   * @return The metric.
+   */
+  template <class Metric, class... Args>
+  Metric& add(const std::string& name, const std::string& help,
+              const std::string& labels, Args&&... args);
+
+  using series = std::variant<std::unique_ptr<counter>, std::unique_ptr<gauge>,
+                              std::unique_ptr<histogram>>;
+
+  struct family {
+    std::string help;
+    std::map<std::string, series> series_by_labels;
+  };
+
+  mutable std::mutex mu_;
+  std::map<std::string, family> families_;
+};
+} // namespace vc
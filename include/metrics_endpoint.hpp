@@ -0,0 +1,67 @@
+#pragma once
+#include <QByteArray>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <pl/annotations.hpp>
+#include <pl/noncopyable.hpp>
+
+#include "metrics.hpp"
+
+namespace vc {
+/**
+ * Minimal HTTP listener serving a metrics_registry in the Prometheus text
+ * format on `GET /metrics`.
+ *
+ * Every connection is answered once and then closed, which is all a
+ * Prometheus scraper or curl needs.
+ */
+class metrics_endpoint : public QObject {
+  Q_OBJECT
+
+public:
+  PL_NONCOPYABLE(metrics_endpoint);
+
+  /**
+   * Creates a metrics_endpoint that doesn't listen yet.
+   * @param registry The metrics to serve.
+   * @param parent The QObject parent to use.
+   */
+  explicit metrics_endpoint(const metrics_registry& registry,
+                            QObject* parent = PL_NO_PARENT);
+
+  /**
+   * Listens for incoming connections.
+   * @param address The address to listen on, should be a local one.
+   * @param port The TCP port to listen on.
+   * @return true on success; otherwise false.
+   */
+  [[nodiscard]] bool listen(const QHostAddress& address, quint16 port);
+
+private:
+  /**
+   * Callback to handle incoming connections.
+   */
+  void on_new_connection();
+
+  /**
+   * Answers the request buffered on a socket once its header is complete.
+   * @param socket The socket connected to the scraper.
+   */
+  void on_ready_read(QTcpSocket* socket);
+
+  /**
+   * Writes an HTTP response and closes the connection.
+   * @param socket The socket connected to the scraper.
+   * @param status The status line, e.g. "200 OK".
+   * @param body The body of the response.
+   */
+  static void respond(QTcpSocket* socket, const char* status,
+                      const QByteArray& body);
+
+  const metrics_registry& registry_;
+  QTcpServer tcp_server_;
+};
+} // namespace vc
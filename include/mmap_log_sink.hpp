@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+
+#include <memory>
+#include <string>
+
+#include <QFile>
+
+#include <tl/expected.hpp>
+
+#include "error.hpp"
+#include "log_sink.hpp"
+
+namespace vc {
+/**
+ * Options of the mmap_log_sink.
+ */
+struct mmap_log_options {
+  std::string path; /**< The path of the current segment */
+  size_t segment_byte_count{16U * 1024U * 1024U}; /**< Size of a segment */
+  size_t max_segment_count{4}; /**< Segments kept, including the current */
+};
+
+/**
+ * Writes log entries in the ShiViz text format into memory-mapped segments.
+ *
+ * Every segment is preallocated and mapped into memory, so that writing an
+ * entry is a plain copy rather than a system call. Once the current segment
+ * is full it is trimmed to the bytes used and the segments are rotated like
+ * logrotate does: `path` becomes `path.1`, `path.1` becomes `path.2` and so
+ * forth, dropping the oldest segment beyond max_segment_count. Every segment
+ * begins with the ShiViz-compatible regex, so each one can be opened in
+ * ShiViz on its own.
+ *
+ * If the process crashes the current segment keeps its preallocated size,
+ * its tail is filled with NUL bytes.
+ */
+class mmap_log_sink : public log_sink {
+public:
+  /**
+   * Creates an mmap_log_sink.
+   * @param options The options to use.
+   * @return An expected containing the mmap_log_sink; an error if the first
+   *         segment couldn't be created.
+   *
+   * An existing file at `options.path` is rotated rather than overwritten.
+   */
+  [[nodiscard]] static tl::expected<std::unique_ptr<mmap_log_sink>, error>
+  create(mmap_log_options options);
+
+  /**
+   * Trims the current segment to the bytes used.
+   */
+  ~mmap_log_sink() override;
+
+  void write(const log_record& record) override;
+
+  /**
+   * Does nothing, the entries are in the page cache as soon as they're
+   * written.
+   */
+  void flush() override;
+
+  /**
+   * Creates the path of a segment.
+   * @param path The path of the current segment.
+   * @param index The index of the segment, 0 being the current one.
+   * @return The path of the segment.
+   */
+  [[nodiscard]] static std::string segment_path(const std::string& path,
+                                                size_t index);
+
+private:
+  explicit mmap_log_sink(mmap_log_options options);
+
+  /**
+   * Creates, preallocates and maps the current segment, then writes the
+   * header to it.
+   * @param min_byte_count The amount of bytes that must fit after the header.
+   * @return An expected containing nothing on success; otherwise an error.
+   */
+  tl::expected<void, error> open_segment(size_t min_byte_count);
+
+  /**
+   * Unmaps the current segment and trims it to the bytes used.
+   */
+  void close_segment();
+
+  /**
+   * Renames the segments, dropping the oldest one.
+   * @return An expected containing nothing on success; otherwise an error.
+   */
+  tl::expected<void, error> rotate();
+
+  /**
+   * Copies bytes into the current segment.
+   * @param data The bytes to copy.
+   * @param byte_count The amount of bytes to copy.
+   * @warning The bytes must fit into the current segment.
+   */
+  void append(const char* data, size_t byte_count);
+
+  mmap_log_options options_;
+  QFile file_;
+  uchar* data_;
+  size_t capacity_;
+  size_t used_;
+  bool has_failed_;
+};
+} // namespace vc
@@ -0,0 +1,160 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <pl/noncopyable.hpp>
+
+namespace vc {
+/**
+ * Bounded lock-free multi-producer single-consumer queue.
+ * @tparam T The type of the elements.
+ *
+ * Based on Dmitry Vyukov's bounded queue: every cell carries a sequence
+ * number that tells producers and the consumer whether the cell is free or
+ * holds an element, so that neither side ever takes a lock. Producers only
+ * contend on the enqueue position, the consumer never contends.
+ */
+template <class T>
+class mpsc_queue {
+public:
+  PL_NONCOPYABLE(mpsc_queue);
+
+  /**
+   * Creates an empty mpsc_queue.
+   * @param capacity The maximum amount of elements, rounded up to the next
+   *                 power of two of at least 2.
+   */
+  explicit mpsc_queue(size_t capacity)
+    : mask_(round_up_to_power_of_two(capacity) - 1U),
+      cells_(std::make_unique<cell[]>(mask_ + 1U)),
+      enqueue_pos_(0),
+      dequeue_pos_(0) {
+    for (size_t i = 0; i <= mask_; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Destroys the elements that haven't been popped.
+   */
+  ~mpsc_queue() {
+    while (try_consume([](T&&) {})) {
+    }
+  }
+
+  /**
+   * Appends an element, may be called from any thread.
+   * @param value The element to append.
+   * @return true on success; false if the queue is full, in which case
+   *         `value` is left untouched.
+   */
+  bool try_push(T&& value) {
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      auto& c = cells_[pos & mask_];
+      const auto sequence = c.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence)
+                        - static_cast<std::ptrdiff_t>(pos);
+
+      if (diff == 0) {
+        // The cell is free, try to claim it.
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1U,
+                                               std::memory_order_relaxed)) {
+          new (&c.storage) T(std::move(value));
+          c.sequence.store(pos + 1U, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0) {
+        // The consumer hasn't freed the cell yet.
+        return false;
+      }
+      else {
+        // Another producer claimed the cell first.
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Removes the oldest element, must only be called from the consumer thread.
+   * @param value Assigned the element removed.
+   * @return true on success; false if the queue is empty.
+   */
+  bool try_pop(T& value) {
+    return try_consume([&value](T&& element) { value = std::move(element); });
+  }
+
+  /**
+   * Hands the oldest element to a callable and removes it, must only be
+   * called from the consumer thread.
+   * @tparam Consumer The type of the callable.
+   * @param consumer Invoked with an rvalue reference to the oldest element.
+   * @return true on success; false if the queue is empty.
+   *
+   * Unlike try_pop, doesn't require `T` to be default constructible.
+   */
+  template <class Consumer>
+  bool try_consume(Consumer&& consumer) {
+    const auto pos = dequeue_pos_;
+    auto& c = cells_[pos & mask_];
+
+    if (c.sequence.load(std::memory_order_acquire) != pos + 1U)
+      return false;
+
+    auto* element = std::launder(reinterpret_cast<T*>(&c.storage));
+    std::forward<Consumer>(consumer)(std::move(*element));
+    element->~T();
+
+    c.sequence.store(pos + mask_ + 1U, std::memory_order_release);
+    dequeue_pos_ = pos + 1U;
+    return true;
+  }
+
+  /**
+   * Calculates the amount of elements, must only be called from the consumer
+   * thread.
+   * @return The amount of elements, including the ones that producers are
+   *         still pushing.
+   */
+  [[nodiscard]] size_t size() const noexcept {
+    return enqueue_pos_.load(std::memory_order_relaxed) - dequeue_pos_;
+  }
+
+  /**
+   * Read accessor for the capacity.
+   * @return The maximum amount of elements.
+   */
+  [[nodiscard]] size_t capacity() const noexcept {
+    return mask_ + 1U;
+  }
+
+private:
+  struct cell {
+    std::atomic<size_t> sequence;
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+  };
+
+  static size_t round_up_to_power_of_two(size_t value) {
+    assert(value > 0 && "The capacity must not be 0!");
+
+    // With a single cell a full cell's sequence would look like a free one.
+    size_t result = 2;
+
+    while (result < value)
+      result <<= 1U;
+
+    return result;
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<cell[]> cells_;
+  alignas(64) std::atomic<size_t> enqueue_pos_;
+  alignas(64) size_t dequeue_pos_;
+};
+} // namespace vc
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+#include <iosfwd>
+
+namespace vc {
+/**
+ * The types of messages that can be sent in a packet.
+ *
+ * Responses use the opcode of the request they respond to and have the
+ * packet::response_flag set. The time published to subscribers is sent as
+ * responses to the subscribe request.
+ */
+enum class opcode : uint16_t {
+  time = 1,        /**< Requests the current time of the server */
+  echo = 2,        /**< Requests the server to send the payload back */
+  clock_sync = 3,  /**< Merges the vector timestamps of client and server */
+  subscribe = 4,   /**< Subscribes to the time published by the server */
+  unsubscribe = 5, /**< Cancels a subscription */
+  gossip = 6,      /**< Spreads a vector timestamp between mesh nodes */
+  hello = 7        /**< Negotiates the byte order of a connection */
+};
+
+/**
+ * Prints an opcode enumerator to an ostream.
+ * @param os The ostream to print to.
+ * @param op The opcode to print.
+ * @return A reference to `os`.
+ */
+std::ostream& operator<<(std::ostream& os, opcode op);
+} // namespace vc
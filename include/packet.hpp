@@ -1,11 +1,15 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 
+#include <memory_resource>
 #include <vector>
 
 #include <pl/byte.hpp>
 
+#include "byte_order.hpp"
 #include "error.hpp"
+#include "opcode.hpp"
 
 namespace vc {
 /**
@@ -13,48 +17,139 @@ namespace vc {
  */
 class packet {
 public:
+  /**
+   * Flag that marks a packet as the response to a request.
+   */
+  static constexpr uint16_t response_flag = 1U << 0;
+
+  /**
+   * Flag that marks a packet as carrying a trace context after its payload.
+   */
+  static constexpr uint16_t trace_context_flag = 1U << 1;
+
+  /**
+   * Flag that marks the vector timestamp of a packet as little-endian.
+   * Only set once the peers negotiated it with a hello request.
+   */
+  static constexpr uint16_t little_endian_vstamp_flag = 1U << 2;
+
+  /**
+   * The size of the header (opcode and flags) of a serialized packet in bytes.
+   */
+  static constexpr size_t header_byte_count = 2U * sizeof(uint16_t);
+
+  /**
+   * The maximum size of a trace context in bytes.
+   */
+  static constexpr size_t max_trace_context_byte_count = UINT16_MAX;
+
   /**
    * Creates a packet.
+   * @param op The opcode of the message.
+   * @param flags The flags of the message.
    * @param vstamp_data Pointer to the start of the memory region that
    *                    contains the vector timestamp.
    * @param vstamp_byte_count Size of the vector timestamp in bytes.
    * @param payload_data Pointer to the start of the memory region that
    *                     contains the payload.
    * @param payload_byte_count Size of the payload in bytes.
+   * @param resource The memory resource to allocate the buffers from.
+   *
+   * Copies of a packet allocate from the default memory resource.
    */
-  packet(const void* vstamp_data, size_t vstamp_byte_count,
-         const void* payload_data, size_t payload_byte_count);
+  packet(
+    opcode op, uint16_t flags, const void* vstamp_data,
+    size_t vstamp_byte_count, const void* payload_data,
+    size_t payload_byte_count,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
   /**
    * Deserializes a packet from a piece of memory.
    * @param data Pointer to the start of the memory region.
    * @param byte_count The size of the binary data containing a packet in bytes.
+   * @param resource The memory resource to allocate the buffers from.
    * @return An expected containing the packet if the deserialization succeeded;
-   * otherwise an error.
+   * otherwise an error whose errc tells why, created without allocating.
+   */
+  static tl::expected<packet, error> deserialize_from_binary(
+    const void* data, size_t byte_count,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /**
+   * Read accessor for the opcode.
+   * @return The opcode of this packet.
    */
-  static tl::expected<packet, error> deserialize_from_binary(const void* data,
-                                                             size_t byte_count);
+  [[nodiscard]] opcode op() const noexcept;
+
+  /**
+   * Read accessor for the flags.
+   * @return The flags of this packet.
+   */
+  [[nodiscard]] uint16_t flags() const noexcept;
+
+  /**
+   * Checks whether this packet is a response.
+   * @return true if the response_flag is set; otherwise false.
+   */
+  [[nodiscard]] bool is_response() const noexcept;
 
   /**
    * Read accessor for the vector timestamp buffer.
    * @return A reference to the vector timestamp buffer.
    */
-  [[nodiscard]] const std::vector<pl::byte>& vstamp_buffer() const noexcept;
+  [[nodiscard]] const std::pmr::vector<pl::byte>& vstamp_buffer() const
+    noexcept;
 
   /**
    * Read accessor for the payload buffer.
    * @return A reference to the payload buffer.
    */
-  [[nodiscard]] const std::vector<pl::byte>& payload_buffer() const noexcept;
+  [[nodiscard]] const std::pmr::vector<pl::byte>& payload_buffer() const
+    noexcept;
+
+  /**
+   * Determines the byte order of the vector timestamp.
+   * @return byte_order::little_endian if the little_endian_vstamp_flag is
+   *         set; otherwise byte_order::big_endian.
+   */
+  [[nodiscard]] byte_order vstamp_byte_order() const noexcept;
+
+  /**
+   * Checks whether this packet carries a trace context.
+   * @return true if the trace_context_flag is set; otherwise false.
+   */
+  [[nodiscard]] bool has_trace_context() const noexcept;
+
+  /**
+   * Read accessor for the trace context buffer.
+   * @return A reference to the trace context buffer, which is empty unless
+   *         has_trace_context() returns true.
+   */
+  [[nodiscard]] const std::pmr::vector<pl::byte>& trace_context_buffer() const
+    noexcept;
+
+  /**
+   * Attaches a trace context to this packet and sets the trace_context_flag.
+   * @param data Pointer to the start of the memory region that contains the
+   *             trace context, in the binary propagation format of the
+   *             tracer.
+   * @param byte_count Size of the trace context in bytes, at most
+   *                   max_trace_context_byte_count.
+   */
+  void set_trace_context(const void* data, size_t byte_count);
 
   /**
    * Serializes this packet to binary data to be sent over the wire.
-   * @return The resulting binary buffer.
+   * @return The resulting binary buffer, allocated from the default memory
+   *         resource, as it usually outlives the packet in a write queue.
    */
   [[nodiscard]] std::vector<pl::byte> serialize_to_binary() const;
 
 private:
-  std::vector<pl::byte> vstamp_buffer_;
-  std::vector<pl::byte> payload_buffer_;
+  opcode op_;
+  uint16_t flags_;
+  std::pmr::vector<pl::byte> vstamp_buffer_;
+  std::pmr::vector<pl::byte> payload_buffer_;
+  std::pmr::vector<pl::byte> trace_context_buffer_;
 };
 } // namespace vc
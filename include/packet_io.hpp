@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+#include <memory_resource>
+
+#include <QIODevice>
+
+#include <tl/expected.hpp>
+
+#include "error.hpp"
+#include "packet.hpp"
+
+namespace vc {
+/**
+ * The greatest size of a packet in bytes that has_complete_packet accepts,
+ * whatever limit it is passed. Keeps every offset within a packet
+ * representable as a qint64 and an int.
+ */
+constexpr uint64_t max_packet_byte_count = INT32_MAX;
+
+/**
+ * Checks whether a complete packet is buffered in a device.
+ * @param device The device to check, usually a QTcpSocket.
+ * @param max_byte_count The maximum size of a packet in bytes, capped at
+ *                       max_packet_byte_count.
+ * @return An expected containing true if a complete packet can be read from
+ *         `device` or false if more data is needed; an error if the packet is
+ *         larger than `max_byte_count`.
+ * @note Doesn't consume any data.
+ */
+tl::expected<bool, error> has_complete_packet(QIODevice& device,
+                                              uint64_t max_byte_count);
+
+/**
+ * Reads a packet from a device.
+ * @param device The device to read from, usually a QTcpSocket.
+ * @param resource The memory resource to allocate the packet and any
+ *                 temporary memory from.
+ * @return An expected containing the packet read on success; otherwise an
+ *         error.
+ * @warning A complete packet must be buffered in `device`.
+ */
+tl::expected<packet, error> read_packet(
+  QIODevice& device,
+  std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+} // namespace vc
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+
+namespace vc {
+/**
+ * Reads an unsigned integer option.
+ * @param parser The parser that processed the command line.
+ * @param option The option to read.
+ * @param value Assigned the value read.
+ * @return true if the option is a valid unsigned integer; otherwise false, in
+ *         which case the invalid option is reported on stderr.
+ */
+bool read_option(const QCommandLineParser& parser,
+                 const QCommandLineOption& option, uint64_t& value);
+} // namespace vc
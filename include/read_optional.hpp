@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+#include <chrono>
+
+#include <yaml-cpp/yaml.h>
+
+namespace vc {
+/**
+ * Reads an optional value from a YAML map.
+ * @tparam T The type of the value.
+ * @param node The YAML map to read from.
+ * @param key The key of the value.
+ * @param value Assigned the value read if `node` contains `key`; otherwise
+ *              left unchanged.
+ * @throws YAML::Exception if the value can't be converted to `T`.
+ */
+template <class T>
+void read_optional(const YAML::Node& node, const char* key, T& value) {
+  if (node[key])
+    value = node[key].as<T>();
+}
+
+/**
+ * Reads an optional duration given in milliseconds from a YAML map.
+ * @param node The YAML map to read from.
+ * @param key The key of the duration.
+ * @param value Assigned the duration read if `node` contains `key`;
+ *              otherwise left unchanged.
+ * @throws YAML::Exception if the value isn't an integer.
+ */
+inline void read_optional(const YAML::Node& node, const char* key,
+                          std::chrono::milliseconds& value) {
+  if (node[key])
+    value = std::chrono::milliseconds(node[key].as<int64_t>());
+}
+} // namespace vc
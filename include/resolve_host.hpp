@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+
+#include <QHostAddress>
+
+#include <tl/expected.hpp>
+
+#include "error.hpp"
+
+namespace vc {
+/**
+ * Resolves a host name or IP address.
+ * @param host The host name or IP address, e.g. from a configuration file.
+ * @return An expected containing the first address of `host` on success;
+ *         otherwise an error.
+ * @note Blocks while a host name is looked up, IP addresses are converted
+ *       without a lookup.
+ */
+tl::expected<QHostAddress, error> resolve_host(const std::string& host);
+} // namespace vc
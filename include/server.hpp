@@ -1,22 +1,42 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
 #include <vector>
 
+#include <QHostAddress>
 #include <QObject>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QTimer>
 
 #include <jaegertracing/Tracer.h>
 
 #include <pl/annotations.hpp>
 #include <pl/noncopyable.hpp>
 
+#include "actor_clock.hpp"
 #include "actor_id.hpp"
+#include "byte_order.hpp"
 #include "error.hpp"
 #include "logger.hpp"
+#include "metrics.hpp"
+#include "opcode.hpp"
 #include "packet.hpp"
 #include "vector_timestamp.hpp"
+#include "write_queue.hpp"
 
 namespace vc {
+/**
+ * The default interval at which the time is published to subscribers.
+ */
+constexpr std::chrono::milliseconds default_publish_interval{100};
+
 /**
  * Type for the timestamp server.
  */
@@ -26,13 +46,29 @@ class server : public QObject {
 public:
   PL_NONCOPYABLE(server);
 
+  /**
+   * Type of the callbacks that handle requests.
+   * Invoked with the socket connected to the sending client, the request
+   * received and the tracing span of the request, which is nullptr if the
+   * request isn't traced. The request is allocated from an arena that is
+   * reset once the handler returns, so it must not be kept.
+   */
+  using request_handler = std::function<void(
+    QTcpSocket*, const packet&, opentracing::Span*)>;
+
   /**
    * Creates a server object.
    * @param aid The unique actor_id to use.
    * @param l The logger to write to.
+   * @param limits The watermarks to use for the outbound queue of each
+   *               client connection.
    * @param parent The QObject parent to use.
+   *
+   * Registers the handlers for the time, echo, clock_sync, subscribe,
+   * unsubscribe and hello requests.
    */
-  server(actor_id aid, logger& l, QObject* parent = PL_NO_PARENT);
+  server(actor_id aid, logger& l, watermarks limits = default_watermarks,
+         QObject* parent = PL_NO_PARENT);
 
   /**
    * Shuts down the TCP server if it was started.
@@ -40,11 +76,72 @@ public:
   ~server() override;
 
   /**
-   * Listens for incoming connections.
+   * Listens for incoming connections on 127.0.0.1 and the server_port.
    * @return true on success; otherwise false.
    */
   [[nodiscard]] bool listen();
 
+  /**
+   * Listens for incoming connections.
+   * @param address The address to listen on.
+   * @param port The TCP port to listen on.
+   * @return true on success; otherwise false.
+   */
+  [[nodiscard]] bool listen(const QHostAddress& address, quint16 port);
+
+  /**
+   * Read accessor for the TCP port listened on.
+   * @return The port, chosen by the operating system if listen() was passed
+   *         port 0; 0 if not listening.
+   */
+  [[nodiscard]] quint16 port() const;
+
+  /**
+   * Registers the handler for requests with the given opcode.
+   * @param op The opcode to register the handler for.
+   * @param handler The handler to invoke for requests with opcode `op`.
+   *
+   * Replaces the handler that was previously registered for `op`, if any.
+   */
+  void register_handler(opcode op, request_handler handler);
+
+  /**
+   * Sets the interval at which the time is published to subscribers.
+   * @param interval The interval to use.
+   */
+  void set_publish_interval(std::chrono::milliseconds interval);
+
+  /**
+   * Read accessor for the amount of publications that were skipped for a
+   * subscriber, because its connection was paused.
+   * @return The amount of skipped publications.
+   */
+  [[nodiscard]] uint64_t skipped_publication_count() const noexcept;
+
+  /**
+   * Read accessor for the amount of times that a client connection reached
+   * the high watermark of its outbound queue.
+   * @return The amount of times reading from a client connection was paused.
+   */
+  [[nodiscard]] uint64_t pause_count() const noexcept;
+
+signals:
+  /**
+   * Emitted when reading from a client connection is paused, because its
+   * outbound queue reached the high watermark.
+   * @param socket The socket connected to the client.
+   * @param pending_byte_count The amount of bytes that haven't been written.
+   */
+  void connection_paused(QTcpSocket* socket, size_t pending_byte_count);
+
+  /**
+   * Emitted when reading from a client connection is resumed, because its
+   * outbound queue drained down to the low watermark.
+   * @param socket The socket connected to the client.
+   * @param pending_byte_count The amount of bytes that haven't been written.
+   */
+  void connection_resumed(QTcpSocket* socket, size_t pending_byte_count);
+
 private:
   /**
    * Sets up QObject connections.
@@ -61,22 +158,158 @@ private:
    */
   void on_client_ready_read();
 
+  /**
+   * Callback to handle a client socket having been disconnected.
+   */
+  void on_client_disconnected();
+
+  /**
+   * Callback to handle bytes having been written to a client socket.
+   * @param byte_count The amount of bytes that were written.
+   */
+  void on_client_bytes_written(qint64 byte_count);
+
+  /**
+   * Handles the requests buffered on a client socket until either no complete
+   * request is left or the connection is paused.
+   * @param socket The socket connected to the client.
+   * @param parent_span The parent tracing span, nullptr if not traced.
+   * @return false if the connection was aborted, in which case the client's
+   *         state has been erased; otherwise true.
+   */
+  bool process_client_requests(QTcpSocket* socket,
+                               const opentracing::Span* parent_span);
+
   /**
    * Reads a packet from a TCP socket connected to a client.
    * @param socket The socket to read from.
-   * @param parent_span The parent tracing span.
+   * @param parent_span The parent tracing span, nullptr if not traced.
+   * @param resource The memory resource to allocate the packet from.
    * @return The packet received on success; otherwise error.
    */
   static tl::expected<packet, error>
-  read_client_request(QTcpSocket* socket, const opentracing::Span& parent_span);
+  read_client_request(QTcpSocket* socket, const opentracing::Span* parent_span,
+                      std::pmr::memory_resource* resource);
 
   /**
    * Handles an incoming request from a client.
    * @param socket The socket connected to the sending client.
-   * @param parent_span The parent tracing span.
+   * @param parent_span The parent tracing span, nullptr if not traced.
+   *
+   * If the request carries the client's trace context, the span of the
+   * request becomes a child of the client's span and merely follows from
+   * `parent_span`.
    */
   void handle_client_request(QTcpSocket* socket,
-                             const opentracing::Span& parent_span);
+                             const opentracing::Span* parent_span);
+
+  /**
+   * Handles a time request by responding with the current time.
+   * @param socket The socket connected to the sending client.
+   * @param request The request received.
+   * @param span The tracing span of the request, which may be tagged;
+   *             nullptr if the request isn't traced.
+   */
+  void handle_time_request(QTcpSocket* socket, const packet& request,
+                           opentracing::Span* span);
+
+  /**
+   * Handles a request that actor_clock::answer responds to: an echo request
+   * is responded to with the payload received, a clock_sync request with the
+   * merged vector timestamp.
+   * @param socket The socket connected to the sending client.
+   * @param request The request received.
+   * @param span The tracing span of the request, which may be tagged;
+   *             nullptr if the request isn't traced.
+   */
+  void handle_stateless_request(QTcpSocket* socket, const packet& request,
+                                opentracing::Span* span);
+
+  /**
+   * Handles a subscribe request by adding the client to the subscribers and
+   * responding with the current time.
+   * @param socket The socket connected to the sending client.
+   * @param request The request received.
+   * @param span The tracing span of the request, which may be tagged;
+   *             nullptr if the request isn't traced.
+   */
+  void handle_subscribe_request(QTcpSocket* socket, const packet& request,
+                                opentracing::Span* span);
+
+  /**
+   * Handles an unsubscribe request by removing the client from the
+   * subscribers.
+   * @param socket The socket connected to the sending client.
+   * @param request The request received.
+   * @param span The tracing span of the request, which may be tagged;
+   *             nullptr if the request isn't traced.
+   */
+  void handle_unsubscribe_request(QTcpSocket* socket, const packet& request,
+                                  opentracing::Span* span);
+
+  /**
+   * Handles a hello request by choosing the byte order of the vector
+   * timestamps sent over the connection from the ones the client offered.
+   * @param socket The socket connected to the sending client.
+   * @param request The request received.
+   * @param span The tracing span of the request, which may be tagged;
+   *             nullptr if the request isn't traced.
+   */
+  void handle_hello_request(QTcpSocket* socket, const packet& request,
+                            opentracing::Span* span);
+
+  /**
+   * Sends the current time to all subscribers whose connection isn't paused.
+   *
+   * The packet is encoded at most once per byte order and shared by all of
+   * the subscribers that negotiated that byte order.
+   */
+  void publish();
+
+  /**
+   * Merges the vector timestamp of a request into the own vector timestamp as
+   * a receive event.
+   * @param request The request received.
+   * @return true on success; otherwise false.
+   * @note The vector timestamp of the request is decoded into the request
+   *       arena.
+   */
+  [[nodiscard]] bool receive(const packet& request);
+
+  /**
+   * Sends a response to a client as a send event.
+   * @param socket The socket connected to the client.
+   * @param op The opcode of the request being responded to.
+   * @param payload_data Pointer to the start of the payload.
+   * @param payload_byte_count Size of the payload in bytes.
+   * @return true on success; otherwise false.
+   * @note Only the frame queued, which outlives the request, is allocated
+   *       from the heap, everything else comes from the request arena.
+   */
+  [[nodiscard]] bool respond(QTcpSocket* socket, opcode op,
+                             const void* payload_data,
+                             size_t payload_byte_count);
+
+  /**
+   * Creates the sink that queues the responses to a client.
+   * @param socket The socket connected to the client.
+   * @return The sink.
+   */
+  [[nodiscard]] packet_sink response_sink(QTcpSocket* socket);
+
+  /**
+   * Appends a frame to the outbound queue of a client connection.
+   * @param socket The socket connected to the client.
+   * @param frame The binary frame to send.
+   */
+  void enqueue(QTcpSocket* socket, write_queue::frame frame);
+
+  /**
+   * Hands queued frames to a client socket as long as the socket's own
+   * write buffer is small.
+   * @param socket The socket connected to the client.
+   */
+  void flush(QTcpSocket* socket);
 
   actor_id aid_;
   logger& logger_;
@@ -84,5 +317,32 @@ private:
   QTcpServer tcp_server_;
   std::vector<QTcpSocket*> clients_;
   vector_timestamp vstamp_;
+
+  /**
+   * The series of vc_server_clock_entries labelled with this server's
+   * actor_id, so that the servers of a process don't overwrite each other.
+   */
+  gauge& clock_entries_;
+  watermarks limits_;
+  std::unordered_map<QTcpSocket*, write_queue> write_queues_;
+  std::unordered_map<QTcpSocket*, byte_order> byte_orders_;
+  uint64_t pause_count_;
+  std::unordered_map<opcode, request_handler> handlers_;
+  std::vector<QTcpSocket*> subscribers_;
+  QTimer publish_timer_;
+  uint64_t skipped_publication_count_;
+  std::unique_ptr<std::byte[]> request_arena_buffer_;
+
+  /**
+   * Holds the memory allocated while handling a single request, released
+   * after each request, so that handling a request doesn't touch the heap.
+   */
+  std::pmr::monotonic_buffer_resource request_arena_;
+
+  /**
+   * Applies the clock rules to the requests and responses, shared with the
+   * simulator.
+   */
+  actor_clock clock_;
 };
 } // namespace vc
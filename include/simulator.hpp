@@ -0,0 +1,275 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include <pl/byte.hpp>
+#include <pl/noncopyable.hpp>
+
+#include "actor_clock.hpp"
+#include "actor_id.hpp"
+#include "opcode.hpp"
+#include "packet.hpp"
+#include "vector_timestamp.hpp"
+
+namespace vc {
+/**
+ * Type of the simulated time, which starts at 0.
+ */
+using sim_time = std::chrono::microseconds;
+
+/**
+ * The behavior of the simulated network.
+ *
+ * The latency of every packet is drawn uniformly from
+ * [min_latency, max_latency], so that packets sent close together may
+ * overtake one another. On top of that, reorder_probability of the packets
+ * are held back by reorder_delay.
+ */
+struct sim_network_options {
+  sim_time min_latency{100};    /**< Least one-way latency */
+  sim_time max_latency{1000};   /**< Greatest one-way latency, jitter aside */
+  double loss_probability{0.0}; /**< Share of the packets dropped */
+  double reorder_probability{0.0}; /**< Share of the packets held back */
+  sim_time reorder_delay{5000};    /**< Added to the held back packets */
+};
+
+/**
+ * The options of a simulator.
+ */
+struct sim_options {
+  uint64_t seed{1};          /**< Seeds every random decision */
+  size_t server_count{1};    /**< Actors that respond to requests */
+  size_t client_count{100};  /**< Actors that send requests */
+  sim_time request_interval{10000}; /**< Between the requests of a client */
+  opcode request_op{opcode::echo};  /**< echo or clock_sync */
+  size_t payload_byte_count{16};    /**< The size of each payload */
+  sim_time sample_interval{100000}; /**< Between clock size samples, 0: off */
+  sim_network_options network;      /**< The simulated network */
+
+  /**
+   * Whether the servers respond with their whole vector timestamp, like the
+   * server does, or with their own entry only.
+   */
+  sent_entries response_entries{sent_entries::all};
+};
+
+/**
+ * Counters of a simulation.
+ *
+ * All of them except for merge_wall_time only depend on the options, so that
+ * two runs with the same options can be compared.
+ */
+struct sim_stats {
+  uint64_t event_count;       /**< Events processed */
+  uint64_t sent_count;        /**< Packets sent */
+  uint64_t delivered_count;   /**< Packets delivered */
+  uint64_t dropped_count;     /**< Packets lost by the network */
+  uint64_t reordered_count;   /**< Packets held back by the network */
+  uint64_t decode_failures;   /**< Packets that couldn't be decoded */
+  uint64_t merge_count;       /**< Vector timestamps merged */
+  uint64_t merged_entries;    /**< Entries of the vector timestamps merged */
+  uint64_t sent_bytes;        /**< Bytes of the packets sent */
+  std::chrono::nanoseconds merge_wall_time; /**< Real time spent receiving */
+};
+
+/**
+ * The sizes of the vector timestamps at a point in simulated time.
+ */
+struct clock_sample {
+  sim_time at;         /**< When the sample was taken */
+  double mean_entries; /**< Mean entries per vector timestamp */
+  size_t max_entries;  /**< Entries of the largest vector timestamp */
+};
+
+/**
+ * Deterministic discrete-event simulator of servers and clients.
+ *
+ * Hosts many actors in a single thread, without sockets or an event loop.
+ * The actors exchange serialized packets and apply the clock rules of the
+ * server to them using actor_clock: a send event ticks the own clock and
+ * sends the vector timestamp along, a receive event decodes the peer's vector
+ * timestamp, ticks the own clock and merges.
+ *
+ * Every client sends a request to a randomly chosen server once per request
+ * interval; the server answers it like the server does. Every random
+ * decision is drawn from a single engine seeded with sim_options::seed and
+ * simultaneous events are processed in the order they were scheduled, so
+ * that the same options always lead to the same simulation. Simulated time
+ * only advances from event to event, which is usually far faster than real
+ * time.
+ *
+ * The clocks of all actors converge to an entry per actor, so with full
+ * vector timestamps in the responses the cost of an event grows with the
+ * amount of actors. With sent_entries::own the clients only learn the
+ * servers' own entries, which keeps the cost of an event constant, e.g. for
+ * 10000 clients requesting once per second.
+ */
+class simulator {
+public:
+  PL_NONCOPYABLE(simulator);
+
+  /**
+   * Creates a simulator and schedules the first request of every client.
+   * @param options The options to use.
+   *
+   * The servers are the actors 0 to server_count - 1, followed by the
+   * clients. Actor i has the actor_id i + 1.
+   */
+  explicit simulator(sim_options options);
+
+  /**
+   * Processes the events up to a point in simulated time.
+   * @param end The simulated time to stop at, events scheduled for later
+   *            remain pending.
+   */
+  void run_until(sim_time end);
+
+  /**
+   * Read accessor for the simulated time.
+   * @return The time of the last event processed, or the end passed to
+   *         run_until, whichever is later.
+   */
+  [[nodiscard]] sim_time now() const noexcept;
+
+  /**
+   * Read accessor for the counters.
+   * @return The counters.
+   */
+  [[nodiscard]] const sim_stats& stats() const noexcept;
+
+  /**
+   * Read accessor for the clock size samples.
+   * @return The samples taken so far, oldest first.
+   */
+  [[nodiscard]] const std::vector<clock_sample>& clock_samples() const
+    noexcept;
+
+  /**
+   * Read accessor for the amount of actors.
+   * @return The amount of servers and clients.
+   */
+  [[nodiscard]] size_t actor_count() const noexcept;
+
+  /**
+   * Read accessor for the vector timestamp of an actor.
+   * @param index The index of the actor, less than actor_count().
+   * @return The actor's vector timestamp.
+   */
+  [[nodiscard]] const vector_timestamp& vstamp_of(size_t index) const;
+
+  /**
+   * Hashes the vector timestamps of all of the actors.
+   * @return The hash, equal for equal vector timestamps regardless of the
+   *         order of their entries.
+   *
+   * Meant to compare the outcome of two simulations.
+   */
+  [[nodiscard]] uint64_t fingerprint() const;
+
+private:
+  /**
+   * The kinds of events.
+   */
+  enum class event_kind {
+    request_due, /**< A client is to send its next request */
+    delivery,    /**< A packet arrives at an actor */
+    sample       /**< The clock sizes are to be sampled */
+  };
+
+  /**
+   * An event scheduled for a point in simulated time.
+   */
+  struct event {
+    sim_time at;
+    uint64_t sequence; /**< Orders events scheduled for the same time */
+    event_kind kind;
+    size_t from;                 /**< The sending actor, for deliveries */
+    size_t to;                   /**< The actor the event happens at */
+    std::vector<pl::byte> frame; /**< The serialized packet, for deliveries */
+  };
+
+  /**
+   * Orders the event heap so that the earliest event is at the front.
+   */
+  struct later {
+    bool operator()(const event& lhs, const event& rhs) const noexcept;
+  };
+
+  /**
+   * Adds an event to the event heap.
+   * @param e The event to add.
+   */
+  void schedule(event e);
+
+  /**
+   * Processes a single event.
+   * @param e The event.
+   */
+  void process(event& e);
+
+  /**
+   * Creates the sink that hands the packets an actor sends to the network.
+   * @param from The sending actor.
+   * @param to The receiving actor.
+   * @return The sink.
+   */
+  [[nodiscard]] packet_sink network_sink(size_t from, size_t to);
+
+  /**
+   * Sends a packet over the simulated network.
+   * @param from The sending actor.
+   * @param to The receiving actor.
+   * @param pkt The packet, the send event already happened.
+   */
+  void transmit(size_t from, size_t to, const packet& pkt);
+
+  /**
+   * Handles a packet arriving at an actor as a receive event.
+   * @param e The delivery event.
+   */
+  void deliver(event& e);
+
+  /**
+   * Records the sizes of the vector timestamps of all of the actors.
+   */
+  void take_sample();
+
+  /**
+   * Draws a number uniformly from [0, 1).
+   * @return The number.
+   */
+  double next_unit();
+
+  /**
+   * Draws a duration uniformly from [min, max].
+   * @param min The least duration.
+   * @param max The greatest duration.
+   * @return The duration.
+   */
+  sim_time next_duration(sim_time min, sim_time max);
+
+  sim_options options_;
+  std::mt19937_64 random_engine_;
+  std::vector<vector_timestamp> vstamps_; /**< Servers first */
+  std::vector<actor_clock> clocks_;       /**< The clocks of vstamps_ */
+  std::vector<pl::byte> payload_;
+  std::vector<event> events_; /**< Heap ordered by later */
+  uint64_t next_sequence_;
+  sim_time now_;
+  sim_stats stats_;
+  std::vector<clock_sample> clock_samples_;
+  std::unique_ptr<std::byte[]> arena_buffer_;
+
+  /**
+   * Holds the packets and vector timestamps encoded and decoded by a single
+   * event, released after each event.
+   */
+  std::pmr::monotonic_buffer_resource arena_;
+};
+} // namespace vc
@@ -0,0 +1,128 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <pl/noncopyable.hpp>
+
+namespace vc {
+/**
+ * Bounded lock-free single-producer single-consumer queue.
+ * @tparam T The type of the elements.
+ *
+ * A ring buffer whose producer only writes the tail and whose consumer only
+ * writes the head, so that neither side needs a read-modify-write operation.
+ * Each side caches the other side's position to avoid touching its cache line
+ * on every call.
+ */
+template <class T>
+class spsc_queue {
+public:
+  PL_NONCOPYABLE(spsc_queue);
+
+  /**
+   * Creates an empty spsc_queue.
+   * @param capacity The maximum amount of elements, rounded up to the next
+   *                 power of two.
+   */
+  explicit spsc_queue(size_t capacity)
+    : mask_(round_up_to_power_of_two(capacity) - 1U),
+      slots_(std::make_unique<slot[]>(mask_ + 1U)),
+      head_(0),
+      cached_tail_(0),
+      tail_(0),
+      cached_head_(0) {
+  }
+
+  /**
+   * Destroys the elements that haven't been consumed.
+   */
+  ~spsc_queue() {
+    while (try_consume([](T&&) {})) {
+    }
+  }
+
+  /**
+   * Appends an element, must only be called from the producer thread.
+   * @param value The element to append.
+   * @return true on success; false if the queue is full, in which case
+   *         `value` is left untouched.
+   */
+  bool try_push(T&& value) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+
+      if (tail - cached_head_ > mask_)
+        return false;
+    }
+
+    new (&slots_[tail & mask_].storage) T(std::move(value));
+    tail_.store(tail + 1U, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Hands the oldest element to a callable and removes it, must only be
+   * called from the consumer thread.
+   * @tparam Consumer The type of the callable.
+   * @param consumer Invoked with an rvalue reference to the oldest element.
+   * @return true on success; false if the queue is empty.
+   */
+  template <class Consumer>
+  bool try_consume(Consumer&& consumer) {
+    const auto head = head_.load(std::memory_order_relaxed);
+
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+
+      if (head == cached_tail_)
+        return false;
+    }
+
+    auto* element = std::launder(
+      reinterpret_cast<T*>(&slots_[head & mask_].storage));
+    std::forward<Consumer>(consumer)(std::move(*element));
+    element->~T();
+
+    head_.store(head + 1U, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Read accessor for the capacity.
+   * @return The maximum amount of elements.
+   */
+  [[nodiscard]] size_t capacity() const noexcept {
+    return mask_ + 1U;
+  }
+
+private:
+  struct slot {
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+  };
+
+  static size_t round_up_to_power_of_two(size_t value) {
+    assert(value > 0 && "The capacity must not be 0!");
+
+    size_t result = 1;
+
+    while (result < value)
+      result <<= 1U;
+
+    return result;
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<slot[]> slots_;
+  alignas(64) std::atomic<size_t> head_;
+  size_t cached_tail_;
+  alignas(64) std::atomic<size_t> tail_;
+  size_t cached_head_;
+};
+} // namespace vc
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+
+#include <memory>
+
+#include <opentracing/tracer.h>
+
+#include <tl/expected.hpp>
+
+#include "error.hpp"
+#include "packet.hpp"
+
+namespace vc {
+/**
+ * Attaches the context of a span to a packet, so that the receiver can
+ * continue the trace.
+ * @param pkt The packet to attach the trace context to.
+ * @param span The span whose context to attach.
+ *
+ * Uses the binary propagation format of the global tracer. Leaves `pkt`
+ * unchanged if the tracer doesn't produce a trace context, e.g. if it's the
+ * no-op tracer.
+ */
+void inject_trace_context(packet& pkt, const opentracing::Span& span);
+
+/**
+ * Extracts the trace context attached to a packet.
+ * @param pkt The packet to extract the trace context from.
+ * @return An expected containing the span context, or nullptr if `pkt` has
+ *         none; an error if the trace context is malformed.
+ */
+tl::expected<std::unique_ptr<opentracing::SpanContext>, error>
+extract_trace_context(const packet& pkt);
+} // namespace vc
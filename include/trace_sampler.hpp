@@ -0,0 +1,169 @@
+#pragma once
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <opentracing/tracer.h>
+
+#include <tl/expected.hpp>
+
+#include <pl/noncopyable.hpp>
+
+#include "error.hpp"
+
+namespace vc {
+/**
+ * The ways of deciding which requests are traced.
+ */
+enum class sampling_mode {
+  always,        /**< Trace every request */
+  never,         /**< Trace no request */
+  probabilistic, /**< Trace a fixed fraction of the requests */
+  rate_limiting, /**< Trace at most a fixed amount of requests per second */
+  adaptive       /**< Adjust the fraction to a target amount per second */
+};
+
+/**
+ * The configuration of a trace_sampler.
+ */
+struct sampler_config {
+  sampling_mode mode{sampling_mode::always}; /**< The way of sampling */
+
+  /**
+   * The probability in the probabilistic mode, the maximum amount of traces
+   * per second in the rate limiting mode and the target amount of traces
+   * per second in the adaptive mode.
+   */
+  double param{1.0};
+};
+
+/**
+ * Parses a sampler_config.
+ * @param type The name of the mode, e.g. "rate_limiting".
+ * @param param The parameter of the mode.
+ * @return An expected containing the sampler_config; an error if `type` is
+ *         unknown or `param` is out of range.
+ */
+tl::expected<sampler_config, error> parse_sampler_config(
+  const std::string& type, double param);
+
+/**
+ * Decides whether a request is traced, before any span is created.
+ *
+ * A request that isn't sampled doesn't cost more than the decision: no span
+ * is started, no tag is built and no span context is allocated or sent.
+ * Requests whose client sent a trace context are always traced, so that
+ * the decision of the client is respected.
+ *
+ * The decision is lock-free and may be made from any thread.
+ */
+class trace_sampler {
+public:
+  PL_NONCOPYABLE(trace_sampler);
+
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * Creates a trace_sampler.
+   * @param config The configuration to use.
+   */
+  explicit trace_sampler(sampler_config config = {});
+
+  /**
+   * Decides whether to trace a request.
+   * @return true if the request shall be traced; otherwise false.
+   */
+  [[nodiscard]] bool should_sample() noexcept;
+
+  /**
+   * Decides whether to trace a request arriving at a given time.
+   * @param now The current time.
+   * @return true if the request shall be traced; otherwise false.
+   */
+  [[nodiscard]] bool should_sample(clock::time_point now) noexcept;
+
+  /**
+   * Read accessor for the configuration.
+   * @return The configuration.
+   */
+  [[nodiscard]] const sampler_config& config() const noexcept;
+
+  /**
+   * Read accessor for the current sampling probability.
+   * @return The probability of the probabilistic and adaptive modes; 1 or 0
+   *         in the other modes.
+   */
+  [[nodiscard]] double probability() const noexcept;
+
+  /**
+   * Accessor for the global trace_sampler used by server and client.
+   * @return The global trace_sampler, sampling everything unless replaced
+   *         with init_global.
+   */
+  static trace_sampler& global() noexcept;
+
+  /**
+   * Replaces the global trace_sampler.
+   * @param config The configuration of the new global trace_sampler.
+   * @warning Must be called before any other thread uses the global
+   *          trace_sampler.
+   */
+  static void init_global(sampler_config config);
+
+private:
+  /**
+   * Draws from the calling thread's random number generator.
+   * @param threshold The probability scaled to the range of uint64_t.
+   * @return true with the probability given.
+   */
+  static bool draw(uint64_t threshold) noexcept;
+
+  /**
+   * Calculates the maximum balance of the rate limiter.
+   * @return The credits of one second worth of traces, at least one trace.
+   */
+  [[nodiscard]] int64_t max_credits() const noexcept;
+
+  /**
+   * Refills the rate limiter and takes the credits of a trace.
+   * @param now The current time.
+   * @return true if there were enough credits; otherwise false.
+   */
+  bool take_token(clock::time_point now) noexcept;
+
+  /**
+   * Counts a request and recalculates the probability of the adaptive mode
+   * once per window.
+   * @param now The current time.
+   */
+  void adapt(clock::time_point now) noexcept;
+
+  const sampler_config config_;
+  std::atomic<uint64_t> threshold_;
+  std::atomic<int64_t> credits_;
+  std::atomic<int64_t> last_refill_ns_;
+  std::atomic<uint64_t> window_request_count_;
+  std::atomic<int64_t> window_start_ns_;
+};
+
+/**
+ * Starts the root span of a request if the global trace_sampler samples it.
+ * @param operation_name The name of the span.
+ * @return The span; nullptr if the request isn't traced.
+ */
+std::unique_ptr<opentracing::Span>
+start_sampled_span(opentracing::string_view operation_name);
+
+/**
+ * Starts a child span of a traced request.
+ * @param operation_name The name of the span.
+ * @param parent The parent span, nullptr if the request isn't traced.
+ * @return The span; nullptr if `parent` is nullptr.
+ */
+std::unique_ptr<opentracing::Span>
+start_child_span(opentracing::string_view operation_name,
+                 const opentracing::Span* parent);
+} // namespace vc
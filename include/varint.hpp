@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+#include <string>
+
+#include <tl/expected.hpp>
+
+#include "error.hpp"
+
+namespace vc {
+/**
+ * The most bytes an unsigned LEB128 encoded 64 bit integer takes.
+ */
+constexpr unsigned max_varint_byte_count = 10;
+
+/**
+ * Appends an unsigned LEB128 encoded integer to a buffer.
+ * @param buffer The buffer to append to.
+ * @param value The value to encode, using 1 to 10 bytes.
+ */
+void append_varint(std::string& buffer, uint64_t value);
+
+/**
+ * Decodes an unsigned LEB128 encoded integer.
+ * @param cursor The position to start reading at, advanced past the integer
+ *               on success.
+ * @param end One past the last readable byte.
+ * @return An expected containing the value decoded; an error if the integer
+ *         is truncated, longer than max_varint_byte_count bytes or exceeds 64
+ *         bits.
+ */
+tl::expected<uint64_t, error> read_varint(const char*& cursor,
+                                          const char* end);
+} // namespace vc
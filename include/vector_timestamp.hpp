@@ -1,14 +1,18 @@
 #pragma once
 #include <iosfwd>
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
 
+#include <fmt/format.h>
+
 #include <tl/expected.hpp>
 #include <tl/optional.hpp>
 
 #include <pl/byte.hpp>
 
 #include "actor_id.hpp"
+#include "byte_order.hpp"
 #include "error.hpp"
 
 namespace vc {
@@ -17,25 +21,52 @@ namespace vc {
  */
 class vector_timestamp {
 public:
+  /**
+   * Type of the actor_id / clock pairs.
+   *
+   * Copies of a vector_timestamp allocate from the default memory resource,
+   * so that a copy may outlive the memory resource of the original.
+   */
+  using map_type = std::pmr::unordered_map<actor_id, uint64_t>;
+
   /**
    * Creates a vector_timestamp object.
    * @param aid The actor_id to use.
+   * @param resource The memory resource to allocate from.
    *
    * Creates a vector_timestamp object containing the actor_id given
    * having it be associated with a clock with a count of 0.
    */
-  explicit vector_timestamp(actor_id aid);
+  explicit vector_timestamp(
+    actor_id aid,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
   /**
    * Deserializes a vector_timestamp from binary data.
    * @param pointer Pointer to the start of the memory region containing
    *                binary vector_timestamp data.
    * @param byte_count The size of the memory pointed to by `pointer` in bytes.
+   * @param order The byte order of the integers, big-endian unless another
+   *              one was negotiated with the sender.
+   * @param resource The memory resource to allocate the vector_timestamp and
+   *                 any temporary memory from, e.g. an arena that lives as
+   *                 long as the request being handled.
    * @return An expected containing the vector_timestamp on success; otherwise
    *         an error object.
    */
   [[nodiscard]] static tl::expected<vector_timestamp, error>
-  deserialize_from_binary(const void* pointer, size_t byte_count);
+  deserialize_from_binary(
+    const void* pointer, size_t byte_count,
+    byte_order order = byte_order::big_endian,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /**
+   * Creates a vector_timestamp from actor_id / clock pairs.
+   * @param entries The actor_id / clock pairs to use.
+   * @return The resulting vector_timestamp.
+   */
+  [[nodiscard]] static vector_timestamp
+  from_entries(std::unordered_map<actor_id, uint64_t> entries);
 
   /**
    * Increases the logical clock for the actor_id `aid`.
@@ -53,17 +84,76 @@ public:
    */
   vector_timestamp& merge(const vector_timestamp& other);
 
+  /**
+   * Checks whether this vector_timestamp causally precedes `other`.
+   * @param other The other vector_timestamp.
+   * @return true if no clock of this vector_timestamp is greater than the one
+   *         in `other` and at least one is less; otherwise false.
+   *
+   * Actors missing from a vector_timestamp are treated as having a clock
+   * of 0.
+   */
+  [[nodiscard]] bool happened_before(const vector_timestamp& other) const;
+
+  /**
+   * Read accessor for the amount of actors in this vector_timestamp.
+   * @return The amount of actor_id / clock pairs.
+   */
+  [[nodiscard]] size_t size() const noexcept;
+
+  /**
+   * Read accessor for the actor_id / clock pairs.
+   * @return The actor_id / clock pairs, in no particular order.
+   */
+  [[nodiscard]] const map_type& entries() const noexcept;
+
   /**
    * Serializes this vector_timestamp to JSON.
    * @return A QString containing JSON data.
    */
   [[nodiscard]] QString to_json() const;
 
+  /**
+   * Writes the JSON representation of this vector_timestamp to an output
+   * iterator, without creating a QString.
+   * @tparam OutputIterator The type of the output iterator.
+   * @param out The output iterator to write to.
+   * @return The output iterator past the last character written.
+   *
+   * Writes the same characters as to_json().
+   */
+  template <class OutputIterator>
+  OutputIterator format_json(OutputIterator out) const {
+    *out++ = '{';
+
+    auto is_first = true;
+
+    for (const auto& [aid, clock] : data_) {
+      if (!is_first) {
+        *out++ = ',';
+        *out++ = ' ';
+      }
+
+      is_first = false;
+      out = fmt::format_to(out, "\"{}\":{}", aid, clock);
+    }
+
+    *out++ = '}';
+    return out;
+  }
+
   /**
    * Serialize this vector_timestamp to binary.
+   * @param order The byte order of the integers, big-endian unless another
+   *              one was negotiated with the receiver.
+   * @param resource The memory resource to allocate the buffer and any
+   *                 temporary memory from.
    * @return The resulting binary buffer.
    */
-  [[nodiscard]] std::vector<pl::byte> serialize_to_binary() const;
+  [[nodiscard]] std::pmr::vector<pl::byte> serialize_to_binary(
+    byte_order order = byte_order::big_endian,
+    std::pmr::memory_resource* resource
+    = std::pmr::get_default_resource()) const;
 
   /**
    * Implements equality comparison for vector_timestamps.
@@ -87,9 +177,26 @@ public:
                                   const vector_timestamp& vstamp);
 
 private:
-  explicit vector_timestamp(
-    std::unordered_map<actor_id, uint64_t>&& map) noexcept;
+  explicit vector_timestamp(map_type&& map) noexcept;
 
-  std::unordered_map<actor_id, uint64_t> data_;
+  map_type data_;
 };
 } // namespace vc
+
+namespace fmt {
+/**
+ * Formats a vector_timestamp as JSON, like operator<<.
+ */
+template <>
+struct formatter<::vc::vector_timestamp> {
+  constexpr auto parse(format_parse_context& ctx) -> decltype(ctx.begin()) {
+    return ctx.begin();
+  }
+
+  template <class FormatContext>
+  auto format(const ::vc::vector_timestamp& vstamp, FormatContext& ctx) const
+    -> decltype(ctx.out()) {
+    return vstamp.format_json(ctx.out());
+  }
+};
+} // namespace fmt
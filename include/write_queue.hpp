@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <pl/byte.hpp>
+
+namespace vc {
+/**
+ * The watermarks used for flow control of a write_queue.
+ */
+struct watermarks {
+  size_t low;  /**< Reading resumes once the queue drains to this many bytes */
+  size_t high; /**< Reading pauses once the queue holds this many bytes */
+};
+
+/**
+ * The default watermarks used by the server.
+ */
+constexpr watermarks default_watermarks{64U * 1024U, 1024U * 1024U};
+
+/**
+ * Per-connection outbound queue with high / low watermark flow control.
+ *
+ * Accounts for every byte from the moment it is pushed until the socket
+ * reports it as written, so that the bytes buffered inside of the socket
+ * count towards the watermarks as well.
+ *
+ * Frames are shared, so that a frame that is sent to many connections is only
+ * encoded once.
+ */
+class write_queue {
+public:
+  /**
+   * Type of the frames stored.
+   */
+  using frame = std::shared_ptr<const std::vector<pl::byte>>;
+
+  /**
+   * Describes how the flow control state changed due to an operation.
+   */
+  enum class transition {
+    none,   /**< The flow control state didn't change */
+    paused, /**< The high watermark was reached */
+    resumed /**< The queue drained down to the low watermark */
+  };
+
+  /**
+   * Creates an empty write_queue.
+   * @param limits The watermarks to use.
+   * @warning `limits.low` must not be greater than `limits.high`.
+   */
+  explicit write_queue(watermarks limits = default_watermarks);
+
+  /**
+   * Appends a frame to the end of the queue.
+   * @param f The binary frame to append, may be shared with other queues.
+   * @return transition::paused if this push reached the high watermark;
+   *         otherwise transition::none.
+   * @warning `f` must not be null.
+   */
+  transition push(frame f);
+
+  /**
+   * Appends a frame to the end of the queue.
+   * @param bytes The binary frame to append.
+   * @return transition::paused if this push reached the high watermark;
+   *         otherwise transition::none.
+   */
+  transition push(std::vector<pl::byte> bytes);
+
+  /**
+   * Checks whether there are frames that haven't been handed to the socket.
+   * @return true if there are no queued frames; otherwise false.
+   */
+  [[nodiscard]] bool empty() const noexcept;
+
+  /**
+   * Read accessor for the oldest queued frame.
+   * @return A reference to the oldest queued frame.
+   * @warning The queue must not be empty.
+   */
+  [[nodiscard]] const std::vector<pl::byte>& front() const;
+
+  /**
+   * Removes the oldest queued frame, after it has been handed to the socket.
+   * @note The bytes of the frame still count towards the watermarks until
+   *       they're acknowledged.
+   */
+  void pop();
+
+  /**
+   * Acknowledges that bytes have been written to the network.
+   * @param byte_count The amount of bytes written.
+   * @return transition::resumed if the queue drained down to the low
+   *         watermark; otherwise transition::none.
+   */
+  transition acknowledge(size_t byte_count);
+
+  /**
+   * Read accessor for the amount of bytes that haven't been written yet.
+   * @return The amount of pending bytes.
+   */
+  [[nodiscard]] size_t pending_byte_count() const noexcept;
+
+  /**
+   * Checks whether the connection using this queue shall not be read from.
+   * @return true if the high watermark was reached and the queue hasn't
+   *         drained down to the low watermark yet; otherwise false.
+   */
+  [[nodiscard]] bool is_paused() const noexcept;
+
+private:
+  watermarks limits_;
+  std::deque<frame> frames_;
+  size_t pending_byte_count_;
+  bool is_paused_;
+};
+} // namespace vc
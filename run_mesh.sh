@@ -0,0 +1,65 @@
+#!/bin/bash
+
+### Runs a gossip mesh of N nodes on loopback ports.
+### Usage: ./run_mesh.sh [node_count] [fanout] [gossip_interval_ms] [base_port]
+
+function catch_errors() {
+    printf "\nrun_mesh.sh failed!\n" >&2
+    exit 1
+}
+
+trap catch_errors ERR;
+
+# Directory containing this bash script
+readonly DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
+
+readonly PREV_DIR=$(pwd)
+
+readonly NODE_COUNT=${1:-4}
+readonly FANOUT=${2:-2}
+readonly GOSSIP_INTERVAL_MS=${3:-100}
+readonly BASE_PORT=${4:-20000}
+
+readonly MESH_DIR=$DIR/build/mesh
+
+mkdir -p $MESH_DIR
+
+cd $MESH_DIR
+
+# Write the configuration file of every node.
+for ((i = 1; i <= NODE_COUNT; i++)); do
+    config=node_$i.yml
+    cp $DIR/config.yml $config
+
+    cat >> $config <<CONFIG
+mesh:
+  actor_id: $i
+  port: $((BASE_PORT + i))
+  fanout: $FANOUT
+  gossip_interval_ms: $GOSSIP_INTERVAL_MS
+  peers:
+CONFIG
+
+    for ((j = 1; j <= NODE_COUNT; j++)); do
+        if [ $i -ne $j ]; then
+            echo "    - port: $((BASE_PORT + j))" >> $config
+        fi
+    done
+done
+
+# Start the nodes and stop them all on Ctrl+C.
+pids=()
+
+for ((i = 1; i <= NODE_COUNT; i++)); do
+    $DIR/build/vector_clocks_daemon $MESH_DIR/node_$i.yml &
+    pids+=($!)
+done
+
+trap 'kill ${pids[@]} 2>/dev/null' INT TERM
+
+wait
+
+cd $PREV_DIR
+
+exit 0
+
@@ -0,0 +1,65 @@
+#include "actor_clock.hpp"
+
+namespace vc {
+actor_clock::actor_clock(actor_id aid, vector_timestamp& vstamp,
+                         std::pmr::memory_resource* resource) noexcept
+  : aid_(aid), vstamp_(vstamp), resource_(resource) {
+}
+
+tl::expected<size_t, error> actor_clock::receive(const packet& pkt) {
+  const auto exp_their_vc = vector_timestamp::deserialize_from_binary(
+    pkt.vstamp_buffer().data(), pkt.vstamp_buffer().size(),
+    pkt.vstamp_byte_order(), resource_);
+
+  if (!exp_their_vc.has_value())
+    return tl::make_unexpected(exp_their_vc.error());
+
+  // Tick own clock (receive event)
+  if (!vstamp_.tick(aid_).has_value())
+    return VC_UNEXPECTED_CODE(errc::missing_own_clock);
+
+  vstamp_.merge(*exp_their_vc);
+  return exp_their_vc->size();
+}
+
+bool actor_clock::send(opcode op, uint16_t flags, byte_order order,
+                       sent_entries entries, const void* payload_data,
+                       size_t payload_byte_count, const packet_sink& sink) {
+  // Tick own clock (send event)
+  const auto own_clock = vstamp_.tick(aid_);
+
+  if (!own_clock.has_value())
+    return false;
+
+  if (order == byte_order::little_endian)
+    flags |= packet::little_endian_vstamp_flag;
+
+  const auto vstamp_binary
+    = entries == sent_entries::all
+        ? vstamp_.serialize_to_binary(order, resource_)
+        : vector_timestamp::from_entries({{aid_, *own_clock}})
+            .serialize_to_binary(order, resource_);
+
+  packet pkt(op, flags, vstamp_binary.data(), vstamp_binary.size(),
+                   payload_data, payload_byte_count, resource_);
+  sink(pkt);
+  return true;
+}
+
+bool actor_clock::answer(const packet& request, byte_order order,
+                         sent_entries entries, const packet_sink& sink) {
+  switch (request.op()) {
+    case opcode::echo:
+      return send(opcode::echo, packet::response_flag, order, entries,
+                  request.payload_buffer().data(),
+                  request.payload_buffer().size(), sink);
+    case opcode::clock_sync: {
+      constexpr char ack[] = "ACK";
+      return send(opcode::clock_sync, packet::response_flag, order, entries,
+                  ack, sizeof(ack), sink);
+    }
+    default:
+      return false;
+  }
+}
+} // namespace vc
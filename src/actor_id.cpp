@@ -8,6 +8,6 @@ namespace vc {
 }
 
 std::ostream& operator<<(std::ostream& os, const actor_id& aid) {
-  return os << aid.to_string().toStdString();
+  return os << "actor" << aid.value();
 }
 } // namespace vc
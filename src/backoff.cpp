@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <cmath>
+
+#include "backoff.hpp"
+
+namespace vc {
+backoff::backoff(backoff_policy policy, uint64_t seed)
+  : policy_(policy), random_engine_(seed), attempt_count_(0) {
+}
+
+std::chrono::milliseconds backoff::next_delay() {
+  const auto max_ms = static_cast<double>(policy_.max_delay.count());
+  const auto ceiling_ms = std::min(
+    max_ms, static_cast<double>(policy_.initial_delay.count())
+              * std::pow(policy_.multiplier, attempt_count_));
+
+  // Stop counting once the ceiling has been reached, the delay can't grow
+  // any further.
+  if (ceiling_ms < max_ms)
+    ++attempt_count_;
+
+  std::uniform_real_distribution<double> distribution(ceiling_ms / 2.0,
+                                                      ceiling_ms);
+
+  return std::chrono::milliseconds(
+    static_cast<int64_t>(std::llround(distribution(random_engine_))));
+}
+
+void backoff::reset() noexcept {
+  attempt_count_ = 0;
+}
+
+[[nodiscard]] uint32_t backoff::attempt_count() const noexcept {
+  return attempt_count_;
+}
+} // namespace vc
@@ -0,0 +1,256 @@
+#include <cstdlib>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "binary_log.hpp"
+#include "varint.hpp"
+
+namespace vc {
+namespace {
+constexpr char magic[] = {'V', 'C', 'L', 'O', 'G', '\x01'};
+
+enum record_type : char { string_record = 1, event_record = 2 };
+
+/**
+ * Reads the varint length prefix of a record from an istream.
+ * @param is The istream to read from.
+ * @return An expected containing the value, or tl::nullopt if the istream
+ *         ended before the first byte; an error if the varint is truncated
+ *         or overlong.
+ */
+tl::expected<tl::optional<uint64_t>, error>
+read_record_length(std::istream& is) {
+  char buffer[max_varint_byte_count];
+  size_t byte_count = 0;
+
+  while (byte_count < sizeof(buffer)) {
+    const auto c = is.get();
+
+    if (c == std::char_traits<char>::eof()) {
+      if (byte_count == 0)
+        return tl::optional<uint64_t>();
+
+      return VC_UNEXPECTED("Truncated record length.");
+    }
+
+    buffer[byte_count++] = static_cast<char>(c);
+
+    if ((static_cast<unsigned>(c) & 0x80U) == 0)
+      break;
+  }
+
+  const char* cursor = buffer;
+  const auto exp_value = read_varint(cursor, buffer + byte_count);
+
+  if (!exp_value.has_value())
+    return tl::make_unexpected(exp_value.error());
+
+  return tl::optional<uint64_t>(*exp_value);
+}
+
+/**
+ * Reads the body of a record from an istream.
+ * @param is The istream to read from.
+ * @param length The length of the body, as read from the record's prefix.
+ * @param body Assigned the body read.
+ * @return true on success; false if the istream ended before `length` bytes.
+ *
+ * Grows `body` only as far as data is actually read, so that a corrupt
+ * length can't cause an allocation larger than the rest of the log.
+ */
+bool read_record_body(std::istream& is, uint64_t length, std::string& body) {
+  constexpr uint64_t chunk_byte_count = 64U * 1024U;
+
+  body.clear();
+
+  while (body.size() < length) {
+    const auto offset = body.size();
+    const auto count = std::min(length - offset, chunk_byte_count);
+    body.resize(offset + count);
+    is.read(&body[offset], static_cast<std::streamsize>(count));
+
+    if (static_cast<uint64_t>(is.gcount()) != count)
+      return false;
+  }
+
+  return true;
+}
+} // namespace
+
+binary_log_sink::binary_log_sink(std::ostream& os)
+  : os_(&os), string_ids_(), body_() {
+  os_->write(magic, sizeof(magic));
+}
+
+void binary_log_sink::write(const log_record& record) {
+  const auto function_id = intern(record.function);
+  const auto file_id = intern(record.file);
+
+  body_.clear();
+  body_.push_back(event_record);
+  append_varint(body_, static_cast<uint64_t>(record.level));
+  append_varint(body_, record.aid.value());
+  append_varint(body_, function_id);
+  append_varint(body_, file_id);
+  append_varint(body_, record.line);
+
+  // Sorted actor_ids have small deltas, which make for short varints.
+  std::vector<std::pair<uint64_t, uint64_t>> pairs;
+  pairs.reserve(record.vstamp.size());
+
+  for (const auto& [aid, clock] : record.vstamp.entries())
+    pairs.emplace_back(aid.value(), clock);
+
+  std::sort(pairs.begin(), pairs.end());
+
+  append_varint(body_, pairs.size());
+  uint64_t previous_aid = 0;
+
+  for (const auto& [aid, clock] : pairs) {
+    append_varint(body_, aid - previous_aid);
+    append_varint(body_, clock);
+    previous_aid = aid;
+  }
+
+  body_.append(record.message);
+  write_body();
+}
+
+void binary_log_sink::flush() {
+  os_->flush();
+}
+
+uint64_t binary_log_sink::intern(const char* str) {
+  const std::string_view key(str);
+  const auto it = string_ids_.find(key);
+
+  if (it != string_ids_.end())
+    return it->second;
+
+  const auto id = static_cast<uint64_t>(string_ids_.size());
+  string_ids_.emplace(key, id);
+
+  body_.clear();
+  body_.push_back(string_record);
+  append_varint(body_, id);
+  body_.append(key.data(), key.size());
+  write_body();
+
+  return id;
+}
+
+void binary_log_sink::write_body() {
+  std::string length;
+  append_varint(length, body_.size());
+  os_->write(length.data(), static_cast<std::streamsize>(length.size()));
+  os_->write(body_.data(), static_cast<std::streamsize>(body_.size()));
+}
+
+binary_log_reader::binary_log_reader(std::istream& is)
+  : is_(&is), has_read_header_(false), strings_(), body_() {
+}
+
+tl::expected<tl::optional<log_record>, error> binary_log_reader::next() {
+  if (!has_read_header_) {
+    const auto exp_header = read_header();
+
+    if (!exp_header.has_value())
+      return tl::make_unexpected(exp_header.error());
+  }
+
+  for (;;) {
+    const auto exp_length = read_record_length(*is_);
+
+    if (!exp_length.has_value())
+      return tl::make_unexpected(exp_length.error());
+
+    if (!exp_length->has_value())
+      return tl::optional<log_record>();
+
+    if (!read_record_body(*is_, **exp_length, body_))
+      return VC_UNEXPECTED("Truncated record.");
+
+    if (body_.empty())
+      return VC_UNEXPECTED("Empty record.");
+
+    const char* cursor = body_.data() + 1;
+    const char* const end = body_.data() + body_.size();
+
+    if (body_[0] == string_record) {
+      const auto exp_id = read_varint(cursor, end);
+
+      if (!exp_id.has_value())
+        return tl::make_unexpected(exp_id.error());
+
+      strings_[*exp_id] = std::string(cursor, end);
+      continue;
+    }
+
+    if (body_[0] != event_record)
+      return VC_UNEXPECTED("Unknown record type.");
+
+    // level, actor_id, function id, file id, line, pair count
+    uint64_t fields[6];
+
+    for (auto& field : fields) {
+      const auto exp_field = read_varint(cursor, end);
+
+      if (!exp_field.has_value())
+        return tl::make_unexpected(exp_field.error());
+
+      field = *exp_field;
+    }
+
+    const auto [level, aid, function_id, file_id, line, pair_count] = fields;
+
+    if (level > static_cast<uint64_t>(log_level::critical))
+      return VC_UNEXPECTED("Invalid log level.");
+
+    const auto function_it = strings_.find(function_id);
+    const auto file_it = strings_.find(file_id);
+
+    if (function_it == strings_.end() || file_it == strings_.end())
+      return VC_UNEXPECTED("Reference to an undefined string.");
+
+    std::unordered_map<actor_id, uint64_t> entries;
+    uint64_t entry_aid = 0;
+
+    for (uint64_t i = 0; i < pair_count; ++i) {
+      const auto exp_delta = read_varint(cursor, end);
+
+      if (!exp_delta.has_value())
+        return tl::make_unexpected(exp_delta.error());
+
+      const auto exp_clock = read_varint(cursor, end);
+
+      if (!exp_clock.has_value())
+        return tl::make_unexpected(exp_clock.error());
+
+      entry_aid += *exp_delta;
+      entries.emplace(actor_id(entry_aid), *exp_clock);
+    }
+
+    return tl::optional<log_record>(log_record{
+      vector_timestamp::from_entries(std::move(entries)),
+      static_cast<log_level>(level), actor_id(aid),
+      function_it->second.c_str(), file_it->second.c_str(),
+      static_cast<unsigned>(line), std::string(cursor, end)});
+  }
+}
+
+tl::expected<void, error> binary_log_reader::read_header() {
+  char header[sizeof(magic)];
+  is_->read(header, sizeof(header));
+
+  if (static_cast<size_t>(is_->gcount()) != sizeof(header)
+      || !std::equal(header, header + sizeof(header), magic))
+    return VC_UNEXPECTED("Not a binary vector clock log.");
+
+  has_read_header_ = true;
+  return {};
+}
+} // namespace vc
@@ -0,0 +1,162 @@
+#include <cassert>
+#include <cstring>
+
+#include <pl/bswap.hpp>
+#include <pl/byte.hpp>
+
+#include "bswap_range.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define VC_BSWAP_X86 1
+#  include <immintrin.h>
+#else
+#  define VC_BSWAP_X86 0
+#endif
+
+namespace vc {
+namespace {
+template <class T>
+void bswap_scalar(pl::byte* dest, const pl::byte* src, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    T element;
+    memcpy(&element, src + i * sizeof(T), sizeof(T));
+    element = pl::bswap(element);
+    memcpy(dest + i * sizeof(T), &element, sizeof(T));
+  }
+}
+
+void bswap_scalar(pl::byte* dest, const pl::byte* src, size_t count,
+                  size_t element_byte_count) noexcept {
+  switch (element_byte_count) {
+    case sizeof(uint16_t):
+      bswap_scalar<uint16_t>(dest, src, count);
+      break;
+    case sizeof(uint32_t):
+      bswap_scalar<uint32_t>(dest, src, count);
+      break;
+    case sizeof(uint64_t):
+      bswap_scalar<uint64_t>(dest, src, count);
+      break;
+    default:
+      assert(false && "The element size must be 2, 4 or 8.");
+  }
+}
+
+#if VC_BSWAP_X86
+/**
+ * Creates the pshufb control mask that reverses every element of a 16 byte
+ * lane.
+ * @param element_byte_count The size of an element, 2, 4 or 8.
+ * @return The mask.
+ */
+__attribute__((target("ssse3"))) __m128i
+shuffle_mask(size_t element_byte_count) noexcept {
+  alignas(16) char mask[16];
+
+  for (size_t i = 0; i < sizeof(mask); ++i) {
+    const auto element_start = i - i % element_byte_count;
+    mask[i] = static_cast<char>(element_start + element_byte_count - 1U
+                                - i % element_byte_count);
+  }
+
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+__attribute__((target("ssse3"))) void
+bswap_ssse3(pl::byte* dest, const pl::byte* src, size_t count,
+            size_t element_byte_count) noexcept {
+  const auto mask = shuffle_mask(element_byte_count);
+  const auto byte_count = count * element_byte_count;
+  size_t i = 0;
+
+  for (; i + 16U <= byte_count; i += 16U) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_shuffle_epi8(v, mask));
+  }
+
+  bswap_scalar(dest + i, src + i, (byte_count - i) / element_byte_count,
+               element_byte_count);
+}
+
+__attribute__((target("avx2"))) void
+bswap_avx2(pl::byte* dest, const pl::byte* src, size_t count,
+           size_t element_byte_count) noexcept {
+  // vpshufb shuffles within each 16 byte lane, so both lanes use the same
+  // mask.
+  const auto mask = _mm256_broadcastsi128_si256(
+    shuffle_mask(element_byte_count));
+  const auto byte_count = count * element_byte_count;
+  size_t i = 0;
+
+  for (; i + 64U <= byte_count; i += 64U) {
+    const auto v0 = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(src + i));
+    const auto v1 = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(src + i + 32U));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i),
+                        _mm256_shuffle_epi8(v0, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 32U),
+                        _mm256_shuffle_epi8(v1, mask));
+  }
+
+  for (; i + 32U <= byte_count; i += 32U) {
+    const auto v = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i),
+                        _mm256_shuffle_epi8(v, mask));
+  }
+
+  bswap_scalar(dest + i, src + i, (byte_count - i) / element_byte_count,
+               element_byte_count);
+}
+#endif
+
+bswap_isa detect_bswap_isa() noexcept {
+#if VC_BSWAP_X86
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return bswap_isa::avx2;
+
+  if (__builtin_cpu_supports("ssse3"))
+    return bswap_isa::ssse3;
+#endif
+
+  return bswap_isa::scalar;
+}
+} // namespace
+
+bswap_isa active_bswap_isa() noexcept {
+  static const auto isa = detect_bswap_isa();
+  return isa;
+}
+
+void bswap_copy(void* dest, const void* src, size_t count,
+                size_t element_byte_count) noexcept {
+  bswap_copy(active_bswap_isa(), dest, src, count, element_byte_count);
+}
+
+void bswap_copy(bswap_isa isa, void* dest, const void* src, size_t count,
+                size_t element_byte_count) noexcept {
+  auto* const d = static_cast<pl::byte*>(dest);
+  const auto* const s = static_cast<const pl::byte*>(src);
+
+  switch (isa) {
+#if VC_BSWAP_X86
+    case bswap_isa::avx2:
+      bswap_avx2(d, s, count, element_byte_count);
+      return;
+    case bswap_isa::ssse3:
+      bswap_ssse3(d, s, count, element_byte_count);
+      return;
+#else
+    case bswap_isa::avx2:
+    case bswap_isa::ssse3:
+#endif
+    case bswap_isa::scalar:
+      bswap_scalar(d, s, count, element_byte_count);
+      return;
+  }
+}
+} // namespace vc
@@ -0,0 +1,142 @@
+#include <utility>
+
+#include "causal_merge.hpp"
+
+namespace vc {
+namespace {
+/**
+ * Looks up the own clock of the actor that created a log entry.
+ * @param record The log entry.
+ * @return The clock of `record.aid` in the entry's vector timestamp; 0 if
+ *         the actor hadn't ticked yet.
+ */
+uint64_t own_clock(const log_record& record) {
+  const auto& entries = record.vstamp.entries();
+  const auto it = entries.find(record.aid);
+  return it == entries.end() ? 0 : it->second;
+}
+} // namespace
+
+causal_merge::causal_merge()
+  : sources_(), round_(0), released_round_(0), size_(0) {
+}
+
+void causal_merge::push(uint64_t source, log_record record) {
+  auto& pending = sources_[source];
+  const auto clock = own_clock(record);
+
+  if (clock != 0)
+    pending.own_clocks[record.aid].push_back(clock);
+
+  pending.entries.push_back(entry{round_, std::move(record)});
+  ++size_;
+}
+
+void causal_merge::complete_round() noexcept {
+  released_round_ = round_;
+  ++round_;
+}
+
+void causal_merge::release_all() noexcept {
+  ++round_;
+  released_round_ = round_;
+}
+
+size_t causal_merge::pop(const std::function<void(log_record&&)>& consumer) {
+  size_t popped = 0;
+  auto has_progressed = true;
+
+  while (has_progressed) {
+    has_progressed = false;
+    auto is_all_released = true;
+
+    for (auto it = sources_.begin(); it != sources_.end();) {
+      auto& [source, pending] = *it;
+      auto& entries = pending.entries;
+
+      while (!entries.empty() && entries.front().round < released_round_
+             && !has_pending_predecessor(source, entries.front().record)) {
+        pop_front(pending, consumer);
+        ++popped;
+        has_progressed = true;
+      }
+
+      if (!entries.empty() && entries.front().round >= released_round_)
+        is_all_released = false;
+
+      if (entries.empty())
+        it = sources_.erase(it);
+      else
+        ++it;
+    }
+
+    // Consistent vector timestamps can't wait for each other in a cycle, as
+    // every released entry waits for an older one. Inconsistent ones are
+    // written in the order they were collected rather than never.
+    if (!has_progressed && is_all_released && !sources_.empty()) {
+      auto oldest = sources_.begin();
+
+      for (auto it = sources_.begin(); it != sources_.end(); ++it)
+        if (it->second.entries.front().round
+            < oldest->second.entries.front().round)
+          oldest = it;
+
+      pop_front(oldest->second, consumer);
+      ++popped;
+      has_progressed = true;
+
+      if (oldest->second.entries.empty())
+        sources_.erase(oldest);
+    }
+  }
+
+  return popped;
+}
+
+size_t causal_merge::size() const noexcept {
+  return size_;
+}
+
+bool causal_merge::has_pending_predecessor(uint64_t source,
+                                           const log_record& record) const {
+  const auto& clocks = record.vstamp.entries();
+
+  for (const auto& [other_source, pending] : sources_) {
+    if (other_source == source)
+      continue;
+
+    for (const auto& [aid, own_clocks] : pending.own_clocks) {
+      const auto it = clocks.find(aid);
+
+      if (it == clocks.end())
+        continue;
+
+      // An entry of the same actor with the same clock is the same event,
+      // logged twice; neither has to wait for the other.
+      const auto least = own_clocks.front();
+
+      if (least < it->second || (least == it->second && aid != record.aid))
+        return true;
+    }
+  }
+
+  return false;
+}
+
+void causal_merge::pop_front(
+  source_entries& pending, const std::function<void(log_record&&)>& consumer) {
+  auto& record = pending.entries.front().record;
+
+  if (own_clock(record) != 0) {
+    const auto it = pending.own_clocks.find(record.aid);
+    it->second.pop_front();
+
+    if (it->second.empty())
+      pending.own_clocks.erase(it);
+  }
+
+  consumer(std::move(record));
+  pending.entries.pop_front();
+  --size_;
+}
+} // namespace vc
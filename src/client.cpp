@@ -1,143 +1,521 @@
+#include <cinttypes>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <memory_resource>
+#include <string>
+#include <utility>
 
 #include <QHostAddress>
 #include <QTimer>
 
 #include "client.hpp"
-#include "ntoh.hpp"
+#include "metrics.hpp"
 #include "packet.hpp"
+#include "packet_io.hpp"
 #include "server_port.hpp"
+#include "trace_context.hpp"
+#include "trace_sampler.hpp"
 
 namespace vc {
+namespace {
+/**
+ * The size of the largest response accepted from a server, enough for the
+ * vector timestamp of millions of actors.
+ */
+constexpr uint64_t max_response_byte_count = 64U * 1024U * 1024U;
+
+/**
+ * The metrics updated by all of the clients.
+ */
+struct client_metrics {
+  metrics_registry& registry = metrics_registry::global();
+  counter& requests = registry.add_counter("vc_client_requests_total",
+                                           "Requests sent to servers.");
+  counter& responses = registry.add_counter(
+    "vc_client_responses_total", "Responses and publications received.");
+  counter& sent_bytes = registry.add_counter(
+    "vc_client_sent_bytes_total", "Bytes of the requests sent.");
+  counter& received_bytes = registry.add_counter(
+    "vc_client_received_bytes_total", "Bytes of the responses read.");
+  counter& decode_failures = registry.add_counter(
+    "vc_client_decode_failures_total",
+    "Responses whose packet or vector timestamp couldn't be decoded.");
+  histogram& clock_entries = registry.add_histogram(
+    "vc_client_clock_entries",
+    "Entries of the clients' vector timestamps after merging a response.",
+    exponential_buckets(1, 2, 12));
+};
+
+client_metrics& metrics() {
+  static client_metrics instance;
+  return instance;
+}
+} // namespace
+
 client::client(actor_id aid, logger& l, QObject* parent)
   : QObject(parent),
     aid_(aid),
     logger_(l),
-    is_connected_(false),
-    socket_(),
-    vstamp_(aid_) {
+    address_(),
+    port_(0),
+    mode_(client_mode::poll),
+    backoff_policy_(),
+    is_closing_(false),
+    negotiate_byte_order_(true),
+    connections_(),
+    next_connection_(0),
+    subscription_(nullptr),
+    vstamp_(aid_),
+    rtt_histogram_(),
+    rtt_report_timer_(PL_NO_PARENT),
+    clock_(aid_, vstamp_, std::pmr::get_default_resource()) {
+  QObject::connect(&rtt_report_timer_, &QTimer::timeout, this,
+                   &client::print_rtt_report);
+  set_rtt_report_interval(default_rtt_report_interval);
 }
 
 client::~client() {
-  if (is_connected_)
-    socket_.disconnectFromHost();
+  // Don't reconnect the connections that are being closed.
+  is_closing_ = true;
+
+  for (auto& conn : connections_) {
+    conn->reconnect_timer.stop();
+    conn->socket.disconnectFromHost();
+
+    // A socket reports its last state change while being destroyed, which
+    // must not reach this client once its members are being torn down.
+    QObject::disconnect(&conn->socket, nullptr, this, nullptr);
+    QObject::disconnect(&conn->reconnect_timer, nullptr, this, nullptr);
+
+    for (auto& pending : conn->pending)
+      if (pending.completion.has_value())
+        pending.completion->set_result(
+          VC_UNEXPECTED("The client was destroyed."));
+
+    conn->pending.clear();
+  }
+}
+
+void client::connect(client_mode mode) {
+  connect(QHostAddress("127.0.0.1"), server_port, mode);
 }
 
-void client::connect() {
-  socket_.connectToHost(QHostAddress("127.0.0.1"), server_port);
-  is_connected_ = true;
+void client::connect(const QHostAddress& address, quint16 port,
+                     client_mode mode,
+                     std::chrono::milliseconds request_interval,
+                     size_t pool_size) {
+  address_ = address;
+  port_ = port;
+  mode_ = mode;
+
+  for (size_t i = 0; i < std::max<size_t>(pool_size, 1); ++i) {
+    auto conn = std::make_unique<connection>();
+    auto* raw = conn.get();
+    raw->index = connections_.size();
+    raw->state = connection_state::disconnected;
+    raw->reconnect_backoff = backoff(backoff_policy_);
+    raw->reconnect_timer.setSingleShot(true);
+    raw->order = byte_order::big_endian;
+
+    QObject::connect(&raw->socket, &QIODevice::readyRead, this,
+                     [this, raw] { on_ready_read(*raw); });
+    QObject::connect(&raw->socket, &QAbstractSocket::stateChanged, this,
+                     [this, raw](QAbstractSocket::SocketState socket_state) {
+                       on_socket_state_changed(*raw, socket_state);
+                     });
+    QObject::connect(&raw->reconnect_timer, &QTimer::timeout, this,
+                     [this, raw] {
+                       set_state(*raw, connection_state::connecting);
+                       raw->socket.connectToHost(address_, port_);
+                     });
+
+    connections_.push_back(std::move(conn));
+
+    set_state(*raw, connection_state::connecting);
+    raw->socket.connectToHost(address_, port_);
+  }
 
-  QObject::connect(&socket_, &QIODevice::readyRead, this,
-                   &client::on_ready_read);
+  // Subscribing happens whenever a connection gets established.
+  if (mode == client_mode::subscribe)
+    return;
 
-  // Request a new time stamp from the server every second.
+  // Request a new time stamp from the server once per request interval.
   auto* timer = new QTimer(this);
   QObject::connect(timer, &QTimer::timeout, this,
                    &client::request_time_from_server);
-  constexpr auto timer_timeout_ms = 1000;
-  timer->start(timer_timeout_ms);
+  timer->start(static_cast<int>(request_interval.count()));
 }
 
-void client::request_time_from_server() {
-  auto span = opentracing::Tracer::Global()->StartSpan(
-    "client: request_time_from_server");
+[[nodiscard]] future<response> client::request(const std::string& payload) {
+  auto* conn = is_closing_ ? nullptr : next_connection();
+
+  if (conn == nullptr)
+    return future<response>::make_ready(
+      VC_UNEXPECTED("No connection to the server is established."));
+
+  auto span = start_sampled_span("client: request");
+  const auto sent_at = std::chrono::steady_clock::now();
+
+  if (!send_request(*conn, opcode::echo, payload.data(), payload.size(),
+                    span.get()))
+    return future<response>::make_ready(
+      VC_UNEXPECTED("Couldn't send the request to the server."));
+
+  promise<response> completion;
+  auto result = completion.get_future();
+  conn->pending.push_back(
+    pending_request{opcode::echo, sent_at, std::move(completion)});
+  return result;
+}
+
+void client::set_backoff_policy(backoff_policy policy) {
+  backoff_policy_ = policy;
+}
+
+void client::set_negotiate_byte_order(bool negotiate) {
+  negotiate_byte_order_ = negotiate;
+}
+
+[[nodiscard]] std::vector<connection_state>
+client::connection_states() const {
+  std::vector<connection_state> states;
+  states.reserve(connections_.size());
+
+  for (const auto& conn : connections_)
+    states.push_back(conn->state);
+
+  return states;
+}
+
+[[nodiscard]] size_t client::connected_count() const noexcept {
+  return static_cast<size_t>(
+    std::count_if(connections_.begin(), connections_.end(),
+                  [](const std::unique_ptr<connection>& conn) {
+                    return conn->state == connection_state::connected;
+                  }));
+}
+
+void client::on_socket_state_changed(
+  connection& conn, QAbstractSocket::SocketState socket_state) {
+  if (socket_state == QAbstractSocket::ConnectedState) {
+    conn.reconnect_backoff.reset();
+    conn.order = byte_order::big_endian;
+    set_state(conn, connection_state::connected);
+
+    // Requests sent before the hello response arrives remain big-endian, the
+    // server switches only after responding to the hello.
+    if (negotiate_byte_order_)
+      say_hello(conn);
+
+    // Subscribe over the first connection that is established, and again
+    // over another one whenever the subscribed connection is lost.
+    if (mode_ == client_mode::subscribe && subscription_ == nullptr)
+      subscribe_to_server(conn);
 
-  // Tick own vstamp for send event.
-  if (!vstamp_.tick(aid_).has_value()) {
-    fprintf(stderr, "Client couldn't tick its vector timestamp!\n");
     return;
   }
 
-  const auto vstamp_binary = vstamp_.serialize_to_binary();
-  constexpr char payload[] = "GIEVTIMEPLX";
+  if (socket_state != QAbstractSocket::UnconnectedState)
+    return;
+
+  // Responses to the requests sent over the lost connection will never
+  // arrive. Fail them once the connection's state is consistent, as a
+  // continuation may send the next request right away.
+  auto lost = std::move(conn.pending);
+  conn.pending.clear();
+
+  const auto fail_lost = [&lost] {
+    for (auto& pending : lost)
+      if (pending.completion.has_value())
+        pending.completion->set_result(
+          VC_UNEXPECTED("The connection to the server was lost."));
+  };
+
+  if (subscription_ == &conn)
+    subscription_ = nullptr;
+
+  if (is_closing_) {
+    set_state(conn, connection_state::disconnected);
+    fail_lost();
+    return;
+  }
 
-  const packet pkt(vstamp_binary.data(), vstamp_binary.size(), payload,
-                   sizeof(payload));
+  if (mode_ == client_mode::subscribe && subscription_ == nullptr) {
+    for (auto& other : connections_) {
+      if (other.get() != &conn
+          && other->state == connection_state::connected) {
+        subscribe_to_server(*other);
+        break;
+      }
+    }
+  }
 
-  VC_LOG_INFO(logger_, vstamp_, aid_, "SEND Client sent \"{}\" to server.",
-              payload);
+  const auto delay = conn.reconnect_backoff.next_delay();
+  set_state(conn, connection_state::backing_off);
+  conn.reconnect_timer.start(static_cast<int>(delay.count()));
 
-  const auto pkt_bin = pkt.serialize_to_binary();
+  fail_lost();
+}
 
-  if (socket_.write(reinterpret_cast<const char*>(pkt_bin.data()),
-                    pkt_bin.size())
-      == -1) {
-    fprintf(stderr, "Client couldn't send packet!\n");
+void client::set_state(connection& conn, connection_state state) {
+  if (conn.state == state)
     return;
+
+  conn.state = state;
+  emit connection_state_changed(conn.index, state);
+}
+
+client::connection* client::next_connection() {
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    auto& conn = *connections_[next_connection_];
+    next_connection_ = (next_connection_ + 1) % connections_.size();
+
+    if (conn.state == connection_state::connected)
+      return &conn;
   }
 
-  span->SetTag("payload", &payload[0]);
+  return nullptr;
+}
+
+[[nodiscard]] const latency_histogram&
+client::rtt_histogram() const noexcept {
+  return rtt_histogram_;
 }
 
-void client::on_ready_read() {
-  auto span = opentracing::Tracer::Global()->StartSpan("client: on_ready_read");
+void client::set_rtt_report_interval(std::chrono::milliseconds interval) {
+  if (interval.count() == 0) {
+    rtt_report_timer_.stop();
+    return;
+  }
 
-  auto* the_sender = sender();
+  rtt_report_timer_.start(static_cast<int>(interval.count()));
+}
 
-  if (the_sender == nullptr)
+void client::print_rtt_report() const {
+  if (rtt_histogram_.count() == 0)
     return;
 
-  auto* sock = qobject_cast<QTcpSocket*>(the_sender);
+  printf("%s: rtt_count=%" PRIu64 " rtt_p50_us=%" PRIu64 " rtt_p90_us=%" PRIu64
+         " rtt_p99_us=%" PRIu64 " rtt_p999_us=%" PRIu64 " rtt_max_us=%" PRIu64
+         "\n",
+         aid_.to_string().toStdString().c_str(), rtt_histogram_.count(),
+         rtt_histogram_.value_at_percentile(50.0),
+         rtt_histogram_.value_at_percentile(90.0),
+         rtt_histogram_.value_at_percentile(99.0),
+         rtt_histogram_.value_at_percentile(99.9), rtt_histogram_.max());
+  fflush(stdout);
+}
+
+void client::request_time_from_server() {
+  auto span = start_sampled_span("client: request_time_from_server");
 
-  if (sock == nullptr)
+  auto* conn = next_connection();
+
+  // Skip rather than queue the request, the next one is due soon anyway.
+  if (conn == nullptr)
     return;
 
-  uint64_t vstamp_len, payload_len;
-  if (sock->read(reinterpret_cast<char*>(&vstamp_len), sizeof(vstamp_len))
-      == -1) {
-    fprintf(stderr, "Client couldn't read vstamp_len!\n");
+  constexpr char payload[] = "GIEVTIMEPLX";
+  const auto sent_at = std::chrono::steady_clock::now();
+
+  if (!send_request(*conn, opcode::time, payload, sizeof(payload),
+                    span.get()))
     return;
-  }
-  vstamp_len = ntoh(vstamp_len);
 
-  std::vector<char> vstamp_buf(vstamp_len);
-  if (sock->read(vstamp_buf.data(), vstamp_len) == -1) {
-    fprintf(stderr, "Client couldn't read vstamp_buf!\n");
+  conn->pending.push_back(pending_request{opcode::time, sent_at, tl::nullopt});
+
+  if (span != nullptr)
+    span->SetTag("payload", &payload[0]);
+}
+
+void client::subscribe_to_server(connection& conn) {
+  auto span = start_sampled_span("client: subscribe_to_server");
+
+  constexpr char payload[] = "GIEVTIMEPLX";
+
+  if (!send_request(conn, opcode::subscribe, payload, sizeof(payload),
+                    span.get()))
+    return;
+
+  subscription_ = &conn;
+
+  if (span != nullptr)
+    span->SetTag("payload", &payload[0]);
+}
+
+void client::say_hello(connection& conn) {
+  const auto offer = static_cast<char>(offered_byte_orders);
+  const auto sent_at = std::chrono::steady_clock::now();
+
+  if (!send_request(conn, opcode::hello, &offer, sizeof(offer), nullptr))
     return;
+
+  conn.pending.push_back(pending_request{opcode::hello, sent_at, tl::nullopt});
+}
+
+bool client::send_request(connection& conn, opcode op,
+                          const char* payload_data,
+                          size_t payload_byte_count,
+                          const opentracing::Span* span) {
+  bool is_written = false;
+
+  const auto sink = [&](packet& pkt) {
+    if (span != nullptr)
+      inject_trace_context(pkt, *span);
+
+    // Log the payload up to its null-terminator, if any.
+    const std::string payload(
+      payload_data,
+      std::find(payload_data, payload_data + payload_byte_count, '\0'));
+
+    VC_LOG_INFO(logger_, vstamp_, aid_,
+                "SEND Client sent {} request \"{}\" to server.", op, payload);
+
+    const auto pkt_bin = pkt.serialize_to_binary();
+
+    if (conn.socket.write(reinterpret_cast<const char*>(pkt_bin.data()),
+                          pkt_bin.size())
+        == -1) {
+      fprintf(stderr, "Client couldn't send packet!\n");
+      return;
+    }
+
+    auto& m = metrics();
+    m.requests.add();
+    m.sent_bytes.add(pkt_bin.size());
+    is_written = true;
+  };
+
+  if (!clock_.send(op, 0, conn.order, sent_entries::all, payload_data,
+                   payload_byte_count, sink)) {
+    fprintf(stderr, "Client couldn't tick its vector timestamp!\n");
+    return false;
   }
 
-  if (sock->read(reinterpret_cast<char*>(&payload_len), sizeof(payload_len))
-      == -1) {
-    fprintf(stderr, "Client couldn't read payload_len!\n");
+  return is_written;
+}
+
+void client::on_ready_read(connection& conn) {
+  // Several responses may have arrived at once, e.g. when subscribed.
+  for (;;) {
+    const auto exp_complete = has_complete_packet(conn.socket,
+                                                  max_response_byte_count);
+
+    if (!exp_complete.has_value()) {
+      metrics().decode_failures.add();
+      fprintf(stderr, "Client received an invalid packet!\n");
+      conn.socket.abort();
+      return;
+    }
+
+    if (!*exp_complete)
+      return;
+
+    handle_response(conn);
+  }
+}
+
+void client::handle_response(connection& conn) {
+  auto span = start_sampled_span("client: on_ready_read");
+
+  auto& m = metrics();
+  const auto available_byte_count = conn.socket.bytesAvailable();
+  const auto exp_rcvd_pkt = read_packet(conn.socket);
+
+  m.received_bytes.add(static_cast<uint64_t>(
+    available_byte_count - conn.socket.bytesAvailable()));
+
+  if (!exp_rcvd_pkt.has_value()) {
+    m.decode_failures.add();
+    fprintf(stderr, "Client couldn't read packet!\n");
     return;
   }
-  payload_len = ntoh(payload_len);
 
-  std::vector<char> payload_buf(payload_len);
-  if (sock->read(payload_buf.data(), payload_len) == -1) {
-    fprintf(stderr, "Client couldn't read payload_buf!\n");
+  m.responses.add();
+
+  const auto& rcvd_pkt = *exp_rcvd_pkt;
+
+  if ((rcvd_pkt.op() != opcode::time && rcvd_pkt.op() != opcode::echo
+       && rcvd_pkt.op() != opcode::subscribe
+       && rcvd_pkt.op() != opcode::hello)
+      || !rcvd_pkt.is_response()) {
+    fprintf(stderr, "Client received unexpected packet from server!\n");
     return;
   }
 
-  const packet rcvd_pkt(vstamp_buf.data(), vstamp_len, payload_buf.data(),
-                        payload_len);
+  // The server responds in order, so a time or echo response answers the
+  // oldest pending request. Publications aren't answers to any request.
+  tl::optional<pending_request> answered;
 
-  const auto exp_their_vc = vector_timestamp::deserialize_from_binary(
-    rcvd_pkt.vstamp_buffer().data(), rcvd_pkt.vstamp_buffer().size());
+  // A server that doesn't know the hello request drops it, so any other
+  // response arriving first means the connection stays big-endian.
+  if (rcvd_pkt.op() != opcode::hello && !conn.pending.empty()
+      && conn.pending.front().op == opcode::hello)
+    conn.pending.pop_front();
 
-  if (!exp_their_vc.has_value()) {
-    fprintf(stderr, "Client failed to deserialize incoming vector clock!\n");
+  if (!conn.pending.empty() && conn.pending.front().op == rcvd_pkt.op()) {
+    answered = std::move(conn.pending.front());
+    conn.pending.pop_front();
+  }
+
+  // The hello isn't one of the requests whose round trip time is of
+  // interest.
+  if (answered.has_value() && answered->op != opcode::hello) {
+    const auto rtt = std::chrono::steady_clock::now() - answered->sent_at;
+    rtt_histogram_.record(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(rtt).count()));
+  }
+
+  const auto fail = [&answered](const char* message) {
+    fprintf(stderr, "%s\n", message);
+
+    if (answered.has_value() && answered->completion.has_value())
+      answered->completion->set_result(VC_UNEXPECTED(message));
+  };
+
+  // Tick own clock for receive event and merge the incoming vector clock.
+  const auto exp_merged_entries = clock_.receive(rcvd_pkt);
+
+  if (!exp_merged_entries.has_value()) {
+    if (exp_merged_entries.error().code() == errc::missing_own_clock) {
+      fail("Client failed to tick own vector clock!");
+      return;
+    }
+
+    m.decode_failures.add();
+    fail("Client failed to deserialize incoming vector clock!");
     return;
   }
 
-  const auto their_vc = *exp_their_vc;
+  m.clock_entries.observe(vstamp_.size());
 
   const std::string buf(rcvd_pkt.payload_buffer().begin(),
                         rcvd_pkt.payload_buffer().end());
 
-  // Tick own clock for receive event.
-  if (!vstamp_.tick(aid_)) {
-    fprintf(stderr, "Client failed to tick own vector clock!\n");
-    return;
+  if (rcvd_pkt.op() == opcode::hello) {
+    const auto& chosen = rcvd_pkt.payload_buffer();
+    const auto order = chosen.size() == 1
+                         ? static_cast<byte_order>(chosen.front())
+                         : byte_order::big_endian;
+
+    // Only switch to a byte order that was offered.
+    if (order == byte_order::big_endian || order == host_byte_order)
+      conn.order = order;
+    else
+      fprintf(stderr, "Server chose a byte order that wasn't offered!\n");
   }
 
-  // Merge incoming vector clock into own vector clock.
-  vstamp_.merge(their_vc);
-
   VC_LOG_INFO(logger_, vstamp_, aid_,
-              "RECV Client received time from server: \"{}\".", buf.data());
+              "RECV Client received {} response from server: \"{}\".",
+              rcvd_pkt.op(), buf.data());
+
+  if (span != nullptr)
+    span->SetTag("Response", buf);
 
-  span->SetTag("Response", buf);
+  if (answered.has_value() && answered->completion.has_value())
+    answered->completion->set_result(response{vstamp_, buf});
 }
 } // namespace vc
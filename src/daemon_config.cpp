@@ -0,0 +1,158 @@
+#include <string>
+#include <utility>
+
+#include <yaml-cpp/yaml.h>
+
+#include "daemon_config.hpp"
+#include "read_optional.hpp"
+
+namespace vc {
+namespace {
+tl::expected<client_mode, error> parse_client_mode(const std::string& mode) {
+  if (mode == "poll")
+    return client_mode::poll;
+
+  if (mode == "subscribe")
+    return client_mode::subscribe;
+
+  return VC_UNEXPECTED("Unknown client mode \"" + mode
+                       + "\", expected poll or subscribe.");
+}
+
+tl::expected<log_level, error> parse_log_level(const std::string& level) {
+  if (level == "trace")
+    return log_level::trace;
+
+  if (level == "debug")
+    return log_level::debug;
+
+  if (level == "info")
+    return log_level::info;
+
+  if (level == "warning")
+    return log_level::warning;
+
+  if (level == "error")
+    return log_level::error;
+
+  if (level == "critical")
+    return log_level::critical;
+
+  return VC_UNEXPECTED("Unknown log level \"" + level
+                       + "\", expected trace, debug, info, warning, error or "
+                         "critical.");
+}
+} // namespace
+
+tl::expected<daemon_config, error>
+parse_daemon_config(pl::string_view config_filepath) {
+  auto exp_mesh_config = parse_mesh_config(config_filepath);
+
+  if (!exp_mesh_config.has_value())
+    return tl::make_unexpected(exp_mesh_config.error());
+
+  try {
+    const auto config_yaml = YAML::LoadFile(config_filepath.to_string());
+    const auto daemon_yaml = config_yaml["daemon"];
+
+    daemon_config config;
+    config.mesh = std::move(*exp_mesh_config);
+
+    if (daemon_yaml) {
+      read_optional(daemon_yaml, "log_file", config.log_file);
+      read_optional(daemon_yaml, "log_async", config.log_options.asynchronous);
+      read_optional(daemon_yaml, "log_queue_capacity",
+                    config.log_options.queue_capacity);
+
+      if (config.log_options.queue_capacity < 2)
+        return VC_UNEXPECTED("The log queue capacity must be at least 2.");
+
+      read_optional(daemon_yaml, "log_flush_interval_ms",
+                    config.log_options.flush_interval);
+      read_optional(daemon_yaml, "log_echo",
+                    config.log_options.echo_to_stdout);
+      read_optional(daemon_yaml, "log_per_thread",
+                    config.log_options.per_thread_buffers);
+      read_optional(daemon_yaml, "log_binary", config.log_binary);
+      read_optional(daemon_yaml, "log_segment_bytes",
+                    config.log_segment_byte_count);
+      read_optional(daemon_yaml, "log_max_segments",
+                    config.log_max_segment_count);
+      read_optional(daemon_yaml, "metrics_host", config.metrics_host);
+      read_optional(daemon_yaml, "metrics_port", config.metrics_port);
+
+      if (daemon_yaml["log_level"]) {
+        const auto exp_level = parse_log_level(
+          daemon_yaml["log_level"].as<std::string>());
+
+        if (!exp_level.has_value())
+          return tl::make_unexpected(exp_level.error());
+
+        config.log_options.level = *exp_level;
+      }
+
+      if (const auto server_yaml = daemon_yaml["server"]) {
+        if (!server_yaml["port"])
+          return VC_UNEXPECTED("The daemon server requires a port.");
+
+        daemon_server_config server;
+        server.port = server_yaml["port"].as<quint16>();
+
+        if (server_yaml["actor_id"])
+          server.aid = actor_id(server_yaml["actor_id"].as<uint64_t>());
+
+        read_optional(server_yaml, "host", server.host);
+        read_optional(server_yaml, "publish_interval_ms",
+                      server.publish_interval);
+        config.server = std::move(server);
+      }
+
+      for (const auto& client_yaml : daemon_yaml["clients"]) {
+        const auto server_yaml = client_yaml["server"];
+
+        if (!server_yaml || !server_yaml["port"])
+          return VC_UNEXPECTED("Every client requires a server port.");
+
+        daemon_client_config client;
+        client.server.port = server_yaml["port"].as<quint16>();
+        read_optional(server_yaml, "host", client.server.host);
+
+        if (client_yaml["first_actor_id"])
+          client.first_aid = actor_id(
+            client_yaml["first_actor_id"].as<uint64_t>());
+
+        read_optional(client_yaml, "count", client.count);
+        read_optional(client_yaml, "pool_size", client.pool_size);
+        read_optional(client_yaml, "request_interval_ms",
+                      client.request_interval);
+
+        if (client_yaml["mode"]) {
+          const auto exp_mode = parse_client_mode(
+            client_yaml["mode"].as<std::string>());
+
+          if (!exp_mode.has_value())
+            return tl::make_unexpected(exp_mode.error());
+
+          client.mode = *exp_mode;
+        }
+
+        config.clients.push_back(std::move(client));
+      }
+    }
+
+    if (!config.server.has_value() && config.clients.empty()
+        && !config.mesh.has_value())
+      return VC_UNEXPECTED(
+        "The configuration has neither a server, clients nor a mesh node.");
+
+    if (config.log_file.empty())
+      config.log_file = config.mesh.has_value() ? config.mesh->log_file
+                                                : "vector_clocks_daemon.log";
+
+    return config;
+  } catch (const YAML::Exception& ex) {
+    return VC_UNEXPECTED(std::string("Invalid daemon configuration: ")
+                         + ex.what());
+  }
+}
+} // namespace vc
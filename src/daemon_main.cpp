@@ -0,0 +1,199 @@
+#include <climits>
+#include <cstdio>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+
+#include <jaegertracing/Tracer.h>
+
+#include "binary_log.hpp"
+#include "client.hpp"
+#include "daemon_config.hpp"
+#include "logger.hpp"
+#include "mesh_node.hpp"
+#include "metrics_endpoint.hpp"
+#include "mmap_log_sink.hpp"
+#include "resolve_host.hpp"
+#include "server.hpp"
+#include "setup_tracer.hpp"
+
+namespace {
+/**
+ * Creates the sink of the logger described by the configuration.
+ * @param config The configuration of the daemon.
+ * @param ofs The filestream to open if the sink writes to a stream.
+ * @return An expected containing the sink; an error if the log file couldn't
+ *         be opened.
+ */
+tl::expected<std::unique_ptr<vc::log_sink>, vc::error>
+create_log_sink(const vc::daemon_config& config, std::ofstream& ofs) {
+  if (config.log_file != "-" && !config.log_binary
+      && config.log_segment_byte_count > 0) {
+    auto exp_sink = vc::mmap_log_sink::create(
+      {config.log_file, config.log_segment_byte_count,
+       config.log_max_segment_count});
+
+    if (!exp_sink.has_value())
+      return tl::make_unexpected(exp_sink.error());
+
+    return std::unique_ptr<vc::log_sink>(std::move(*exp_sink));
+  }
+
+  std::ostream* os = &std::cout;
+
+  if (config.log_file != "-") {
+    auto mode = std::ios_base::out | std::ios_base::trunc;
+
+    if (config.log_binary)
+      mode |= std::ios_base::binary;
+
+    ofs.open(config.log_file, mode);
+
+    if (!ofs)
+      return VC_UNEXPECTED("Couldn't open log file \"" + config.log_file
+                           + "\"!");
+
+    os = &ofs;
+  }
+
+  if (config.log_binary)
+    return std::make_unique<vc::binary_log_sink>(*os);
+
+  return std::make_unique<vc::text_log_sink>(*os);
+}
+
+/**
+ * Creates the metrics endpoint, server, clients and mesh node described by
+ * the configuration and runs the event loop.
+ * @param config The configuration of the daemon.
+ * @param l The logger to write to.
+ * @return 0 on success; otherwise a non-zero error code.
+ */
+int run(const vc::daemon_config& config, vc::logger& l) {
+  std::unique_ptr<vc::metrics_endpoint> endpoint;
+
+  if (config.metrics_port != 0) {
+    endpoint = std::make_unique<vc::metrics_endpoint>(
+      vc::metrics_registry::global());
+
+    const auto exp_address = vc::resolve_host(config.metrics_host);
+
+    if (!exp_address.has_value()) {
+      fprintf(stderr, "%s\n", exp_address.error().message().c_str());
+      return -1;
+    }
+
+    if (!endpoint->listen(*exp_address, config.metrics_port)) {
+      fprintf(stderr, "Metrics endpoint failed to listen on %s:%u.\n",
+              config.metrics_host.c_str(),
+              static_cast<unsigned>(config.metrics_port));
+      return -1;
+    }
+  }
+
+  std::unique_ptr<vc::server> server;
+
+  if (config.server.has_value()) {
+    server = std::make_unique<vc::server>(config.server->aid, l);
+    server->set_publish_interval(config.server->publish_interval);
+
+    const auto exp_address = vc::resolve_host(config.server->host);
+
+    if (!exp_address.has_value()) {
+      fprintf(stderr, "%s\n", exp_address.error().message().c_str());
+      return -1;
+    }
+
+    if (!server->listen(*exp_address, config.server->port)) {
+      fprintf(stderr, "Server failed to listen on %s:%u.\n",
+              config.server->host.c_str(),
+              static_cast<unsigned>(config.server->port));
+      return -1;
+    }
+  }
+
+  std::vector<std::unique_ptr<vc::client>> clients;
+
+  for (const auto& group : config.clients) {
+    // Resolved once, the clients reconnect to the same address.
+    const auto exp_address = vc::resolve_host(group.server.host);
+
+    if (!exp_address.has_value()) {
+      fprintf(stderr, "%s\n", exp_address.error().message().c_str());
+      return -1;
+    }
+
+    for (size_t i = 0; i < group.count; ++i) {
+      clients.push_back(std::make_unique<vc::client>(
+        vc::actor_id(group.first_aid.value() + i), l));
+      clients.back()->connect(*exp_address, group.server.port, group.mode,
+                              group.request_interval, group.pool_size);
+    }
+  }
+
+  std::unique_ptr<vc::mesh_node> node;
+
+  if (config.mesh.has_value()) {
+    node = std::make_unique<vc::mesh_node>(*config.mesh, l);
+
+    if (!node->start()) {
+      fprintf(stderr, "Mesh node failed to listen on port %u.\n",
+              static_cast<unsigned>(config.mesh->port));
+      return -1;
+    }
+  }
+
+  return QCoreApplication::exec();
+}
+} // namespace
+
+/**
+ * Entry point of the headless daemon.
+ * @param argc Argument count.
+ * @param argv Command line arguments.
+ * @return 0 on success; otherwise a non-zero error code.
+ *
+ * Runs the server, clients and mesh node described by the `daemon` and `mesh`
+ * sections of the configuration file, without any GUI.
+ */
+int main(int argc, char* argv[]) {
+  static_assert(CHAR_BIT == 8,
+                "A byte doesn't contain 8 bits on this platform.");
+
+  constexpr auto expected_argc = 2;
+  constexpr auto config_file_path_index = 1;
+
+  if (argc != expected_argc) {
+    fprintf(stderr, "Usage: %s <config.yml>\n", argv[0]);
+    return -1;
+  }
+
+  const auto exp_config = vc::parse_daemon_config(
+    argv[config_file_path_index]);
+
+  if (!exp_config.has_value()) {
+    fprintf(stderr, "%s\n", exp_config.error().message().c_str());
+    return -1;
+  }
+
+  QCoreApplication application(argc, argv);
+
+  std::ofstream ofs;
+  auto exp_sink = create_log_sink(*exp_config, ofs);
+
+  if (!exp_sink.has_value()) {
+    fprintf(stderr, "%s\n", exp_sink.error().message().c_str());
+    return -1;
+  }
+
+  vc::setup_tracer(argv[config_file_path_index]);
+
+  vc::logger logger(std::move(*exp_sink), exp_config->log_options);
+  const auto ret_val = run(*exp_config, logger);
+  opentracing::Tracer::Global()->Close();
+  return ret_val;
+}
@@ -0,0 +1,429 @@
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QStringList>
+#include <QSysInfo>
+#include <QThread>
+
+#include <fmt/format.h>
+
+#include "load_report.hpp"
+#include "load_worker.hpp"
+#include "logger.hpp"
+#include "read_option.hpp"
+#include "server.hpp"
+
+namespace {
+/**
+ * The parameters that are swept.
+ */
+struct run_config {
+  uint64_t client_count;       /**< Simulated clients */
+  uint64_t clock_size;         /**< Actors in each vector timestamp */
+  uint64_t payload_byte_count; /**< Bytes of echo payload per request */
+};
+
+/**
+ * The parameters shared by all of the runs.
+ */
+struct sweep_options {
+  uint64_t thread_count;         /**< Load worker threads */
+  uint64_t window;               /**< Outstanding requests per client */
+  std::chrono::seconds warmup;   /**< Not measured, at the start of a run */
+  std::chrono::seconds duration; /**< Measured */
+  bool log;                      /**< Whether the server logs its events */
+};
+
+/**
+ * The results of a run.
+ */
+struct run_result {
+  run_config config;
+  vc::load_report report;
+  double cpu_us_per_request;        /**< Of the whole process */
+  double server_cpu_us_per_request; /**< Of the server's thread only */
+};
+
+/**
+ * Reads a CPU time clock.
+ * @param clock_id The clock to read, e.g. CLOCK_PROCESS_CPUTIME_ID.
+ * @return The CPU time consumed.
+ */
+std::chrono::microseconds cpu_time(clockid_t clock_id) {
+  timespec ts{};
+  clock_gettime(clock_id, &ts);
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec));
+}
+
+/**
+ * Invokes a function in the thread of a QObject and waits for it to return.
+ * @param context The QObject whose thread to use.
+ * @param f The function to invoke.
+ */
+template <class Function>
+void invoke_in(QObject* context, Function&& f) {
+  QMetaObject::invokeMethod(context, std::forward<Function>(f),
+                            Qt::BlockingQueuedConnection);
+}
+
+/**
+ * Starts a server, loads it with clients over loopback and measures the
+ * round trip times and the CPU time consumed.
+ * @param config The parameters of this run.
+ * @param options The parameters shared by all of the runs.
+ * @param log The logger of the server.
+ * @param result Assigned the results of the run.
+ * @return true on success; otherwise false.
+ */
+bool run(const run_config& config, const sweep_options& options,
+         vc::logger& log, run_result& result) {
+  // The server gets a thread of its own, so that its CPU time can be told
+  // apart from the clients'.
+  QThread server_thread;
+  QObject server_context;
+  server_context.moveToThread(&server_thread);
+  server_thread.start();
+
+  std::unique_ptr<vc::server> srv;
+  quint16 port = 0;
+
+  invoke_in(&server_context, [&srv, &port, &log] {
+    srv = std::make_unique<vc::server>(vc::actor_id(1), log);
+
+    if (srv->listen(QHostAddress(QHostAddress::LocalHost), 0))
+      port = srv->port();
+  });
+
+  const auto shut_down_server = [&server_context, &server_thread, &srv] {
+    invoke_in(&server_context, [&srv] { srv.reset(); });
+    server_thread.quit();
+    server_thread.wait();
+  };
+
+  if (port == 0) {
+    fprintf(stderr, "The server couldn't listen on the loopback interface.\n");
+    shut_down_server();
+    return false;
+  }
+
+  const auto thread_count = std::min(options.thread_count,
+                                     config.client_count);
+  std::vector<std::unique_ptr<QThread>> threads;
+  std::vector<std::unique_ptr<vc::load_worker>> workers;
+
+  for (uint64_t i = 0; i < thread_count; ++i) {
+    const auto first = config.client_count * i / thread_count;
+    const auto last = config.client_count * (i + 1) / thread_count;
+
+    vc::load_options load;
+    load.host = QHostAddress(QHostAddress::LocalHost);
+    load.port = port;
+    load.first_aid = vc::actor_id(2 + first);
+    load.actor_count = last - first;
+    load.mode = vc::load_mode::closed;
+    load.window = options.window;
+    load.payload_byte_count = config.payload_byte_count;
+    load.clock_size = config.clock_size;
+
+    threads.push_back(std::make_unique<QThread>());
+    workers.push_back(std::make_unique<vc::load_worker>(load));
+
+    auto* worker = workers.back().get();
+    worker->moveToThread(threads.back().get());
+    QObject::connect(threads.back().get(), &QThread::started, worker,
+                     &vc::load_worker::start);
+    threads.back()->start();
+  }
+
+  // Connecting and the first requests aren't representative.
+  std::this_thread::sleep_for(options.warmup);
+
+  for (auto& worker : workers)
+    invoke_in(worker.get(), [&worker] { worker->clear_statistics(); });
+
+  std::chrono::microseconds server_cpu_start{0};
+  invoke_in(&server_context, [&server_cpu_start] {
+    server_cpu_start = cpu_time(CLOCK_THREAD_CPUTIME_ID);
+  });
+  const auto cpu_start = cpu_time(CLOCK_PROCESS_CPUTIME_ID);
+  const auto start_time = std::chrono::steady_clock::now();
+
+  std::this_thread::sleep_for(options.duration);
+
+  for (auto& worker : workers)
+    invoke_in(worker.get(), [&worker] { worker->stop(); });
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start_time);
+  const auto cpu = cpu_time(CLOCK_PROCESS_CPUTIME_ID) - cpu_start;
+
+  std::chrono::microseconds server_cpu{0};
+  invoke_in(&server_context, [&server_cpu, server_cpu_start] {
+    server_cpu = cpu_time(CLOCK_THREAD_CPUTIME_ID) - server_cpu_start;
+  });
+
+  for (auto& thread : threads) {
+    thread->quit();
+    thread->wait();
+  }
+
+  shut_down_server();
+
+  std::vector<uint64_t> latencies_us;
+  uint64_t sent_count = 0;
+  uint64_t error_count = 0;
+
+  for (const auto& worker : workers) {
+    latencies_us.insert(latencies_us.end(), worker->latencies_us().begin(),
+                        worker->latencies_us().end());
+    sent_count += worker->sent_count();
+    error_count += worker->error_count();
+  }
+
+  result.config = config;
+  result.report = vc::make_load_report(std::move(latencies_us), sent_count,
+                                       error_count, elapsed);
+
+  const auto per_request = [&result](std::chrono::microseconds time) {
+    return result.report.received_count == 0
+             ? 0.0
+             : static_cast<double>(time.count())
+                 / static_cast<double>(result.report.received_count);
+  };
+
+  result.cpu_us_per_request = per_request(cpu);
+  result.server_cpu_us_per_request = per_request(server_cpu);
+  return true;
+}
+
+/**
+ * Reads a comma separated list of unsigned integers.
+ * @param parser The parser that processed the command line.
+ * @param option The option to read.
+ * @param values Assigned the values read.
+ * @return true if the option is a non-empty list of positive integers;
+ *         otherwise false.
+ */
+bool read_list(const QCommandLineParser& parser,
+               const QCommandLineOption& option,
+               std::vector<uint64_t>& values) {
+  values.clear();
+
+  for (const auto& element : parser.value(option).split(',')) {
+    bool ok = false;
+    const auto value = element.trimmed().toULongLong(&ok);
+
+    if (!ok || value == 0) {
+      fprintf(stderr, "Invalid value for --%s.\n",
+              option.names().front().toStdString().c_str());
+      return false;
+    }
+
+    values.push_back(value);
+  }
+
+  return !values.empty();
+}
+
+/**
+ * Quotes a string for JSON.
+ * @param s The string to quote.
+ * @return The JSON string literal.
+ */
+std::string json_string(const QString& s) {
+  std::string result("\"");
+
+  for (const auto c : s.toStdString()) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+
+    // Control characters aren't worth escaping in a host name.
+    if (static_cast<unsigned char>(c) >= 0x20)
+      result += c;
+  }
+
+  return result + '"';
+}
+
+/**
+ * Writes the results of the sweep as JSON.
+ * @param file The file to write to.
+ * @param options The parameters shared by all of the runs.
+ * @param results The results of the runs.
+ */
+void write_json(FILE* file, const sweep_options& options,
+                const std::vector<run_result>& results) {
+  fmt::memory_buffer out;
+  auto it = std::back_inserter(out);
+
+  fmt::format_to(
+    it,
+    "{{\n  \"machine\": {{\"host\": {}, \"cpu_architecture\": {}, "
+    "\"kernel\": {}, \"cpu_count\": {}}},\n",
+    json_string(QSysInfo::machineHostName()),
+    json_string(QSysInfo::currentCpuArchitecture()),
+    json_string(QSysInfo::kernelVersion()), QThread::idealThreadCount());
+  fmt::format_to(it,
+                 "  \"options\": {{\"threads\": {}, \"window\": {}, "
+                 "\"warmup_s\": {}, \"duration_s\": {}, \"log\": {}}},\n"
+                 "  \"runs\": [",
+                 options.thread_count, options.window, options.warmup.count(),
+                 options.duration.count(), options.log);
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+
+    fmt::format_to(
+      it,
+      "{}\n    {{\"clients\": {}, \"clock_size\": {}, \"payload_size\": {}, "
+      "\"sent\": {}, \"received\": {}, \"errors\": {}, "
+      "\"requests_per_second\": {:.1f}, \"latency_p50_us\": {}, "
+      "\"latency_p99_us\": {}, \"latency_p999_us\": {}, "
+      "\"latency_max_us\": {}, \"cpu_us_per_request\": {:.3f}, "
+      "\"server_cpu_us_per_request\": {:.3f}}}",
+      i == 0 ? "" : ",", r.config.client_count, r.config.clock_size,
+      r.config.payload_byte_count, r.report.sent_count,
+      r.report.received_count, r.report.error_count, r.report.throughput,
+      r.report.latency_p50_us, r.report.latency_p99_us,
+      r.report.latency_p999_us, r.report.latency_max_us,
+      r.cpu_us_per_request, r.server_cpu_us_per_request);
+  }
+
+  fmt::format_to(it, "\n  ]\n}}\n");
+  fwrite(out.data(), 1, out.size(), file);
+}
+} // namespace
+
+/**
+ * Entry point of the end-to-end benchmark.
+ * @param argc Argument count.
+ * @param argv Command line arguments.
+ * @return 0 on success; otherwise a non-zero error code.
+ *
+ * Runs a server and closed loop clients in this process, connected over
+ * loopback, for every combination of the client counts, clock sizes and
+ * payload sizes given. Prints the throughput, round trip time percentiles and
+ * CPU time per request of every run as JSON, so that runs on the same machine
+ * can be compared.
+ */
+int main(int argc, char* argv[]) {
+  static_assert(CHAR_BIT == 8,
+                "A byte doesn't contain 8 bits on this platform.");
+
+  QCoreApplication application(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    "End-to-end loopback benchmark of the vector clock server and clients.");
+  parser.addHelpOption();
+
+  const QCommandLineOption clients_option(
+    "clients", "Comma separated amounts of simulated clients.", "counts",
+    "1,16,64");
+  const QCommandLineOption clock_option(
+    "clock-sizes", "Comma separated amounts of actors per vector timestamp.",
+    "counts", "1,100,1000");
+  const QCommandLineOption payload_option(
+    "payload-sizes", "Comma separated byte counts of the echo payloads.",
+    "bytes", "16,1024");
+  const QCommandLineOption threads_option("threads",
+                                          "Client worker threads per run.",
+                                          "count", "2");
+  const QCommandLineOption window_option(
+    "window", "Outstanding requests per client.", "count", "1");
+  const QCommandLineOption warmup_option(
+    "warmup", "Seconds to run before measuring.", "seconds", "1");
+  const QCommandLineOption duration_option(
+    "duration", "Seconds to measure per run.", "seconds", "5");
+  const QCommandLineOption log_option(
+    "log", "Let the server log its events, to a discarding sink.");
+  const QCommandLineOption output_option(
+    "output", "File to write the JSON to, - for stdout.", "path", "-");
+
+  parser.addOptions({clients_option, clock_option, payload_option,
+                     threads_option, window_option, warmup_option,
+                     duration_option, log_option, output_option});
+  parser.process(application);
+
+  std::vector<uint64_t> client_counts, clock_sizes, payload_byte_counts;
+  uint64_t thread_count, window, warmup_s, duration_s;
+
+  if (!read_list(parser, clients_option, client_counts)
+      || !read_list(parser, clock_option, clock_sizes)
+      || !read_list(parser, payload_option, payload_byte_counts)
+      || !vc::read_option(parser, threads_option, thread_count)
+      || !vc::read_option(parser, window_option, window)
+      || !vc::read_option(parser, warmup_option, warmup_s)
+      || !vc::read_option(parser, duration_option, duration_s))
+    return -1;
+
+  sweep_options options;
+  options.thread_count = std::max<uint64_t>(thread_count, 1);
+  options.window = std::max<uint64_t>(window, 1);
+  options.warmup = std::chrono::seconds(warmup_s);
+  options.duration = std::chrono::seconds(std::max<uint64_t>(duration_s, 1));
+  options.log = parser.isSet(log_option);
+
+  // The entries are formatted, but discarded, so that the disk isn't
+  // measured.
+  std::ostream discard(nullptr);
+  vc::logger_options log_options;
+  log_options.echo_to_stdout = false;
+  log_options.level = options.log ? vc::log_level::info
+                                  : vc::log_level::critical;
+  vc::logger log(discard, log_options);
+
+  std::vector<run_result> results;
+
+  for (const auto client_count : client_counts)
+    for (const auto clock_size : clock_sizes)
+      for (const auto payload_byte_count : payload_byte_counts) {
+        fprintf(stderr,
+                "Running %llu clients, clock size %llu, payload size %llu.\n",
+                static_cast<unsigned long long>(client_count),
+                static_cast<unsigned long long>(clock_size),
+                static_cast<unsigned long long>(payload_byte_count));
+
+        run_result result{};
+
+        if (!run({client_count, clock_size, payload_byte_count}, options, log,
+                 result))
+          return -1;
+
+        results.push_back(result);
+      }
+
+  const auto output_path = parser.value(output_option);
+  auto* file = output_path == "-"
+                 ? stdout
+                 : fopen(output_path.toStdString().c_str(), "w");
+
+  if (file == nullptr) {
+    fprintf(stderr, "Couldn't open %s.\n", output_path.toStdString().c_str());
+    return -1;
+  }
+
+  write_json(file, options, results);
+
+  if (file != stdout)
+    fclose(file);
+
+  return 0;
+}
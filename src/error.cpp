@@ -3,11 +3,70 @@
 #include "error.hpp"
 
 namespace vc {
+const char* to_string(errc code) noexcept {
+  switch (code) {
+    case errc::generic:
+      return "Error.";
+    case errc::too_few_bytes:
+      return "Too few bytes were provided.";
+    case errc::too_few_vstamp_bytes:
+      return "Too few bytes were supplied.";
+    case errc::invalid_pair_count:
+      return "The pair count given was invalid.";
+    case errc::empty_vstamp:
+      return "A vector timestamp may not be 0 bytes wide.";
+    case errc::empty_payload:
+      return "A payload may not be 0 bytes wide.";
+    case errc::truncated_vstamp:
+      return "The vector timestamp is truncated.";
+    case errc::truncated_payload:
+      return "The payload is truncated.";
+    case errc::missing_trace_context_size:
+      return "The trace context length is missing.";
+    case errc::truncated_trace_context:
+      return "The trace context is truncated.";
+    case errc::vstamp_too_large:
+      return "The vector timestamp of the packet is too large.";
+    case errc::payload_too_large:
+      return "The payload of the packet is too large.";
+    case errc::packet_too_large:
+      return "The packet is too large.";
+    case errc::read_failed:
+      return "Couldn't read from device.";
+    case errc::missing_own_clock:
+      return "Couldn't tick own clock.";
+  }
+
+  return "Unknown error.";
+}
+
 error::error(std::string error_message)
-  : error_message_(std::move(error_message)) {
+  : code_(errc::generic),
+    file_(nullptr),
+    line_(0),
+    function_(nullptr),
+    error_message_(std::move(error_message)) {
+}
+
+error::error(errc code, const char* file, unsigned line,
+             const char* function) noexcept
+  : code_(code),
+    file_(file),
+    line_(line),
+    function_(function),
+    error_message_() {
+}
+
+errc error::code() const noexcept {
+  return code_;
 }
 
-const std::string& error::message() const {
-  return error_message_;
+std::string error::message() const {
+  if (file_ == nullptr)
+    return error_message_;
+
+  return std::string(to_string(code_)) + "\nerror occurred at:\nfile: "
+         + file_ + "\nline: " + std::to_string(line_)
+         + "\nfunction: " + function_;
 }
 } // namespace vc
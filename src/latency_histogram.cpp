@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+
+#include "latency_histogram.hpp"
+
+namespace vc {
+namespace {
+constexpr uint64_t sub_bucket_count = uint64_t(1)
+                                      << latency_histogram::sub_bucket_bits;
+constexpr uint64_t sub_bucket_mask = sub_bucket_count - 1U;
+} // namespace
+
+latency_histogram::latency_histogram() noexcept
+  : buckets_(), count_(0), max_(0) {
+  reset();
+}
+
+void latency_histogram::record(uint64_t value) noexcept {
+  buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+
+  auto current_max = max_.load(std::memory_order_relaxed);
+
+  while (value > current_max
+         && !max_.compare_exchange_weak(current_max, value,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+[[nodiscard]] uint64_t latency_histogram::count() const noexcept {
+  return count_.load(std::memory_order_relaxed);
+}
+
+[[nodiscard]] uint64_t latency_histogram::max() const noexcept {
+  return max_.load(std::memory_order_relaxed);
+}
+
+[[nodiscard]] uint64_t
+latency_histogram::value_at_percentile(double percentile) const noexcept {
+  const auto total = count();
+
+  if (total == 0)
+    return 0;
+
+  // Nearest rank: the value below which `percentile` percent of the values
+  // fall.
+  const auto rank = std::clamp<uint64_t>(
+    static_cast<uint64_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(total))),
+    1, total);
+
+  uint64_t seen = 0;
+
+  for (size_t i = 0; i < bucket_count; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+
+    if (seen >= rank)
+      return std::min(bucket_upper_bound(i), max());
+  }
+
+  // Only reachable if values were recorded concurrently.
+  return max();
+}
+
+void latency_histogram::reset() noexcept {
+  for (auto& bucket : buckets_)
+    bucket.store(0, std::memory_order_relaxed);
+
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+[[nodiscard]] size_t latency_histogram::bucket_index(uint64_t value) noexcept {
+  if (value < sub_bucket_count)
+    return static_cast<size_t>(value);
+
+  // Position of the most significant bit, at least sub_bucket_bits.
+  const auto msb = 63U - static_cast<unsigned>(__builtin_clzll(value));
+  const auto shift = msb - sub_bucket_bits;
+  const auto sub_bucket = (value >> shift) & sub_bucket_mask;
+
+  return static_cast<size_t>(((shift + 1U) << sub_bucket_bits) + sub_bucket);
+}
+
+[[nodiscard]] uint64_t
+latency_histogram::bucket_upper_bound(size_t index) noexcept {
+  const auto group = index >> sub_bucket_bits;
+  const auto sub_bucket = index & sub_bucket_mask;
+
+  if (group == 0)
+    return sub_bucket;
+
+  const auto shift = group - 1U;
+  const auto lower_bound = (sub_bucket_count + sub_bucket) << shift;
+
+  return lower_bound + ((uint64_t(1) << shift) - 1U);
+}
+} // namespace vc
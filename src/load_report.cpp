@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <utility>
+
+#include "load_report.hpp"
+
+namespace vc {
+[[nodiscard]] uint64_t nearest_rank(const std::vector<uint64_t>& sorted_values,
+                                    double percentile) {
+  if (sorted_values.empty())
+    return 0;
+
+  const auto rank = static_cast<size_t>(
+    std::ceil(percentile / 100.0 * static_cast<double>(sorted_values.size())));
+
+  return sorted_values[std::clamp<size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+[[nodiscard]] load_report make_load_report(std::vector<uint64_t> latencies_us,
+                                           uint64_t sent_count,
+                                           uint64_t error_count,
+                                           std::chrono::microseconds elapsed) {
+  std::sort(latencies_us.begin(), latencies_us.end());
+
+  const auto elapsed_s = std::chrono::duration<double>(elapsed).count();
+
+  load_report report{};
+  report.sent_count = sent_count;
+  report.received_count = latencies_us.size();
+  report.error_count = error_count;
+  report.throughput = elapsed_s > 0.0
+                        ? static_cast<double>(latencies_us.size()) / elapsed_s
+                        : 0.0;
+  report.latency_p50_us = nearest_rank(latencies_us, 50.0);
+  report.latency_p90_us = nearest_rank(latencies_us, 90.0);
+  report.latency_p99_us = nearest_rank(latencies_us, 99.0);
+  report.latency_p999_us = nearest_rank(latencies_us, 99.9);
+  report.latency_max_us = latencies_us.empty() ? 0 : latencies_us.back();
+  return report;
+}
+
+std::ostream& operator<<(std::ostream& os, const load_report& report) {
+  return os << "sent:       " << report.sent_count << '\n'
+            << "received:   " << report.received_count << '\n'
+            << "errors:     " << report.error_count << '\n'
+            << "throughput: " << report.throughput << " responses/s\n"
+            << "latency p50:   " << report.latency_p50_us << " us\n"
+            << "latency p90:   " << report.latency_p90_us << " us\n"
+            << "latency p99:   " << report.latency_p99_us << " us\n"
+            << "latency p99.9: " << report.latency_p999_us << " us\n"
+            << "latency max:   " << report.latency_max_us << " us\n";
+}
+} // namespace vc
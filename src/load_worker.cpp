@@ -0,0 +1,215 @@
+#include <cstdio>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "load_worker.hpp"
+#include "opcode.hpp"
+#include "packet.hpp"
+#include "packet_io.hpp"
+
+namespace vc {
+namespace {
+/**
+ * The actor_id of the first of the made up actors that pad the vector
+ * timestamps to the configured clock size.
+ * Chosen high enough not to collide with the actor_ids of real actors.
+ */
+constexpr uint64_t padding_aid_base = uint64_t(1) << 48U;
+
+/**
+ * The interval at which an open loop worker checks for due requests.
+ */
+constexpr int pace_interval_ms = 1;
+} // namespace
+
+load_worker::load_worker(load_options options, QObject* parent)
+  : QObject(parent),
+    options_(std::move(options)),
+    actors_(),
+    payload_(options_.payload_byte_count, pl::byte{0x2A}),
+    pace_timer_(this),
+    start_time_(),
+    next_actor_(0),
+    offered_count_(0),
+    is_running_(false),
+    latencies_us_(),
+    statistics_start_(),
+    sent_count_(0),
+    error_count_(0) {
+  // The timer is a child, so that it moves along to the worker's thread.
+  connect(&pace_timer_, &QTimer::timeout, this, &load_worker::on_pace_timeout);
+}
+
+void load_worker::start() {
+  vector_timestamp padding{actor_id(padding_aid_base)};
+
+  for (size_t i = 1; i + 1 < options_.clock_size; ++i)
+    padding.merge(vector_timestamp(actor_id(padding_aid_base + i)));
+
+  actors_.reserve(options_.actor_count);
+
+  for (size_t i = 0; i < options_.actor_count; ++i) {
+    const actor_id aid(options_.first_aid.value() + i);
+    auto a = std::make_unique<actor>(
+      actor{aid, std::make_unique<QTcpSocket>(), vector_timestamp(aid), {}});
+
+    if (options_.clock_size > 1)
+      a->vstamp.merge(padding);
+
+    auto* raw = a.get();
+    connect(raw->socket.get(), &QIODevice::readyRead, this,
+            [this, raw] { on_ready_read(*raw); });
+
+    if (options_.mode == load_mode::closed)
+      connect(raw->socket.get(), &QAbstractSocket::connected, this,
+              [this, raw] {
+                for (size_t j = 0; j < options_.window; ++j)
+                  send_request(*raw);
+              });
+
+    raw->socket->connectToHost(options_.host, options_.port);
+    actors_.push_back(std::move(a));
+  }
+
+  is_running_ = true;
+  start_time_ = clock::now();
+
+  if (options_.mode == load_mode::open)
+    pace_timer_.start(pace_interval_ms);
+}
+
+void load_worker::stop() {
+  is_running_ = false;
+  pace_timer_.stop();
+
+  for (auto& a : actors_) {
+    // Requests that are still in flight never completed.
+    error_count_ += static_cast<uint64_t>(
+      std::count_if(a->in_flight.begin(), a->in_flight.end(),
+                    [this](clock::time_point sent_at) {
+                      return sent_at >= statistics_start_;
+                    }));
+    a->socket->abort();
+  }
+
+  actors_.clear();
+}
+
+[[nodiscard]] const std::vector<uint64_t>&
+load_worker::latencies_us() const noexcept {
+  return latencies_us_;
+}
+
+[[nodiscard]] uint64_t load_worker::sent_count() const noexcept {
+  return sent_count_;
+}
+
+[[nodiscard]] uint64_t load_worker::error_count() const noexcept {
+  return error_count_;
+}
+
+void load_worker::clear_statistics() {
+  // The requests in flight stay, as the responses are matched to them in
+  // order, but are left out of the statistics.
+  statistics_start_ = clock::now();
+  latencies_us_.clear();
+  sent_count_ = 0;
+  error_count_ = 0;
+}
+
+void load_worker::on_pace_timeout() {
+  if (actors_.empty())
+    return;
+
+  // Catch up on every request that should have been sent by now, so that a
+  // late timer doesn't lower the offered load.
+  const auto elapsed_s
+    = std::chrono::duration<double>(clock::now() - start_time_).count();
+  const auto due_count = static_cast<uint64_t>(elapsed_s * options_.rate);
+
+  for (; offered_count_ < due_count; ++offered_count_) {
+    auto& a = *actors_[next_actor_];
+    next_actor_ = (next_actor_ + 1) % actors_.size();
+
+    if (a.socket->state() != QAbstractSocket::ConnectedState) {
+      ++error_count_;
+      continue;
+    }
+
+    send_request(a);
+  }
+}
+
+void load_worker::on_ready_read(actor& a) {
+  for (;;) {
+    const auto exp_complete = has_complete_packet(
+      *a.socket, std::numeric_limits<uint32_t>::max());
+
+    if (!exp_complete.has_value()) {
+      fprintf(stderr, "Load worker received an invalid packet!\n");
+      a.socket->abort();
+      return;
+    }
+
+    if (!*exp_complete)
+      return;
+
+    const auto exp_pkt = read_packet(*a.socket);
+    const auto received_at = clock::now();
+
+    if (!exp_pkt.has_value() || a.in_flight.empty()) {
+      ++error_count_;
+      continue;
+    }
+
+    // The server responds in order, so the oldest request is the one being
+    // answered.
+    const auto sent_at = a.in_flight.front();
+    a.in_flight.pop_front();
+
+    const auto exp_their_vc = vector_timestamp::deserialize_from_binary(
+      exp_pkt->vstamp_buffer().data(), exp_pkt->vstamp_buffer().size());
+
+    if (!exp_their_vc.has_value() || !a.vstamp.tick(a.aid).has_value()) {
+      ++error_count_;
+      continue;
+    }
+
+    a.vstamp.merge(*exp_their_vc);
+
+    if (sent_at >= statistics_start_)
+      latencies_us_.push_back(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(received_at
+                                                              - sent_at)
+          .count()));
+
+    if (is_running_ && options_.mode == load_mode::closed)
+      send_request(a);
+  }
+}
+
+void load_worker::send_request(actor& a) {
+  if (!a.vstamp.tick(a.aid).has_value()) {
+    ++error_count_;
+    return;
+  }
+
+  const auto vstamp_binary = a.vstamp.serialize_to_binary();
+
+  const packet pkt(opcode::echo, 0, vstamp_binary.data(),
+                   vstamp_binary.size(), payload_.data(), payload_.size());
+  const auto pkt_bin = pkt.serialize_to_binary();
+
+  if (a.socket->write(reinterpret_cast<const char*>(pkt_bin.data()),
+                      pkt_bin.size())
+      == -1) {
+    ++error_count_;
+    return;
+  }
+
+  a.in_flight.push_back(clock::now());
+  ++sent_count_;
+}
+} // namespace vc
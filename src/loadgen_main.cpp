@@ -0,0 +1,169 @@
+#include <climits>
+#include <cstdio>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+
+#include "load_report.hpp"
+#include "load_worker.hpp"
+#include "read_option.hpp"
+#include "server_port.hpp"
+
+/**
+ * Entry point of the load generator.
+ * @param argc Argument count.
+ * @param argv Command line arguments.
+ * @return 0 on success; otherwise a non-zero error code.
+ *
+ * Runs thousands of simulated clients from a few threads against a server,
+ * then prints the throughput and round trip time percentiles.
+ */
+int main(int argc, char* argv[]) {
+  static_assert(CHAR_BIT == 8,
+                "A byte doesn't contain 8 bits on this platform.");
+
+  QCoreApplication application(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    "Load generator for the vector clock server.");
+  parser.addHelpOption();
+
+  const QCommandLineOption host_option("host", "Address of the server.",
+                                       "address", "127.0.0.1");
+  const QCommandLineOption port_option(
+    "port", "TCP port of the server.", "port",
+    QString::number(vc::server_port));
+  const QCommandLineOption threads_option("threads", "Worker threads.",
+                                          "count", "4");
+  const QCommandLineOption clients_option("clients", "Simulated clients.",
+                                          "count", "1000");
+  const QCommandLineOption mode_option(
+    "mode", "open: send at --rate; closed: keep --window requests in flight.",
+    "open|closed", "closed");
+  const QCommandLineOption rate_option(
+    "rate", "Total requests per second in open loop mode.", "count", "10000");
+  const QCommandLineOption window_option(
+    "window", "Outstanding requests per client in closed loop mode.", "count",
+    "1");
+  const QCommandLineOption payload_option("payload-size",
+                                          "Bytes of echo payload per request.",
+                                          "bytes", "16");
+  const QCommandLineOption clock_option(
+    "clock-size", "Actors in each vector timestamp.", "count", "1");
+  const QCommandLineOption duration_option("duration", "Seconds to run.",
+                                           "seconds", "10");
+
+  parser.addOptions({host_option, port_option, threads_option, clients_option,
+                     mode_option, rate_option, window_option, payload_option,
+                     clock_option, duration_option});
+  parser.process(application);
+
+  uint64_t port, thread_count, client_count, rate, window, payload_byte_count,
+    clock_size, duration_s;
+
+  if (!vc::read_option(parser, port_option, port)
+      || !vc::read_option(parser, threads_option, thread_count)
+      || !vc::read_option(parser, clients_option, client_count)
+      || !vc::read_option(parser, rate_option, rate)
+      || !vc::read_option(parser, window_option, window)
+      || !vc::read_option(parser, payload_option, payload_byte_count)
+      || !vc::read_option(parser, clock_option, clock_size)
+      || !vc::read_option(parser, duration_option, duration_s))
+    return -1;
+
+  const auto mode_name = parser.value(mode_option);
+
+  if (mode_name != "open" && mode_name != "closed") {
+    fprintf(stderr, "Invalid value for --mode.\n");
+    return -1;
+  }
+
+  if (client_count == 0) {
+    fprintf(stderr, "At least one client is required.\n");
+    return -1;
+  }
+
+  thread_count = std::clamp<uint64_t>(thread_count, 1, client_count);
+
+  std::vector<std::unique_ptr<QThread>> threads;
+  std::vector<std::unique_ptr<vc::load_worker>> workers;
+
+  for (uint64_t i = 0; i < thread_count; ++i) {
+    // Spread the clients and the rate evenly across the workers.
+    const auto first = client_count * i / thread_count;
+    const auto last = client_count * (i + 1) / thread_count;
+
+    vc::load_options options;
+    options.host = QHostAddress(parser.value(host_option));
+    options.port = static_cast<quint16>(port);
+    options.first_aid = vc::actor_id(2 + first);
+    options.actor_count = last - first;
+    options.mode = mode_name == "open" ? vc::load_mode::open
+                                       : vc::load_mode::closed;
+    options.rate = static_cast<double>(rate) * static_cast<double>(last - first)
+                   / static_cast<double>(client_count);
+    options.window = window;
+    options.payload_byte_count = payload_byte_count;
+    options.clock_size = clock_size;
+
+    threads.push_back(std::make_unique<QThread>());
+    workers.push_back(std::make_unique<vc::load_worker>(options));
+
+    auto* worker = workers.back().get();
+    worker->moveToThread(threads.back().get());
+    QObject::connect(threads.back().get(), &QThread::started, worker,
+                     &vc::load_worker::start);
+  }
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  for (auto& thread : threads)
+    thread->start();
+
+  QTimer::singleShot(std::chrono::seconds(duration_s), &application,
+                     [&application, &workers] {
+                       for (auto& worker : workers)
+                         QMetaObject::invokeMethod(
+                           worker.get(), [&worker] { worker->stop(); },
+                           Qt::BlockingQueuedConnection);
+
+                       application.quit();
+                     });
+
+  const auto ret_val = QCoreApplication::exec();
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start_time);
+
+  for (auto& thread : threads) {
+    thread->quit();
+    thread->wait();
+  }
+
+  std::vector<uint64_t> latencies_us;
+  uint64_t sent_count = 0;
+  uint64_t error_count = 0;
+
+  for (const auto& worker : workers) {
+    latencies_us.insert(latencies_us.end(), worker->latencies_us().begin(),
+                        worker->latencies_us().end());
+    sent_count += worker->sent_count();
+    error_count += worker->error_count();
+  }
+
+  std::cout << vc::make_load_report(std::move(latencies_us), sent_count,
+                                    error_count, elapsed);
+
+  return ret_val;
+}
@@ -0,0 +1,70 @@
+#include <cstdio>
+
+#include <fstream>
+#include <iostream>
+
+#include "binary_log.hpp"
+#include "log_sink.hpp"
+
+/**
+ * Entry point of the binary log converter.
+ * @param argc Argument count.
+ * @param argv Command line arguments.
+ * @return 0 on success; otherwise a non-zero error code.
+ *
+ * Converts a log written by a binary_log_sink to the ShiViz text format,
+ * writing to the output file if one is given; otherwise to stdout.
+ */
+int main(int argc, char* argv[]) {
+  constexpr auto input_file_path_index = 1;
+  constexpr auto output_file_path_index = 2;
+
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "Usage: %s <binary.log> [shiviz.log]\n", argv[0]);
+    return -1;
+  }
+
+  std::ifstream ifs(argv[input_file_path_index],
+                    std::ios_base::in | std::ios_base::binary);
+
+  if (!ifs) {
+    fprintf(stderr, "Couldn't open \"%s\"!\n", argv[input_file_path_index]);
+    return -1;
+  }
+
+  std::ofstream ofs;
+  std::ostream* os = &std::cout;
+
+  if (argc == 3) {
+    ofs.open(argv[output_file_path_index],
+             std::ios_base::out | std::ios_base::trunc);
+
+    if (!ofs) {
+      fprintf(stderr, "Couldn't open \"%s\"!\n",
+              argv[output_file_path_index]);
+      return -1;
+    }
+
+    os = &ofs;
+  }
+
+  vc::binary_log_reader reader(ifs);
+  vc::text_log_sink sink(*os);
+
+  for (;;) {
+    const auto exp_record = reader.next();
+
+    if (!exp_record.has_value()) {
+      fprintf(stderr, "%s\n", exp_record.error().message().c_str());
+      return -1;
+    }
+
+    if (!exp_record->has_value())
+      break;
+
+    sink.write(**exp_record);
+  }
+
+  sink.flush();
+  return 0;
+}
@@ -5,31 +5,27 @@
 #include "log_level.hpp"
 
 namespace vc {
-std::ostream& operator<<(std::ostream& os, log_level ll) {
+[[nodiscard]] const char* to_string(log_level ll) noexcept {
   switch (ll) {
     case log_level::trace:
-      os << "TRACE";
-      break;
+      return "TRACE";
     case log_level::debug:
-      os << "DEBUG";
-      break;
+      return "DEBUG";
     case log_level::info:
-      os << "INFO";
-      break;
+      return "INFO";
     case log_level::warning:
-      os << "WARNING";
-      break;
+      return "WARNING";
     case log_level::error:
-      os << "ERROR";
-      break;
+      return "ERROR";
     case log_level::critical:
-      os << "CRITICAL";
-      break;
+      return "CRITICAL";
     default:
       Q_UNREACHABLE();
-      break;
+      return "";
   }
+}
 
-  return os;
+std::ostream& operator<<(std::ostream& os, log_level ll) {
+  return os << to_string(ll);
 }
 } // namespace vc
@@ -0,0 +1,11 @@
+#include <fmt/format.h>
+
+#include "log_record.hpp"
+
+namespace vc {
+[[nodiscard]] std::string to_shiviz(const log_record& record) {
+  return fmt::format("{} {} {} {} {}:{} \"{}\"", record.vstamp, record.level,
+                     record.aid, record.function, record.file, record.line,
+                     record.message);
+}
+} // namespace vc
@@ -0,0 +1,19 @@
+#include <ostream>
+
+#include "log_sink.hpp"
+
+namespace vc {
+log_sink::~log_sink() = default;
+
+text_log_sink::text_log_sink(std::ostream& os) : os_(&os) {
+  (*os_) << shiviz_regex << "\n\n" << std::flush;
+}
+
+void text_log_sink::write(const log_record& record) {
+  (*os_) << to_shiviz(record) << '\n';
+}
+
+void text_log_sink::flush() {
+  os_->flush();
+}
+} // namespace vc
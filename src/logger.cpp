@@ -1,15 +1,333 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "causal_merge.hpp"
 #include "logger.hpp"
+#include "metrics.hpp"
+#include "spsc_queue.hpp"
 
 namespace vc {
-logger::logger(std::ostream& sink) : mu_(), sink_(&sink) {
-  std::lock_guard<std::mutex> lock_guard(mu_);
+namespace {
+/**
+ * The amount of entries the writer thread writes before checking whether the
+ * sink needs to be flushed.
+ */
+constexpr size_t writer_batch_size = 256;
+
+/**
+ * The time the writer thread sleeps when there's nothing to write.
+ */
+constexpr std::chrono::milliseconds writer_idle_sleep{1};
+
+/**
+ * Source of the identifiers of the loggers, used to look up the per-thread
+ * buffers.
+ */
+std::atomic<uint64_t> next_logger_id{0};
+
+/**
+ * The metrics updated by all of the loggers.
+ */
+struct logger_metrics {
+  metrics_registry& registry = metrics_registry::global();
+  counter& records = registry.add_counter("vc_log_records_total",
+                                          "Log records written or queued.");
+  counter& queue_full = registry.add_counter(
+    "vc_log_queue_full_total",
+    "Times a thread had to wait for the log writer, because its queue was "
+    "full.");
+  gauge& queue_depth = registry.add_gauge(
+    "vc_log_queue_depth",
+    "Log records queued or held back that haven't been written yet.");
+};
+
+logger_metrics& metrics() {
+  static logger_metrics instance;
+  return instance;
+}
+
+/**
+ * Pushes a record, waiting for the writer thread rather than dropping the
+ * record if the queue is full.
+ * @tparam Queue The type of the queue.
+ * @param queue The queue to push to.
+ * @param record The record to push.
+ */
+template <class Queue>
+void push_waiting(Queue& queue, log_record&& record) {
+  if (queue.try_push(std::move(record)))
+    return;
+
+  metrics().queue_full.add();
+
+  while (!queue.try_push(std::move(record)))
+    std::this_thread::yield();
+}
+} // namespace
+
+struct logger::thread_buffer {
+  thread_buffer(uint64_t buffer_id, size_t capacity)
+    : id(buffer_id), queue(capacity), is_abandoned(false) {
+  }
+
+  const uint64_t id;
+  spsc_queue<log_record> queue;
+
+  /**
+   * Set once the thread that owns the buffer has exited, nothing is pushed
+   * afterwards.
+   */
+  std::atomic<bool> is_abandoned;
+};
+
+logger::logger(std::ostream& sink, logger_options options)
+  : logger(std::make_unique<text_log_sink>(sink), options) {
+  if (options_.echo_to_stdout)
+    printf("Wrote \"%s\" to log.\n", shiviz_regex);
+}
+
+logger::logger(std::unique_ptr<log_sink> sink, logger_options options)
+  : id_(next_logger_id.fetch_add(1, std::memory_order_relaxed)),
+    mu_(),
+    sink_(std::move(sink)),
+    options_(options),
+    level_(options_.level),
+    queue_(options_.asynchronous && !options_.per_thread_buffers
+             ? std::make_unique<mpsc_queue<log_record>>(
+               options_.queue_capacity)
+             : nullptr),
+    buffers_mu_(),
+    buffers_(),
+    next_buffer_id_(0),
+    buffers_version_(0),
+    is_stopping_(false),
+    writer_() {
+  if (options_.asynchronous)
+    writer_ = std::thread(options_.per_thread_buffers
+                            ? &logger::run_merging_writer
+                            : &logger::run_writer,
+                          this);
+}
+
+logger::~logger() {
+  if (!writer_.joinable())
+    return;
+
+  is_stopping_.store(true, std::memory_order_release);
+  writer_.join();
+
+  // Lets the threads that logged release their buffers.
+  std::lock_guard<std::mutex> lock_guard(buffers_mu_);
+  (void) lock_guard;
+  buffers_.clear();
+}
+
+void logger::write(log_record record) {
+  metrics().records.add();
+
+  if (options_.asynchronous && options_.per_thread_buffers) {
+    push_waiting(local_buffer().queue, std::move(record));
+    return;
+  }
+
+  if (queue_ == nullptr) {
+    std::lock_guard<std::mutex> lock_guard(mu_);
+    (void) lock_guard;
+
+    sink_->write(record);
+    sink_->flush();
+    echo(record);
+
+    return;
+  }
+
+  push_waiting(*queue_, std::move(record));
+}
+
+void logger::echo(const log_record& record) const {
+  if (options_.echo_to_stdout)
+    std::printf("Wrote \"%s\" to log.\n", to_shiviz(record).c_str());
+}
+
+logger::thread_buffer& logger::local_buffer() {
+  /**
+   * The buffers of a thread, abandoned when the thread exits so that the
+   * writer threads drop them once they're drained.
+   */
+  struct local_buffers {
+    ~local_buffers() {
+      for (const auto& [logger_id, buffer] : buffers)
+        if (buffer != nullptr)
+          buffer->is_abandoned.store(true, std::memory_order_release);
+    }
+
+    std::unordered_map<uint64_t, std::shared_ptr<thread_buffer>> buffers;
+  };
+
+  thread_local local_buffers local;
+  auto& buffers = local.buffers;
+  auto& buffer = buffers[id_];
+
+  if (buffer != nullptr)
+    return *buffer;
+
+  // Slow path, taken once per thread: drop the buffers of loggers that were
+  // destroyed and register a new buffer with the writer thread.
+  for (auto it = buffers.begin(); it != buffers.end();) {
+    if (it->second != nullptr && it->second.use_count() == 1)
+      it = buffers.erase(it);
+    else
+      ++it;
+  }
+
+  std::lock_guard<std::mutex> lock_guard(buffers_mu_);
   (void) lock_guard;
 
-  constexpr char regex[]
-    = R"~((?<clock>{.+}) (?<level>INFO) (?<host>\w+\d+) (?<function>.+) (?<file>.+):(?<line>\d+) (?<event>.+))~";
+  auto new_buffer = std::make_shared<thread_buffer>(
+    next_buffer_id_++, options_.thread_buffer_capacity);
+  buffers_.push_back(new_buffer);
+  buffers_version_.fetch_add(1, std::memory_order_release);
+
+  auto& result = buffers[id_];
+  result = std::move(new_buffer);
+  return *result;
+}
+
+void logger::run_writer() {
+  using clock = std::chrono::steady_clock;
+
+  auto last_flush = clock::now();
+  auto is_dirty = false;
+
+  const auto write_record = [this](log_record&& record) {
+    sink_->write(record);
+    echo(record);
+  };
+
+  for (;;) {
+    // Read the flag before draining, so that no entry pushed before the
+    // logger was destroyed is lost.
+    const auto is_stopping = is_stopping_.load(std::memory_order_acquire);
+    size_t written = 0;
+
+    while (written < writer_batch_size && queue_->try_consume(write_record)) {
+      is_dirty = true;
+      ++written;
+    }
+
+    metrics().queue_depth.set(static_cast<int64_t>(queue_->size()));
+
+    const auto now = clock::now();
+
+    if (is_dirty
+        && (is_stopping || now - last_flush >= options_.flush_interval)) {
+      sink_->flush();
+      last_flush = now;
+      is_dirty = false;
+    }
+
+    if (is_stopping && written == 0)
+      return;
+
+    if (written == 0)
+      std::this_thread::sleep_for(writer_idle_sleep);
+  }
+}
+
+void logger::run_merging_writer() {
+  using clock = std::chrono::steady_clock;
+
+  causal_merge merge;
+  std::vector<std::shared_ptr<thread_buffer>> buffers;
+  uint64_t buffers_version = 0;
+  auto last_flush = clock::now();
+  auto is_dirty = false;
+
+  const auto write_record = [this](log_record&& record) {
+    sink_->write(record);
+    echo(record);
+  };
+
+  for (;;) {
+    const auto is_stopping = is_stopping_.load(std::memory_order_acquire);
+
+    if (buffers_version_.load(std::memory_order_acquire) != buffers_version) {
+      std::lock_guard<std::mutex> lock_guard(buffers_mu_);
+      (void) lock_guard;
+
+      buffers = buffers_;
+      buffers_version = buffers_version_.load(std::memory_order_relaxed);
+    }
+
+    // A round is only complete if every buffer was seen empty, a buffer may
+    // be refilled as fast as it's drained.
+    size_t drained = 0;
+    auto is_complete_round = true;
+    std::vector<std::shared_ptr<thread_buffer>> abandoned;
+
+    for (const auto& buffer : buffers) {
+      // Read the flag before draining, so that a buffer seen empty afterwards
+      // stays empty.
+      const auto is_abandoned = buffer->is_abandoned.load(
+        std::memory_order_acquire);
+      const auto capacity = buffer->queue.capacity();
+      size_t count = 0;
+
+      while (count < capacity
+             && buffer->queue.try_consume(
+               [&merge, &buffer](log_record&& record) {
+                 merge.push(buffer->id, std::move(record));
+               }))
+        ++count;
+
+      is_complete_round = is_complete_round && count < capacity;
+
+      if (is_abandoned && count < capacity)
+        abandoned.push_back(buffer);
+
+      drained += count;
+    }
+
+    // Deregisters the buffers of exited threads, their entries that are held
+    // back stay in the merge.
+    if (!abandoned.empty()) {
+      std::lock_guard<std::mutex> lock_guard(buffers_mu_);
+      (void) lock_guard;
+
+      for (const auto& buffer : abandoned)
+        buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffer));
+
+      buffers_version_.fetch_add(1, std::memory_order_release);
+      buffers = buffers_;
+      buffers_version = buffers_version_.load(std::memory_order_relaxed);
+    }
+
+    if (is_complete_round)
+      merge.complete_round();
+
+    const auto is_done = is_stopping && drained == 0;
+
+    if (is_done)
+      merge.release_all();
+
+    if (merge.pop(write_record) > 0)
+      is_dirty = true;
+
+    metrics().queue_depth.set(static_cast<int64_t>(merge.size()));
+
+    const auto now = clock::now();
+
+    if (is_dirty && (is_done || now - last_flush >= options_.flush_interval)) {
+      sink_->flush();
+      last_flush = now;
+      is_dirty = false;
+    }
 
-  (*sink_) << regex << "\n\n" << std::flush;
+    if (is_done)
+      return;
 
-  printf("Wrote \"%s\" to log.\n", regex);
+    if (drained == 0)
+      std::this_thread::sleep_for(writer_idle_sleep);
+  }
 }
 } // namespace vc
@@ -1,19 +1,35 @@
-#include <cassert>
 #include <cstdio>
 
+#include <iostream>
+
 #include <QPushButton>
 
 #include "client.hpp"
 #include "main_window.hpp"
+#include "mmap_log_sink.hpp"
 #include "server.hpp"
 
 namespace vc {
-main_window::main_window(QWidget* parent)
-  : QMainWindow(parent),
-    ofs_("logfile.log", std::ios_base::out | std::ios_base::trunc),
-    logger_(ofs_) {
-  assert(ofs_.operator bool() && "Couldn't open log file!");
+namespace {
+/**
+ * Creates the sink of the logger.
+ * @return The sink writing to logfile.log; a sink writing to stdout if
+ *         logfile.log couldn't be created.
+ */
+std::unique_ptr<log_sink> create_log_sink() {
+  auto exp_sink = mmap_log_sink::create({"logfile.log"});
+
+  if (!exp_sink.has_value()) {
+    fprintf(stderr, "%s\n", exp_sink.error().message().c_str());
+    return std::make_unique<text_log_sink>(std::cout);
+  }
 
+  return std::move(*exp_sink);
+}
+} // namespace
+
+main_window::main_window(QWidget* parent)
+  : QMainWindow(parent), logger_(create_log_sink()) {
   setWindowTitle("Vector clocks");
 
   auto* button = new QPushButton("Run", this);
@@ -22,7 +38,7 @@ main_window::main_window(QWidget* parent)
 
 void main_window::on_button_click() {
   // Create the server
-  auto* serv = new server(actor_id{1}, logger_, this);
+  auto* serv = new server(actor_id{1}, logger_, default_watermarks, this);
   if (!serv->listen()) {
     fprintf(stderr, "Server failed to listen.\n");
     return;
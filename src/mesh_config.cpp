@@ -0,0 +1,54 @@
+#include <utility>
+
+#include <yaml-cpp/yaml.h>
+
+#include "mesh_config.hpp"
+#include "read_optional.hpp"
+
+namespace vc {
+tl::expected<tl::optional<mesh_config>, error>
+parse_mesh_config(pl::string_view config_filepath) {
+  try {
+    const auto config_yaml = YAML::LoadFile(config_filepath.to_string());
+    const auto mesh_yaml = config_yaml["mesh"];
+
+    if (!mesh_yaml)
+      return tl::optional<mesh_config>();
+
+    if (!mesh_yaml["actor_id"] || !mesh_yaml["port"])
+      return VC_UNEXPECTED("The mesh section requires actor_id and port.");
+
+    mesh_config config;
+    config.aid = actor_id(mesh_yaml["actor_id"].as<uint64_t>());
+    config.port = mesh_yaml["port"].as<quint16>();
+    read_optional(mesh_yaml, "host", config.host);
+    read_optional(mesh_yaml, "fanout", config.fanout);
+    read_optional(mesh_yaml, "gossip_interval_ms", config.gossip_interval);
+    read_optional(mesh_yaml, "merge_interval_ms", config.merge_interval);
+    read_optional(mesh_yaml, "stats_interval_ms", config.stats_interval);
+    read_optional(mesh_yaml, "log_file", config.log_file);
+
+    const auto peers_yaml = mesh_yaml["peers"];
+
+    for (const auto& peer_yaml : peers_yaml) {
+      peer_address peer{"127.0.0.1", 0};
+      read_optional(peer_yaml, "host", peer.host);
+
+      if (!peer_yaml["port"])
+        return VC_UNEXPECTED("Every peer requires a port.");
+
+      peer.port = peer_yaml["port"].as<quint16>();
+      config.peers.push_back(peer);
+    }
+
+    if (config.log_file.empty())
+      config.log_file = "mesh_" + config.aid.to_string().toStdString()
+                        + ".log";
+
+    return tl::optional<mesh_config>(std::move(config));
+  } catch (const YAML::Exception& ex) {
+    return VC_UNEXPECTED(std::string("Invalid mesh configuration: ")
+                         + ex.what());
+  }
+}
+} // namespace vc
@@ -0,0 +1,351 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "hton.hpp"
+#include "mesh_node.hpp"
+#include "ntoh.hpp"
+#include "packet_io.hpp"
+#include "resolve_host.hpp"
+
+namespace vc {
+namespace {
+/**
+ * Returns the current wall clock time in microseconds since the epoch.
+ * All nodes of a local mesh share the clock, which makes it usable to measure
+ * how long a clock value took to propagate.
+ */
+uint64_t now_us() {
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch())
+      .count());
+}
+} // namespace
+
+mesh_node::mesh_node(mesh_config config, logger& l, QObject* parent)
+  : QObject(parent),
+    config_(std::move(config)),
+    logger_(l),
+    tcp_server_(PL_NO_PARENT),
+    inbound_(),
+    peers_(),
+    vstamp_(config_.aid),
+    origins_(),
+    pending_(tl::nullopt),
+    pending_origins_(),
+    pending_count_(0),
+    gossip_timer_(PL_NO_PARENT),
+    merge_timer_(PL_NO_PARENT),
+    stats_timer_(PL_NO_PARENT),
+    random_engine_(std::random_device{}()),
+    bytes_sent_(0),
+    bytes_received_(0),
+    gossip_sent_(0),
+    gossip_received_(0),
+    batches_merged_(0),
+    propagation_count_(0),
+    propagation_sum_us_(0),
+    propagation_max_us_(0) {
+  for (const auto& address : config_.peers)
+    peers_.push_back(peer_connection{address, std::make_unique<QTcpSocket>()});
+
+  connect(&tcp_server_, &QTcpServer::newConnection, this,
+          &mesh_node::on_new_connection);
+  connect(&gossip_timer_, &QTimer::timeout, this, &mesh_node::gossip);
+  connect(&merge_timer_, &QTimer::timeout, this, &mesh_node::merge_pending);
+  connect(&stats_timer_, &QTimer::timeout, this, &mesh_node::print_stats);
+}
+
+mesh_node::~mesh_node() {
+  tcp_server_.close();
+
+  for (auto& peer : peers_)
+    peer.socket->abort();
+
+  // Deleting a connected socket emits disconnected, whose handler would
+  // erase from inbound_ while it is iterated over.
+  for (auto* socket : std::exchange(inbound_, {})) {
+    QObject::disconnect(socket, nullptr, this, nullptr);
+    delete socket;
+  }
+}
+
+[[nodiscard]] bool mesh_node::start() {
+  const auto exp_address = resolve_host(config_.host);
+
+  if (!exp_address.has_value()) {
+    fprintf(stderr, "%s\n", exp_address.error().message().c_str());
+    return false;
+  }
+
+  if (!tcp_server_.listen(*exp_address, config_.port))
+    return false;
+
+  connect_to_peers();
+
+  gossip_timer_.start(static_cast<int>(config_.gossip_interval.count()));
+  merge_timer_.start(static_cast<int>(config_.merge_interval.count()));
+  stats_timer_.start(static_cast<int>(config_.stats_interval.count()));
+
+  return true;
+}
+
+void mesh_node::on_new_connection() {
+  for (QTcpSocket* socket = nullptr;
+       (socket = tcp_server_.nextPendingConnection()) != nullptr;) {
+    inbound_.push_back(socket);
+
+    connect(socket, &QIODevice::readyRead, this,
+            &mesh_node::on_peer_ready_read);
+    connect(socket, &QAbstractSocket::disconnected, this, [this, socket] {
+      inbound_.erase(std::remove(inbound_.begin(), inbound_.end(), socket),
+                     inbound_.end());
+      socket->deleteLater();
+    });
+  }
+}
+
+void mesh_node::on_peer_ready_read() {
+  auto* socket = qobject_cast<QTcpSocket*>(sender());
+
+  if (socket == nullptr)
+    return;
+
+  for (;;) {
+    const auto exp_complete = has_complete_packet(
+      *socket, std::numeric_limits<uint32_t>::max());
+
+    if (!exp_complete.has_value()) {
+      fprintf(stderr, "Mesh node received an invalid packet!\n");
+      socket->abort();
+      return;
+    }
+
+    if (!*exp_complete)
+      return;
+
+    const auto exp_pkt = read_packet(*socket);
+
+    if (!exp_pkt.has_value()) {
+      fprintf(stderr, "Mesh node couldn't read packet from peer!\n");
+      return;
+    }
+
+    bytes_received_ += packet::header_byte_count + 2U * sizeof(uint64_t)
+                       + exp_pkt->vstamp_buffer().size()
+                       + exp_pkt->payload_buffer().size();
+
+    if (exp_pkt->op() != opcode::gossip) {
+      fprintf(stderr, "Mesh node received unexpected opcode from peer!\n");
+      continue;
+    }
+
+    handle_gossip(*exp_pkt);
+  }
+}
+
+void mesh_node::handle_gossip(const packet& pkt) {
+  const auto exp_their_vc = vector_timestamp::deserialize_from_binary(
+    pkt.vstamp_buffer().data(), pkt.vstamp_buffer().size());
+
+  if (!exp_their_vc.has_value()) {
+    fprintf(stderr, "Mesh node didn't receive proper vector_timestamp!\n");
+    return;
+  }
+
+  ++gossip_received_;
+
+  const auto& payload = pkt.payload_buffer();
+  const auto received_us = now_us();
+  constexpr auto origin_byte_count = 2U * sizeof(uint64_t);
+
+  // The payload holds an actor_id and the time its entry was ticked for each
+  // entry whose origin the sender knows.
+  for (size_t offset = 0; offset + origin_byte_count <= payload.size();
+       offset += origin_byte_count) {
+    uint64_t aid_value;
+    uint64_t tick_us;
+    memcpy(&aid_value, payload.data() + offset, sizeof(aid_value));
+    memcpy(&tick_us, payload.data() + offset + sizeof(aid_value),
+           sizeof(tick_us));
+
+    const actor_id aid(ntoh(aid_value));
+    const auto& their_entries = exp_their_vc->entries();
+    const auto it = their_entries.find(aid);
+
+    if (aid == config_.aid || it == their_entries.end())
+      continue;
+
+    const clock_origin origin{it->second, ntoh(tick_us)};
+
+    // Only the first arrival of a value shows how long it took to propagate.
+    if (origin.clock > seen_clock(aid)) {
+      const auto latency_us = received_us > origin.tick_us
+                                ? received_us - origin.tick_us
+                                : 0U;
+      ++propagation_count_;
+      propagation_sum_us_ += latency_us;
+      propagation_max_us_ = std::max(propagation_max_us_, latency_us);
+    }
+
+    auto& pending_origin = pending_origins_[aid];
+
+    if (origin.clock > pending_origin.clock)
+      pending_origin = origin;
+  }
+
+  // Only collect here, the receive event happens once per batch.
+  if (pending_.has_value())
+    pending_->merge(*exp_their_vc);
+  else
+    pending_ = *exp_their_vc;
+
+  ++pending_count_;
+}
+
+void mesh_node::gossip() {
+  connect_to_peers();
+
+  std::vector<QTcpSocket*> connected;
+
+  for (auto& peer : peers_)
+    if (peer.socket->state() == QAbstractSocket::ConnectedState)
+      connected.push_back(peer.socket.get());
+
+  if (connected.empty())
+    return;
+
+  std::vector<QTcpSocket*> targets;
+  std::sample(connected.begin(), connected.end(), std::back_inserter(targets),
+              config_.fanout, random_engine_);
+
+  // Tick own clock (send event), once for all of the targets.
+  if (!tick()) {
+    fprintf(stderr, "Mesh node couldn't tick own clock for send event!\n");
+    return;
+  }
+
+  const auto own_vstamp_binary = vstamp_.serialize_to_binary();
+
+  std::vector<uint64_t> origins_binary;
+  origins_binary.reserve(2U * vstamp_.size());
+
+  for (const auto& [aid, clock] : vstamp_.entries()) {
+    const auto it = origins_.find(aid);
+
+    if (it == origins_.end() || it->second.clock != clock)
+      continue;
+
+    origins_binary.push_back(hton(aid.value()));
+    origins_binary.push_back(hton(it->second.tick_us));
+  }
+
+  const packet pkt(opcode::gossip, 0, own_vstamp_binary.data(),
+                   own_vstamp_binary.size(), origins_binary.data(),
+                   origins_binary.size() * sizeof(uint64_t));
+  const auto pkt_bin = pkt.serialize_to_binary();
+
+  VC_LOG_INFO(logger_, vstamp_, config_.aid,
+              "SEND Node gossiped to {} peers.", targets.size());
+
+  for (auto* target : targets) {
+    if (target->write(reinterpret_cast<const char*>(pkt_bin.data()),
+                      pkt_bin.size())
+        == -1) {
+      fprintf(stderr, "Mesh node couldn't send gossip to peer!\n");
+      continue;
+    }
+
+    bytes_sent_ += pkt_bin.size();
+    ++gossip_sent_;
+  }
+}
+
+void mesh_node::merge_pending() {
+  if (!pending_.has_value())
+    return;
+
+  // Tick own clock (receive event), once for the whole batch.
+  if (!tick()) {
+    fprintf(stderr, "Mesh node couldn't tick own clock for receive event!\n");
+    return;
+  }
+
+  for (const auto& [aid, origin] : pending_origins_) {
+    auto& known_origin = origins_[aid];
+
+    if (origin.clock > known_origin.clock)
+      known_origin = origin;
+  }
+
+  vstamp_.merge(*pending_);
+  ++batches_merged_;
+
+  VC_LOG_INFO(logger_, vstamp_, config_.aid,
+              "RECV Node merged {} gossip messages.", pending_count_);
+
+  pending_ = tl::nullopt;
+  pending_origins_.clear();
+  pending_count_ = 0;
+}
+
+void mesh_node::print_stats() {
+  const auto propagation_avg_us
+    = propagation_count_ == 0 ? 0.0
+                              : static_cast<double>(propagation_sum_us_)
+                                  / static_cast<double>(propagation_count_);
+
+  printf("%s: known_actors=%zu gossip_sent=%" PRIu64 " bytes_sent=%" PRIu64
+         " gossip_received=%" PRIu64 " bytes_received=%" PRIu64
+         " batches_merged=%" PRIu64 " propagations=%" PRIu64
+         " propagation_avg_us=%.1f propagation_max_us=%" PRIu64 "\n",
+         config_.aid.to_string().toStdString().c_str(), vstamp_.size(),
+         gossip_sent_, bytes_sent_, gossip_received_, bytes_received_,
+         batches_merged_, propagation_count_, propagation_avg_us,
+         propagation_max_us_);
+  fflush(stdout);
+}
+
+[[nodiscard]] bool mesh_node::tick() {
+  const auto own_clock = vstamp_.tick(config_.aid);
+
+  if (!own_clock.has_value())
+    return false;
+
+  origins_[config_.aid] = clock_origin{*own_clock, now_us()};
+  return true;
+}
+
+[[nodiscard]] uint64_t mesh_node::seen_clock(actor_id aid) const {
+  uint64_t clock = 0;
+  const auto& merged_entries = vstamp_.entries();
+
+  if (const auto it = merged_entries.find(aid); it != merged_entries.end())
+    clock = it->second;
+
+  if (pending_.has_value()) {
+    const auto& pending_entries = pending_->entries();
+
+    if (const auto it = pending_entries.find(aid);
+        it != pending_entries.end())
+      clock = std::max(clock, it->second);
+  }
+
+  return clock;
+}
+
+void mesh_node::connect_to_peers() {
+  for (auto& peer : peers_)
+    if (peer.socket->state() == QAbstractSocket::UnconnectedState)
+      // Looks host names up again on every attempt.
+      peer.socket->connectToHost(QString::fromStdString(peer.address.host),
+                                 peer.address.port);
+}
+} // namespace vc
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "metrics.hpp"
+
+namespace vc {
+namespace {
+/**
+ * The amount of uint64_t cells per cache line.
+ */
+constexpr size_t cells_per_cache_line = 64U / sizeof(uint64_t);
+
+/**
+ * Source of the shard indices assigned to the threads.
+ */
+std::atomic<size_t> next_shard_index{0};
+
+/**
+ * Writes the HELP and TYPE lines of a metric.
+ * @param out The buffer to append to.
+ * @param name The name of the metric.
+ * @param help The description of the metric.
+ * @param type The Prometheus type of the metric.
+ */
+void write_header(fmt::memory_buffer& out, const std::string& name,
+                  const std::string& help, const char* type) {
+  fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n",
+                 name, help, name, type);
+}
+
+/**
+ * Adds the labels of a series to the name of a metric.
+ * @param name The name of the metric.
+ * @param labels The labels of the series, may be empty.
+ * @return The name of the series, e.g. `name{actor_id="1"}`.
+ */
+std::string series_name(const std::string& name, const std::string& labels) {
+  return labels.empty() ? name : name + '{' + labels + '}';
+}
+} // namespace
+
+std::vector<uint64_t> exponential_buckets(uint64_t start, uint64_t factor,
+                                          size_t count) {
+  std::vector<uint64_t> result;
+  result.reserve(count);
+
+  for (auto bound = start; result.size() < count; bound *= factor)
+    result.push_back(bound);
+
+  return result;
+}
+
+size_t metric_shard_index() noexcept {
+  thread_local const size_t index = next_shard_index.fetch_add(
+                                      1U, std::memory_order_relaxed)
+                                    & (metric_shard_count - 1U);
+  return index;
+}
+
+counter::counter() noexcept : shards_() {
+  for (auto& s : shards_)
+    s.value.store(0, std::memory_order_relaxed);
+}
+
+uint64_t counter::value() const noexcept {
+  uint64_t result = 0;
+
+  for (const auto& s : shards_)
+    result += s.value.load(std::memory_order_relaxed);
+
+  return result;
+}
+
+gauge::gauge() noexcept : value_(0) {
+}
+
+int64_t gauge::value() const noexcept {
+  return value_.load(std::memory_order_relaxed);
+}
+
+histogram::histogram(std::vector<uint64_t> upper_bounds)
+  : upper_bounds_(std::move(upper_bounds)),
+    stride_((upper_bounds_.size() + 2U + cells_per_cache_line - 1U)
+            / cells_per_cache_line * cells_per_cache_line),
+    cells_(std::make_unique<std::atomic<uint64_t>[]>(metric_shard_count
+                                                     * stride_)) {
+  for (size_t i = 0; i < metric_shard_count * stride_; ++i)
+    cells_[i].store(0, std::memory_order_relaxed);
+}
+
+void histogram::observe(uint64_t value) noexcept {
+  const auto shard = metric_shard_index();
+  const auto bucket = static_cast<size_t>(
+    std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), value)
+    - upper_bounds_.begin());
+
+  cell(shard, bucket).fetch_add(1U, std::memory_order_relaxed);
+  cell(shard, upper_bounds_.size() + 1U)
+    .fetch_add(value, std::memory_order_relaxed);
+}
+
+const std::vector<uint64_t>& histogram::upper_bounds() const noexcept {
+  return upper_bounds_;
+}
+
+std::vector<uint64_t> histogram::cumulative_counts() const {
+  std::vector<uint64_t> result(upper_bounds_.size() + 1U, 0U);
+
+  for (size_t shard = 0; shard < metric_shard_count; ++shard)
+    for (size_t i = 0; i < result.size(); ++i)
+      result[i] += cell(shard, i).load(std::memory_order_relaxed);
+
+  for (size_t i = 1; i < result.size(); ++i)
+    result[i] += result[i - 1U];
+
+  return result;
+}
+
+uint64_t histogram::sum() const noexcept {
+  uint64_t result = 0;
+
+  for (size_t shard = 0; shard < metric_shard_count; ++shard)
+    result += cell(shard, upper_bounds_.size() + 1U)
+                .load(std::memory_order_relaxed);
+
+  return result;
+}
+
+std::atomic<uint64_t>& histogram::cell(size_t shard, size_t index) const
+  noexcept {
+  return cells_[shard * stride_ + index];
+}
+
+metrics_registry::metrics_registry() : mu_(), families_() {
+}
+
+metrics_registry& metrics_registry::global() {
+  static metrics_registry instance;
+  return instance;
+}
+
+template <class Metric, class... Args>
+Metric& metrics_registry::add(const std::string& name, const std::string& help,
+                              const std::string& labels, Args&&... args) {
+  std::lock_guard<std::mutex> lock_guard(mu_);
+  (void) lock_guard;
+
+  auto& f = families_[name];
+
+  if (f.series_by_labels.empty())
+    f.help = help;
+
+  auto& s = f.series_by_labels[labels];
+
+  // A series that was just inserted holds a null counter.
+  if (s.index() == 0 && std::get<0>(s) == nullptr)
+    s = std::make_unique<Metric>(std::forward<Args>(args)...);
+
+  return *std::get<std::unique_ptr<Metric>>(s);
+}
+
+counter& metrics_registry::add_counter(const std::string& name,
+                                       const std::string& help,
+                                       const std::string& labels) {
+  return add<counter>(name, help, labels);
+}
+
+gauge& metrics_registry::add_gauge(const std::string& name,
+                                   const std::string& help,
+                                   const std::string& labels) {
+  return add<gauge>(name, help, labels);
+}
+
+histogram& metrics_registry::add_histogram(const std::string& name,
+                                           const std::string& help,
+                                           std::vector<uint64_t> upper_bounds,
+                                           const std::string& labels) {
+  return add<histogram>(name, help, labels, std::move(upper_bounds));
+}
+
+std::string metrics_registry::to_prometheus() const {
+  fmt::memory_buffer out;
+
+  std::lock_guard<std::mutex> lock_guard(mu_);
+  (void) lock_guard;
+
+  for (const auto& [name, f] : families_) {
+    static constexpr const char* type_names[] = {"counter", "gauge",
+                                                 "histogram"};
+    write_header(out, name, f.help,
+                 type_names[f.series_by_labels.begin()->second.index()]);
+
+    for (const auto& [labels, s] : f.series_by_labels) {
+      if (const auto* c = std::get_if<std::unique_ptr<counter>>(&s)) {
+        fmt::format_to(std::back_inserter(out), "{} {}\n",
+                       series_name(name, labels), (*c)->value());
+      }
+      else if (const auto* g = std::get_if<std::unique_ptr<gauge>>(&s)) {
+        fmt::format_to(std::back_inserter(out), "{} {}\n",
+                       series_name(name, labels), (*g)->value());
+      }
+      else if (const auto* h = std::get_if<std::unique_ptr<histogram>>(&s)) {
+        const auto& bounds = (*h)->upper_bounds();
+        const auto counts = (*h)->cumulative_counts();
+        const auto label_prefix = labels.empty() ? labels : labels + ',';
+
+        for (size_t i = 0; i < bounds.size(); ++i)
+          fmt::format_to(std::back_inserter(out),
+                         "{}_bucket{{{}le=\"{}\"}} {}\n", name, label_prefix,
+                         bounds[i], counts[i]);
+
+        fmt::format_to(std::back_inserter(out),
+                       "{}_bucket{{{}le=\"+Inf\"}} {}\n{} {}\n{} {}\n", name,
+                       label_prefix, counts.back(),
+                       series_name(name + "_sum", labels), (*h)->sum(),
+                       series_name(name + "_count", labels), counts.back());
+      }
+    }
+  }
+
+  return fmt::to_string(out);
+}
+} // namespace vc
@@ -0,0 +1,75 @@
+#include "metrics_endpoint.hpp"
+
+namespace vc {
+namespace {
+/**
+ * The largest request header accepted, larger ones are answered with an
+ * error rather than buffered.
+ */
+constexpr qint64 max_request_byte_count = 8192;
+} // namespace
+
+metrics_endpoint::metrics_endpoint(const metrics_registry& registry,
+                                   QObject* parent)
+  : QObject(parent), registry_(registry), tcp_server_(PL_NO_PARENT) {
+  connect(&tcp_server_, &QTcpServer::newConnection, this,
+          &metrics_endpoint::on_new_connection);
+}
+
+[[nodiscard]] bool metrics_endpoint::listen(const QHostAddress& address,
+                                            quint16 port) {
+  return tcp_server_.listen(address, port);
+}
+
+void metrics_endpoint::on_new_connection() {
+  for (QTcpSocket* socket = nullptr;
+       (socket = tcp_server_.nextPendingConnection()) != nullptr;) {
+    connect(socket, &QIODevice::readyRead, this,
+            [this, socket] { on_ready_read(socket); });
+    connect(socket, &QAbstractSocket::disconnected, socket,
+            &QObject::deleteLater);
+  }
+}
+
+void metrics_endpoint::on_ready_read(QTcpSocket* socket) {
+  const auto buffered = socket->peek(max_request_byte_count);
+  const auto header_end = buffered.indexOf("\r\n\r\n");
+
+  if (header_end == -1) {
+    if (buffered.size() >= max_request_byte_count)
+      respond(socket, "431 Request Header Fields Too Large", QByteArray());
+
+    return;
+  }
+
+  const auto request_line = socket->readLine().trimmed().split(' ');
+  socket->readAll();
+
+  if (request_line.size() != 3 || request_line[0] != "GET") {
+    respond(socket, "405 Method Not Allowed", QByteArray());
+    return;
+  }
+
+  if (request_line[1] != "/metrics") {
+    respond(socket, "404 Not Found", QByteArray());
+    return;
+  }
+
+  respond(socket, "200 OK",
+          QByteArray::fromStdString(registry_.to_prometheus()));
+}
+
+void metrics_endpoint::respond(QTcpSocket* socket, const char* status,
+                               const QByteArray& body) {
+  QByteArray response("HTTP/1.0 ");
+  response += status;
+  response += "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+              "Content-Length: ";
+  response += QByteArray::number(body.size());
+  response += "\r\nConnection: close\r\n\r\n";
+  response += body;
+
+  socket->write(response);
+  socket->disconnectFromHost();
+}
+} // namespace vc
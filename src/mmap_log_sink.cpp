@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <utility>
+
+#include "mmap_log_sink.hpp"
+
+namespace vc {
+namespace {
+/**
+ * The header written to the beginning of every segment.
+ */
+const std::string& segment_header() {
+  static const std::string header = std::string(shiviz_regex) + "\n\n";
+  return header;
+}
+} // namespace
+
+tl::expected<std::unique_ptr<mmap_log_sink>, error>
+mmap_log_sink::create(mmap_log_options options) {
+  if (options.path.empty())
+    return VC_UNEXPECTED("The path of the log must not be empty.");
+
+  if (options.max_segment_count == 0)
+    return VC_UNEXPECTED("At least one log segment must be kept.");
+
+  std::unique_ptr<mmap_log_sink> sink(new mmap_log_sink(std::move(options)));
+
+  if (QFile::exists(QString::fromStdString(sink->options_.path))) {
+    const auto exp = sink->rotate();
+
+    if (!exp.has_value())
+      return tl::make_unexpected(exp.error());
+  }
+
+  const auto exp = sink->open_segment(0);
+
+  if (!exp.has_value())
+    return tl::make_unexpected(exp.error());
+
+  return sink;
+}
+
+mmap_log_sink::~mmap_log_sink() {
+  close_segment();
+}
+
+void mmap_log_sink::write(const log_record& record) {
+  if (has_failed_)
+    return;
+
+  auto line = to_shiviz(record);
+  line += '\n';
+
+  if (used_ + line.size() > capacity_) {
+    close_segment();
+
+    auto exp = rotate();
+
+    if (exp.has_value())
+      exp = open_segment(line.size());
+
+    if (!exp.has_value()) {
+      fprintf(stderr, "Dropping log entries: %s\n",
+              exp.error().message().c_str());
+      has_failed_ = true;
+      return;
+    }
+  }
+
+  append(line.data(), line.size());
+}
+
+void mmap_log_sink::flush() {
+}
+
+std::string mmap_log_sink::segment_path(const std::string& path,
+                                        size_t index) {
+  if (index == 0)
+    return path;
+
+  return path + '.' + std::to_string(index);
+}
+
+mmap_log_sink::mmap_log_sink(mmap_log_options options)
+  : options_(std::move(options)),
+    file_(),
+    data_(nullptr),
+    capacity_(0),
+    used_(0),
+    has_failed_(false) {
+}
+
+tl::expected<void, error> mmap_log_sink::open_segment(size_t min_byte_count) {
+  const auto& header = segment_header();
+  const auto capacity = std::max(options_.segment_byte_count,
+                                 header.size() + min_byte_count);
+
+  file_.setFileName(QString::fromStdString(options_.path));
+
+  if (!file_.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    return VC_UNEXPECTED("Couldn't open \"" + options_.path
+                         + "\": " + file_.errorString().toStdString());
+
+  if (!file_.resize(static_cast<qint64>(capacity))) {
+    file_.close();
+    return VC_UNEXPECTED("Couldn't preallocate \"" + options_.path
+                         + "\": " + file_.errorString().toStdString());
+  }
+
+  data_ = file_.map(0, static_cast<qint64>(capacity));
+
+  if (data_ == nullptr) {
+    file_.close();
+    return VC_UNEXPECTED("Couldn't map \"" + options_.path
+                         + "\": " + file_.errorString().toStdString());
+  }
+
+  capacity_ = capacity;
+  used_ = 0;
+  append(header.data(), header.size());
+  return {};
+}
+
+void mmap_log_sink::close_segment() {
+  if (data_ == nullptr)
+    return;
+
+  file_.unmap(data_);
+  data_ = nullptr;
+  file_.resize(static_cast<qint64>(used_));
+  file_.close();
+  capacity_ = 0;
+  used_ = 0;
+}
+
+tl::expected<void, error> mmap_log_sink::rotate() {
+  const auto oldest = QString::fromStdString(
+    segment_path(options_.path, options_.max_segment_count - 1));
+
+  if (QFile::exists(oldest) && !QFile::remove(oldest))
+    return VC_UNEXPECTED("Couldn't remove \"" + oldest.toStdString() + "\".");
+
+  for (auto index = options_.max_segment_count - 1; index > 0; --index) {
+    const auto from = QString::fromStdString(
+      segment_path(options_.path, index - 1));
+
+    if (!QFile::exists(from))
+      continue;
+
+    const auto to = QString::fromStdString(segment_path(options_.path, index));
+
+    if (!QFile::rename(from, to))
+      return VC_UNEXPECTED("Couldn't rename \"" + from.toStdString()
+                           + "\" to \"" + to.toStdString() + "\".");
+  }
+
+  return {};
+}
+
+void mmap_log_sink::append(const char* data, size_t byte_count) {
+  memcpy(data_ + used_, data, byte_count);
+  used_ += byte_count;
+}
+} // namespace vc
@@ -0,0 +1,26 @@
+#include <ostream>
+
+#include "opcode.hpp"
+
+namespace vc {
+std::ostream& operator<<(std::ostream& os, opcode op) {
+  switch (op) {
+    case opcode::time:
+      return os << "TIME";
+    case opcode::echo:
+      return os << "ECHO";
+    case opcode::clock_sync:
+      return os << "CLOCK_SYNC";
+    case opcode::subscribe:
+      return os << "SUBSCRIBE";
+    case opcode::unsubscribe:
+      return os << "UNSUBSCRIBE";
+    case opcode::gossip:
+      return os << "GOSSIP";
+    case opcode::hello:
+      return os << "HELLO";
+  }
+
+  return os << "UNKNOWN(" << static_cast<uint16_t>(op) << ')';
+}
+} // namespace vc
@@ -1,3 +1,5 @@
+#include <cassert>
+#include <cstddef>
 #include <cstring>
 
 #include "hton.hpp"
@@ -5,24 +7,47 @@
 #include "packet.hpp"
 
 namespace vc {
-packet::packet(const void* vstamp_data, size_t vstamp_byte_count,
-               const void* payload_data, size_t payload_byte_count)
-  : vstamp_buffer_(static_cast<const pl::byte*>(vstamp_data),
+packet::packet(opcode op, uint16_t flags, const void* vstamp_data,
+               size_t vstamp_byte_count, const void* payload_data,
+               size_t payload_byte_count, std::pmr::memory_resource* resource)
+  : op_(op),
+    flags_(flags),
+    vstamp_buffer_(static_cast<const pl::byte*>(vstamp_data),
                    static_cast<const pl::byte*>(vstamp_data)
-                     + vstamp_byte_count),
+                     + vstamp_byte_count,
+                   resource),
     payload_buffer_(static_cast<const pl::byte*>(payload_data),
                     static_cast<const pl::byte*>(payload_data)
-                      + payload_byte_count) {
+                      + payload_byte_count,
+                    resource),
+    trace_context_buffer_(resource) {
 }
 
-tl::expected<packet, error> packet::deserialize_from_binary(const void* data,
-                                                            size_t byte_count) {
-  constexpr auto minimum_byte_count = 2U * sizeof(uint64_t);
+tl::expected<packet, error>
+packet::deserialize_from_binary(const void* data, size_t byte_count,
+                                std::pmr::memory_resource* resource) {
+  constexpr auto minimum_byte_count = header_byte_count
+                                     + 2U * sizeof(uint64_t);
 
   if (byte_count < minimum_byte_count)
-    return VC_UNEXPECTED("Too few bytes were provided.");
+    return VC_UNEXPECTED_CODE(errc::too_few_bytes);
 
   const auto* p = static_cast<const pl::byte*>(data);
+  const auto* const end = p + byte_count;
+
+  // The amount of bytes left, compared against the sizes read so that a
+  // hostile size can neither overflow nor read out of bounds.
+  const auto remaining = [&p, end] { return static_cast<size_t>(end - p); };
+
+  uint16_t op;
+  memcpy(&op, p, sizeof(op));
+  p += sizeof(op);
+  op = ntoh(op);
+
+  uint16_t flags;
+  memcpy(&flags, p, sizeof(flags));
+  p += sizeof(flags);
+  flags = ntoh(flags);
 
   uint64_t vstamp_size;
   memcpy(&vstamp_size, p, sizeof(vstamp_size));
@@ -30,9 +55,13 @@ tl::expected<packet, error> packet::deserialize_from_binary(const void* data,
   vstamp_size = ntoh(vstamp_size);
 
   if (vstamp_size == 0)
-    return VC_UNEXPECTED("A vector timestamp may not be 0 bytes wide.");
+    return VC_UNEXPECTED_CODE(errc::empty_vstamp);
+
+  // The payload size has to follow the vector timestamp.
+  if (vstamp_size > remaining() - sizeof(uint64_t))
+    return VC_UNEXPECTED_CODE(errc::truncated_vstamp);
 
-  const std::vector<pl::byte> vstamp_buf(p, p + vstamp_size);
+  const auto* const vstamp_data = p;
   p += vstamp_size;
 
   uint64_t payload_size;
@@ -41,25 +70,90 @@ tl::expected<packet, error> packet::deserialize_from_binary(const void* data,
   payload_size = ntoh(payload_size);
 
   if (payload_size == 0)
-    return VC_UNEXPECTED("A payload may not be 0 bytes wide.");
+    return VC_UNEXPECTED_CODE(errc::empty_payload);
+
+  if (payload_size > remaining())
+    return VC_UNEXPECTED_CODE(errc::truncated_payload);
+
+  const auto* const payload_data = p;
+  p += payload_size;
+
+  if ((flags & trace_context_flag) == 0)
+    return packet(static_cast<opcode>(op), flags, vstamp_data, vstamp_size,
+                  payload_data, payload_size, resource);
+
+  if (remaining() < sizeof(uint16_t))
+    return VC_UNEXPECTED_CODE(errc::missing_trace_context_size);
 
-  const std::vector<pl::byte> payload_buf(p, p + payload_size);
+  uint16_t trace_context_size;
+  memcpy(&trace_context_size, p, sizeof(trace_context_size));
+  p += sizeof(trace_context_size);
+  trace_context_size = ntoh(trace_context_size);
 
-  return packet(vstamp_buf.data(), vstamp_buf.size(), payload_buf.data(),
-                payload_buf.size());
+  if (remaining() < trace_context_size)
+    return VC_UNEXPECTED_CODE(errc::truncated_trace_context);
+
+  packet pkt(static_cast<opcode>(op), flags, vstamp_data, vstamp_size,
+             payload_data, payload_size, resource);
+  pkt.set_trace_context(p, trace_context_size);
+  return pkt;
+}
+
+opcode packet::op() const noexcept {
+  return op_;
+}
+
+uint16_t packet::flags() const noexcept {
+  return flags_;
+}
+
+bool packet::is_response() const noexcept {
+  return (flags_ & response_flag) != 0;
 }
 
-const std::vector<pl::byte>& packet::vstamp_buffer() const noexcept {
+const std::pmr::vector<pl::byte>& packet::vstamp_buffer() const noexcept {
   return vstamp_buffer_;
 }
 
-const std::vector<pl::byte>& packet::payload_buffer() const noexcept {
+const std::pmr::vector<pl::byte>& packet::payload_buffer() const noexcept {
   return payload_buffer_;
 }
 
+byte_order packet::vstamp_byte_order() const noexcept {
+  return (flags_ & little_endian_vstamp_flag) != 0 ? byte_order::little_endian
+                                                   : byte_order::big_endian;
+}
+
+bool packet::has_trace_context() const noexcept {
+  return (flags_ & trace_context_flag) != 0;
+}
+
+const std::pmr::vector<pl::byte>& packet::trace_context_buffer() const
+  noexcept {
+  return trace_context_buffer_;
+}
+
+void packet::set_trace_context(const void* data, size_t byte_count) {
+  assert(byte_count <= max_trace_context_byte_count
+         && "The trace context is too large.");
+
+  const auto* const first = static_cast<const pl::byte*>(data);
+  trace_context_buffer_.assign(first, first + byte_count);
+  flags_ |= trace_context_flag;
+}
+
 std::vector<pl::byte> packet::serialize_to_binary() const {
-  std::vector<pl::byte> buffer(sizeof(uint64_t) + vstamp_buffer().size()
-                               + sizeof(uint64_t) + payload_buffer().size());
+  const auto trace_context_field_byte_count
+    = has_trace_context() ? sizeof(uint16_t) + trace_context_buffer().size()
+                          : 0U;
+
+  std::vector<pl::byte> buffer(header_byte_count + sizeof(uint64_t)
+                               + vstamp_buffer().size() + sizeof(uint64_t)
+                               + payload_buffer().size()
+                               + trace_context_field_byte_count);
+
+  const auto op = hton(static_cast<uint16_t>(op_));
+  const auto flags = hton(flags_);
 
   const auto vstamp_byte_count
     = hton(static_cast<uint64_t>(vstamp_buffer().size()));
@@ -69,6 +163,12 @@ std::vector<pl::byte> packet::serialize_to_binary() const {
 
   auto* pointer = buffer.data();
 
+  memcpy(pointer, &op, sizeof(op));
+  pointer += sizeof(op);
+
+  memcpy(pointer, &flags, sizeof(flags));
+  pointer += sizeof(flags);
+
   memcpy(pointer, &vstamp_byte_count, sizeof(vstamp_byte_count));
   pointer += sizeof(vstamp_byte_count);
 
@@ -79,6 +179,19 @@ std::vector<pl::byte> packet::serialize_to_binary() const {
   pointer += sizeof(payload_byte_count);
 
   memcpy(pointer, payload_buffer().data(), payload_buffer().size());
+  pointer += payload_buffer().size();
+
+  if (has_trace_context()) {
+    const auto trace_context_byte_count
+      = hton(static_cast<uint16_t>(trace_context_buffer().size()));
+
+    memcpy(pointer, &trace_context_byte_count,
+           sizeof(trace_context_byte_count));
+    pointer += sizeof(trace_context_byte_count);
+
+    memcpy(pointer, trace_context_buffer().data(),
+           trace_context_buffer().size());
+  }
 
   return buffer;
 }
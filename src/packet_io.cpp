@@ -0,0 +1,156 @@
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+#include <tl/optional.hpp>
+
+#include "ntoh.hpp"
+#include "packet_io.hpp"
+
+namespace vc {
+namespace {
+template <class Integer>
+tl::optional<Integer> peek_integer(QIODevice& device, uint64_t offset) {
+  const auto byte_count = qint64(offset + sizeof(Integer));
+
+  if (device.bytesAvailable() < byte_count)
+    return tl::nullopt;
+
+  const auto bytes = device.peek(byte_count);
+
+  Integer integer;
+  memcpy(&integer, bytes.constData() + offset, sizeof(integer));
+  return ntoh(integer);
+}
+
+template <class Integer>
+tl::expected<Integer, error> read_integer(QIODevice& device) {
+  Integer integer;
+
+  if (device.read(reinterpret_cast<char*>(&integer), sizeof(integer))
+      != qint64(sizeof(integer)))
+    return VC_UNEXPECTED_CODE(errc::read_failed);
+
+  return ntoh(integer);
+}
+
+tl::expected<std::pmr::vector<char>, error>
+read_bytes(QIODevice& device, uint64_t byte_count,
+           std::pmr::memory_resource* resource) {
+  std::pmr::vector<char> buffer(byte_count, resource);
+
+  if (device.read(buffer.data(), qint64(byte_count)) != qint64(byte_count))
+    return VC_UNEXPECTED_CODE(errc::read_failed);
+
+  return buffer;
+}
+} // namespace
+
+tl::expected<bool, error> has_complete_packet(QIODevice& device,
+                                              uint64_t max_byte_count) {
+  constexpr auto flags_offset = uint64_t(sizeof(uint16_t));
+  constexpr auto vstamp_size_offset = uint64_t(packet::header_byte_count);
+
+  // Every size is checked against the limit before it is added to an offset,
+  // so that no sum can overflow, whatever the peer sent.
+  const auto limit = std::min(max_byte_count, max_packet_byte_count);
+
+  const auto flags = peek_integer<uint16_t>(device, flags_offset);
+
+  if (!flags.has_value())
+    return false;
+
+  const auto vstamp_size = peek_integer<uint64_t>(device, vstamp_size_offset);
+
+  if (!vstamp_size.has_value())
+    return false;
+
+  if (*vstamp_size > limit)
+    return VC_UNEXPECTED_CODE(errc::vstamp_too_large);
+
+  const auto payload_size = peek_integer<uint64_t>(
+    device, vstamp_size_offset + sizeof(uint64_t) + *vstamp_size);
+
+  if (!payload_size.has_value())
+    return false;
+
+  if (*payload_size > limit)
+    return VC_UNEXPECTED_CODE(errc::payload_too_large);
+
+  auto packet_size = packet::header_byte_count + 2U * sizeof(uint64_t)
+                     + *vstamp_size + *payload_size;
+
+  if (packet_size > limit)
+    return VC_UNEXPECTED_CODE(errc::packet_too_large);
+
+  if ((*flags & packet::trace_context_flag) != 0) {
+    const auto trace_context_size = peek_integer<uint16_t>(device,
+                                                           packet_size);
+
+    if (!trace_context_size.has_value())
+      return false;
+
+    packet_size += sizeof(uint16_t) + *trace_context_size;
+
+    if (packet_size > limit)
+      return VC_UNEXPECTED_CODE(errc::packet_too_large);
+  }
+
+  return uint64_t(device.bytesAvailable()) >= packet_size;
+}
+
+tl::expected<packet, error> read_packet(QIODevice& device,
+                                        std::pmr::memory_resource* resource) {
+  const auto op = read_integer<uint16_t>(device);
+
+  if (!op.has_value())
+    return tl::make_unexpected(op.error());
+
+  const auto flags = read_integer<uint16_t>(device);
+
+  if (!flags.has_value())
+    return tl::make_unexpected(flags.error());
+
+  const auto vstamp_size = read_integer<uint64_t>(device);
+
+  if (!vstamp_size.has_value())
+    return tl::make_unexpected(vstamp_size.error());
+
+  const auto vstamp_buf = read_bytes(device, *vstamp_size, resource);
+
+  if (!vstamp_buf.has_value())
+    return tl::make_unexpected(vstamp_buf.error());
+
+  const auto payload_size = read_integer<uint64_t>(device);
+
+  if (!payload_size.has_value())
+    return tl::make_unexpected(payload_size.error());
+
+  const auto payload_buf = read_bytes(device, *payload_size, resource);
+
+  if (!payload_buf.has_value())
+    return tl::make_unexpected(payload_buf.error());
+
+  packet pkt(static_cast<opcode>(*op), *flags, vstamp_buf->data(),
+             vstamp_buf->size(), payload_buf->data(), payload_buf->size(),
+             resource);
+
+  if (!pkt.has_trace_context())
+    return pkt;
+
+  const auto trace_context_size = read_integer<uint16_t>(device);
+
+  if (!trace_context_size.has_value())
+    return tl::make_unexpected(trace_context_size.error());
+
+  const auto trace_context_buf = read_bytes(device, *trace_context_size,
+                                             resource);
+
+  if (!trace_context_buf.has_value())
+    return tl::make_unexpected(trace_context_buf.error());
+
+  pkt.set_trace_context(trace_context_buf->data(), trace_context_buf->size());
+  return pkt;
+}
+} // namespace vc
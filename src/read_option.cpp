@@ -0,0 +1,17 @@
+#include <cstdio>
+
+#include "read_option.hpp"
+
+namespace vc {
+bool read_option(const QCommandLineParser& parser,
+                 const QCommandLineOption& option, uint64_t& value) {
+  bool ok = false;
+  value = parser.value(option).toULongLong(&ok);
+
+  if (!ok)
+    fprintf(stderr, "Invalid value for --%s.\n",
+            option.names().front().toStdString().c_str());
+
+  return ok;
+}
+} // namespace vc
@@ -0,0 +1,22 @@
+#include <QHostInfo>
+#include <QString>
+
+#include "resolve_host.hpp"
+
+namespace vc {
+tl::expected<QHostAddress, error> resolve_host(const std::string& host) {
+  const auto name = QString::fromStdString(host);
+  QHostAddress address;
+
+  if (address.setAddress(name))
+    return address;
+
+  const auto info = QHostInfo::fromName(name);
+
+  if (info.error() != QHostInfo::NoError || info.addresses().isEmpty())
+    return VC_UNEXPECTED("Couldn't resolve host \"" + host
+                         + "\": " + info.errorString().toStdString());
+
+  return info.addresses().front();
+}
+} // namespace vc
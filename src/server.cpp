@@ -1,38 +1,147 @@
 #include <cstdint>
 #include <cstdio>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
 
 #include <QTime>
 
-#include <pl/algo/ranged_algorithms.hpp>
-
-#include "ntoh.hpp"
+#include "packet_io.hpp"
 #include "server.hpp"
+#include "metrics.hpp"
 #include "server_port.hpp"
+#include "trace_context.hpp"
+#include "trace_sampler.hpp"
 
 namespace vc {
-server::server(actor_id aid, logger& l, QObject* parent)
+namespace {
+/**
+ * The maximum amount of bytes that shall be buffered inside of a client socket.
+ * Frames beyond that are kept in the connection's write_queue.
+ */
+constexpr qint64 socket_write_buffer_limit = 64 * 1024;
+
+/**
+ * The metrics updated by all of the servers.
+ */
+struct server_metrics {
+  metrics_registry& registry = metrics_registry::global();
+  counter& requests = registry.add_counter(
+    "vc_server_requests_total", "Requests read from clients.");
+  counter& received_bytes = registry.add_counter(
+    "vc_server_received_bytes_total", "Bytes of the requests read.");
+  counter& sent_bytes = registry.add_counter(
+    "vc_server_sent_bytes_total", "Bytes handed to client sockets.");
+  counter& decode_failures = registry.add_counter(
+    "vc_server_decode_failures_total",
+    "Requests whose packet or vector timestamp couldn't be decoded.");
+  histogram& merged_clock_entries = registry.add_histogram(
+    "vc_server_merged_clock_entries",
+    "Entries of the vector timestamps received and merged.",
+    exponential_buckets(1, 2, 12));
+  gauge& pending_write_bytes = registry.add_gauge(
+    "vc_server_pending_write_bytes",
+    "Bytes queued for clients that haven't been written yet.");
+};
+
+server_metrics& metrics() {
+  static server_metrics instance;
+  return instance;
+}
+
+/**
+ * The size of the memory that requests are handled in, requests that need
+ * more memory fall back to the heap.
+ */
+constexpr size_t request_arena_byte_count = 64U * 1024U;
+
+/**
+ * Determines the flags of a response.
+ * @param order The byte order of the response's vector timestamp.
+ * @return The flags.
+ */
+uint16_t response_flags(byte_order order) noexcept {
+  return order == byte_order::little_endian
+           ? packet::response_flag | packet::little_endian_vstamp_flag
+           : packet::response_flag;
+}
+} // namespace
+
+server::server(actor_id aid, logger& l, watermarks limits, QObject* parent)
   : QObject(parent),
     aid_(aid),
     logger_(l),
     is_listening_(false),
     tcp_server_(PL_NO_PARENT),
     clients_(),
-    vstamp_(aid_) {
+    vstamp_(aid_),
+    clock_entries_(metrics_registry::global().add_gauge(
+      "vc_server_clock_entries", "Entries of the server's vector timestamp.",
+      "actor_id=\"" + std::to_string(aid_.value()) + '"')),
+    limits_(limits),
+    write_queues_(),
+    byte_orders_(),
+    pause_count_(0),
+    handlers_(),
+    subscribers_(),
+    publish_timer_(PL_NO_PARENT),
+    skipped_publication_count_(0),
+    request_arena_buffer_(
+      std::make_unique<std::byte[]>(request_arena_byte_count)),
+    request_arena_(request_arena_buffer_.get(), request_arena_byte_count),
+    clock_(aid_, vstamp_, &request_arena_) {
   setup_connections();
+  set_publish_interval(default_publish_interval);
+
+  register_handler(opcode::time,
+                   [this](QTcpSocket* socket, const packet& request,
+                          opentracing::Span* span) {
+                     handle_time_request(socket, request, span);
+                   });
+
+  for (const auto op : {opcode::echo, opcode::clock_sync})
+    register_handler(op, [this](QTcpSocket* socket, const packet& request,
+                                opentracing::Span* span) {
+      handle_stateless_request(socket, request, span);
+    });
+
+  register_handler(opcode::subscribe,
+                   [this](QTcpSocket* socket, const packet& request,
+                          opentracing::Span* span) {
+                     handle_subscribe_request(socket, request, span);
+                   });
+  register_handler(opcode::unsubscribe,
+                   [this](QTcpSocket* socket, const packet& request,
+                          opentracing::Span* span) {
+                     handle_unsubscribe_request(socket, request, span);
+                   });
+  register_handler(opcode::hello,
+                   [this](QTcpSocket* socket, const packet& request,
+                          opentracing::Span* span) {
+                     handle_hello_request(socket, request, span);
+                   });
 }
 
 server::~server() {
   if (is_listening_)
     tcp_server_.close();
 
-  // Free the memory occupied by the TCP sockets for the clients.
-  for (auto* client : clients_)
+  // Free the memory occupied by the TCP sockets for the clients. Deleting a
+  // connected socket emits disconnected, which mustn't modify clients_ while
+  // it is iterated over.
+  for (auto* client : clients_) {
+    QObject::disconnect(client, nullptr, this, nullptr);
     delete client;
+  }
 }
 
 [[nodiscard]] bool server::listen() {
-  const auto ret_val = tcp_server_.listen(QHostAddress("127.0.0.1"),
-                                          server_port);
+  return listen(QHostAddress("127.0.0.1"), server_port);
+}
+
+[[nodiscard]] bool server::listen(const QHostAddress& address, quint16 port) {
+  const auto ret_val = tcp_server_.listen(address, port);
 
   if (ret_val)
     is_listening_ = true;
@@ -40,22 +149,54 @@ server::~server() {
   return ret_val;
 }
 
+[[nodiscard]] quint16 server::port() const {
+  return tcp_server_.serverPort();
+}
+
+void server::register_handler(opcode op, request_handler handler) {
+  handlers_[op] = std::move(handler);
+}
+
+void server::set_publish_interval(std::chrono::milliseconds interval) {
+  publish_timer_.setInterval(static_cast<int>(interval.count()));
+}
+
+[[nodiscard]] uint64_t server::skipped_publication_count() const noexcept {
+  return skipped_publication_count_;
+}
+
+[[nodiscard]] uint64_t server::pause_count() const noexcept {
+  return pause_count_;
+}
+
 void server::setup_connections() {
   connect(&tcp_server_, &QTcpServer::newConnection, this,
           &server::on_new_connection);
+  connect(&publish_timer_, &QTimer::timeout, this, &server::publish);
 }
 
 void server::on_new_connection() {
   for (QTcpSocket* current_client = nullptr;
        (current_client = tcp_server_.nextPendingConnection()) != nullptr;) {
     clients_.push_back(current_client);
+    write_queues_.emplace(current_client, write_queue(limits_));
+    byte_orders_.emplace(current_client, byte_order::big_endian);
+
+    // Bound the socket's read buffer, so that a paused connection pushes back
+    // on the client by means of TCP flow control.
+    current_client->setReadBufferSize(static_cast<qint64>(limits_.high));
+
     connect(current_client, &QIODevice::readyRead, this,
             &server::on_client_ready_read);
+    connect(current_client, &QIODevice::bytesWritten, this,
+            &server::on_client_bytes_written);
+    connect(current_client, &QAbstractSocket::disconnected, this,
+            &server::on_client_disconnected);
   }
 }
 
 void server::on_client_ready_read() {
-  auto span = opentracing::Tracer::Global()->StartSpan("server: on_ready_read");
+  auto span = start_sampled_span("server: on_ready_read");
 
   auto* the_sender = sender();
 
@@ -67,116 +208,392 @@ void server::on_client_ready_read() {
   if (client == nullptr)
     return;
 
-  handle_client_request(client, *span);
+  process_client_requests(client, span.get());
+}
+
+void server::on_client_disconnected() {
+  auto* client = qobject_cast<QTcpSocket*>(sender());
+
+  if (client == nullptr)
+    return;
+
+  const auto erase = [client](std::vector<QTcpSocket*>& sockets) {
+    sockets.erase(std::remove(sockets.begin(), sockets.end(), client),
+                  sockets.end());
+  };
+
+  erase(clients_);
+  erase(subscribers_);
+
+  if (const auto it = write_queues_.find(client); it != write_queues_.end()) {
+    metrics().pending_write_bytes.add(
+      -static_cast<int64_t>(it->second.pending_byte_count()));
+    write_queues_.erase(it);
+  }
+
+  byte_orders_.erase(client);
+
+  if (subscribers_.empty())
+    publish_timer_.stop();
+
+  client->deleteLater();
+}
+
+void server::on_client_bytes_written(qint64 byte_count) {
+  auto* client = qobject_cast<QTcpSocket*>(sender());
+
+  if (client == nullptr)
+    return;
+
+  auto& queue = write_queues_.at(client);
+  const auto pending_byte_count = queue.pending_byte_count();
+  const auto transition = queue.acknowledge(static_cast<size_t>(byte_count));
+
+  metrics().pending_write_bytes.add(
+    static_cast<int64_t>(queue.pending_byte_count())
+    - static_cast<int64_t>(pending_byte_count));
+
+  if (transition == write_queue::transition::resumed) {
+    emit connection_resumed(client, queue.pending_byte_count());
+
+    // Requests that arrived while paused are still buffered in the socket
+    // and won't cause another readyRead signal.
+    auto span = start_sampled_span("server: on_client_bytes_written");
+
+    // The queue is gone if the client was aborted.
+    if (!process_client_requests(client, span.get()))
+      return;
+  }
+
+  flush(client);
+}
+
+bool server::process_client_requests(QTcpSocket* socket,
+                                     const opentracing::Span* parent_span) {
+  const auto& queue = write_queues_.at(socket);
+
+  while (!queue.is_paused()) {
+    // A request that doesn't fit into the socket's read buffer could never be
+    // completed.
+    const auto exp_complete = has_complete_packet(
+      *socket, uint64_t(socket->readBufferSize()));
+
+    if (!exp_complete.has_value()) {
+      metrics().decode_failures.add();
+      fprintf(stderr, "Server received an oversized request from client!\n");
+      socket->abort();
+      return false;
+    }
+
+    if (!*exp_complete)
+      return true;
+
+    handle_client_request(socket, parent_span);
+
+    // Nothing allocated from the arena outlives the request.
+    request_arena_.release();
+  }
+
+  return true;
 }
 
 tl::expected<packet, error>
 server::read_client_request(QTcpSocket* socket,
-                            const opentracing::Span& parent_span) {
-  auto span = opentracing::Tracer::Global()->StartSpan(
-    "server: read_client_request",
-    {opentracing::ChildOf(&parent_span.context())});
+                            const opentracing::Span* parent_span,
+                            std::pmr::memory_resource* resource) {
+  auto span = start_child_span("server: read_client_request", parent_span);
 
-  uint64_t vstamp_size;
-  if (socket->read(reinterpret_cast<char*>(&vstamp_size), sizeof(vstamp_size))
-      == -1)
-    return VC_UNEXPECTED("Couldn't read vstamp_size from TCP socket.");
-  vstamp_size = ntoh(vstamp_size);
+  const auto available_byte_count = socket->bytesAvailable();
+  auto exp_pkt = read_packet(*socket, resource);
+  auto& m = metrics();
 
-  std::vector<char> vstamp_buf(vstamp_size);
-  if (socket->read(vstamp_buf.data(), vstamp_size) == -1)
-    return VC_UNEXPECTED("Couldn't read vstamp_buf from TCP socket.");
+  m.received_bytes.add(
+    static_cast<uint64_t>(available_byte_count - socket->bytesAvailable()));
 
-  uint64_t payload_size;
-  if (socket->read(reinterpret_cast<char*>(&payload_size), sizeof(payload_size))
-      == -1)
-    return VC_UNEXPECTED("Couldn't read payload_size from TCP socket.");
-  payload_size = ntoh(payload_size);
+  if (exp_pkt.has_value())
+    m.requests.add();
+  else
+    m.decode_failures.add();
 
-  std::vector<char> payload_buf(payload_size);
-  if (socket->read(payload_buf.data(), payload_size) == -1)
-    return VC_UNEXPECTED("Couldn't read payload_buf from TCP socket.");
-
-  return packet(vstamp_buf.data(), vstamp_size, payload_buf.data(),
-                payload_size);
+  return exp_pkt;
 }
 
 void server::handle_client_request(QTcpSocket* socket,
-                                   const opentracing::Span& parent_span) {
-  auto span = opentracing::Tracer::Global()->StartSpan(
-    "server: handle_client_request",
-    {opentracing::ChildOf(&parent_span.context())});
+                                   const opentracing::Span* parent_span) {
+  const auto exp_pkt = read_client_request(socket, parent_span,
+                                           &request_arena_);
+
+  if (!exp_pkt.has_value()) {
+    fprintf(stderr, "Server couldn't read packet from client!\n");
+    return;
+  }
+
+  const auto& pkt = *exp_pkt;
+
+  if (pkt.is_response()) {
+    fprintf(stderr, "Server received a response instead of a request from "
+                    "client!\n");
+    return;
+  }
+
+  // Continue the client's trace if the request carries its span context.
+  const auto exp_client_context = extract_trace_context(pkt);
+
+  if (!exp_client_context.has_value())
+    fprintf(stderr, "Server ignores trace context of client: %s\n",
+            exp_client_context.error().message().c_str());
+
+  const auto* client_context = exp_client_context.has_value()
+                                 ? exp_client_context->get()
+                                 : nullptr;
+
+  constexpr auto span_name = "server: handle_client_request";
+  std::unique_ptr<opentracing::Span> span;
+
+  // The client already made the sampling decision for its trace, so its
+  // requests are traced even if the local sampler skipped this batch.
+  if (client_context != nullptr && parent_span != nullptr)
+    span = opentracing::Tracer::Global()->StartSpan(
+      span_name, {opentracing::ChildOf(client_context),
+                  opentracing::FollowsFrom(&parent_span->context())});
+  else if (client_context != nullptr)
+    span = opentracing::Tracer::Global()->StartSpan(
+      span_name, {opentracing::ChildOf(client_context)});
+  else
+    span = start_child_span(span_name, parent_span);
+
+  const auto it = handlers_.find(pkt.op());
+
+  if (it == handlers_.end()) {
+    fprintf(stderr, "Server received unexpected opcode %u from client!\n",
+            static_cast<unsigned>(pkt.op()));
+    return;
+  }
 
-  const auto exp_pkt = read_client_request(socket, *span);
+  it->second(socket, pkt, span.get());
+}
 
-  if (exp_pkt.has_value()) {
-    const auto pkt = *exp_pkt;
+void server::handle_time_request(QTcpSocket* socket, const packet& request,
+                                 opentracing::Span* span) {
+  if (!receive(request))
+    return;
 
-    // The payload that the client is expected to send.
-    constexpr char give_time_msg[] = "GIEVTIMEPLX";
+  const auto response_payload
+    = QTime::currentTime().toString(Qt::DateFormat::RFC2822Date).toUtf8();
 
-    if (pl::algo::equal(pkt.payload_buffer(), give_time_msg)) {
-      const auto exp_their_vc = vector_timestamp::deserialize_from_binary(
-        pkt.vstamp_buffer().data(), pkt.vstamp_buffer().size());
+  if (!respond(socket, opcode::time, response_payload.data(),
+               response_payload.size()))
+    return;
 
-      if (!exp_their_vc.has_value()) {
-        fprintf(stderr, "Server didn't receive proper vector_timestamp!\n");
-        return;
-      }
+  if (span != nullptr)
+    span->SetTag("Response", response_payload.toStdString());
+}
 
-      // Get the sending client's vector clock.
-      const auto their_vc = *exp_their_vc;
+void server::handle_stateless_request(QTcpSocket* socket,
+                                      const packet& request,
+                                      opentracing::Span* span) {
+  if (!receive(request))
+    return;
 
-      // Tick own clock (receive event)
-      if (!vstamp_.tick(aid_).has_value()) {
-        fprintf(stderr, "Server couldn't tick own clock for receive event!\n");
-        return;
-      }
+  if (!clock_.answer(request, byte_orders_.at(socket), sent_entries::all,
+                     response_sink(socket)))
+    fprintf(stderr, "Server couldn't answer request: it's neither an echo "
+                    "nor a clock_sync request or the own clock couldn't be "
+                    "ticked!\n");
+}
 
-      // Merge it
-      vstamp_.merge(their_vc);
+void server::handle_subscribe_request(QTcpSocket* socket,
+                                      const packet& request,
+                                      opentracing::Span* span) {
+  if (!receive(request))
+    return;
 
-      VC_LOG_INFO(logger_, vstamp_, aid_, "RECV Server received \"{}\".",
-                  give_time_msg);
+  if (std::find(subscribers_.begin(), subscribers_.end(), socket)
+      == subscribers_.end())
+    subscribers_.push_back(socket);
 
-      // Tick own clock (send event)
-      if (!vstamp_.tick(aid_).has_value()) {
-        fprintf(stderr, "Server couldn't tick own clock for send event!\n");
-        return;
-      }
+  if (!publish_timer_.isActive())
+    publish_timer_.start();
 
-      const auto own_vstamp_binary = vstamp_.serialize_to_binary();
-      const auto response_payload
-        = QTime::currentTime().toString(Qt::DateFormat::RFC2822Date).toUtf8();
+  // Respond right away, rather than making the client wait for the next
+  // publication.
+  const auto response_payload
+    = QTime::currentTime().toString(Qt::DateFormat::RFC2822Date).toUtf8();
 
-      const packet response_packet(own_vstamp_binary.data(),
-                                   own_vstamp_binary.size(),
-                                   response_payload.data(),
-                                   response_payload.size());
+  if (!respond(socket, opcode::subscribe, response_payload.data(),
+               response_payload.size()))
+    return;
 
-      const auto response_packet_binary = response_packet.serialize_to_binary();
+  if (span != nullptr)
+    span->SetTag("Subscribers", static_cast<uint64_t>(subscribers_.size()));
+}
+
+void server::handle_unsubscribe_request(QTcpSocket* socket,
+                                        const packet& request,
+                                        opentracing::Span* span) {
+  if (!receive(request))
+    return;
+
+  subscribers_.erase(
+    std::remove(subscribers_.begin(), subscribers_.end(), socket),
+    subscribers_.end());
+
+  if (subscribers_.empty())
+    publish_timer_.stop();
+
+  constexpr char ack[] = "ACK";
+  (void) respond(socket, opcode::unsubscribe, ack, sizeof(ack));
+}
+
+void server::handle_hello_request(QTcpSocket* socket, const packet& request,
+                                  opentracing::Span* span) {
+  if (!receive(request))
+    return;
 
-      VC_LOG_INFO(logger_, vstamp_, aid_, "SENT Server sent \"{}\".",
-                  response_payload.toStdString());
+  const auto& offer = request.payload_buffer();
+  const auto order = negotiate_byte_order(
+    offer.empty() ? 0U : static_cast<uint8_t>(offer.front()));
+  const auto response_payload = static_cast<uint8_t>(order);
 
-      // Send the response to the client.
-      if (socket->write(
-            reinterpret_cast<const char*>(response_packet_binary.data()),
-            response_packet_binary.size())
-          == -1) {
-        fprintf(stderr, "Server couldn't write response to client!\n");
-        return;
-      }
+  // The response itself still uses the previous byte order.
+  if (!respond(socket, opcode::hello, &response_payload,
+               sizeof(response_payload)))
+    return;
+
+  byte_orders_.at(socket) = order;
+
+  if (span != nullptr)
+    span->SetTag("LittleEndian", order == byte_order::little_endian);
+}
+
+void server::publish() {
+  if (subscribers_.empty()) {
+    publish_timer_.stop();
+    return;
+  }
+
+  auto span = start_sampled_span("server: publish");
+
+  // Tick own clock (send event), once for all of the subscribers.
+  if (!vstamp_.tick(aid_).has_value()) {
+    fprintf(stderr, "Server couldn't tick own clock for publish event!\n");
+    return;
+  }
+
+  const auto payload
+    = QTime::currentTime().toString(Qt::DateFormat::RFC2822Date).toUtf8();
+
+  // The packet is encoded at most once per byte order, for all of the
+  // subscribers that negotiated it.
+  write_queue::frame frames[2];
+
+  const auto frame_for = [this, &frames, &payload](byte_order order) {
+    auto& frame = frames[order == byte_order::big_endian ? 0 : 1];
+
+    if (frame == nullptr) {
+      const auto own_vstamp_binary = vstamp_.serialize_to_binary(order);
+      const packet publication(opcode::subscribe, response_flags(order),
+                               own_vstamp_binary.data(),
+                               own_vstamp_binary.size(), payload.data(),
+                               payload.size());
+      frame = std::make_shared<const std::vector<pl::byte>>(
+        publication.serialize_to_binary());
+    }
 
-      span->SetTag("Response", response_payload.toStdString());
+    return frame;
+  };
 
-    } else {
-      fprintf(stderr, "Server received unexpected payload from client!\n");
+  VC_LOG_INFO(logger_, vstamp_, aid_,
+              "SENT Server published \"{}\" to {} subscribers.",
+              payload.toStdString(), subscribers_.size());
+
+  for (auto* subscriber : subscribers_) {
+    // Don't let a slow subscriber accumulate publications, it will get the
+    // next one once its connection has drained.
+    if (write_queues_.at(subscriber).is_paused()) {
+      ++skipped_publication_count_;
+      continue;
+    }
+
+    enqueue(subscriber, frame_for(byte_orders_.at(subscriber)));
+  }
+
+  if (span != nullptr)
+    span->SetTag("Subscribers", static_cast<uint64_t>(subscribers_.size()));
+}
+
+[[nodiscard]] bool server::receive(const packet& request) {
+  const auto exp_merged_entries = clock_.receive(request);
+
+  if (!exp_merged_entries.has_value()) {
+    metrics().decode_failures.add();
+    fprintf(stderr, "Server didn't receive proper vector_timestamp: %s\n",
+            exp_merged_entries.error().message().c_str());
+    return false;
+  }
+
+  metrics().merged_clock_entries.observe(*exp_merged_entries);
+  clock_entries_.set(static_cast<int64_t>(vstamp_.size()));
+
+  VC_LOG_INFO(logger_, vstamp_, aid_, "RECV Server received {} request.",
+              request.op());
+
+  return true;
+}
+
+[[nodiscard]] bool server::respond(QTcpSocket* socket, opcode op,
+                                   const void* payload_data,
+                                   size_t payload_byte_count) {
+  if (!clock_.send(op, packet::response_flag, byte_orders_.at(socket),
+                   sent_entries::all, payload_data, payload_byte_count,
+                   response_sink(socket))) {
+    fprintf(stderr, "Server couldn't tick own clock for send event!\n");
+    return false;
+  }
+
+  return true;
+}
+
+[[nodiscard]] packet_sink server::response_sink(QTcpSocket* socket) {
+  return [this, socket](const packet& response) {
+    VC_LOG_INFO(logger_, vstamp_, aid_, "SENT Server sent {} response.",
+                response.op());
+
+    // Send the response to the client.
+    enqueue(socket, std::make_shared<const std::vector<pl::byte>>(
+                      response.serialize_to_binary()));
+  };
+}
+
+void server::enqueue(QTcpSocket* socket, write_queue::frame frame) {
+  auto& queue = write_queues_.at(socket);
+
+  metrics().pending_write_bytes.add(static_cast<int64_t>(frame->size()));
+
+  if (queue.push(std::move(frame)) == write_queue::transition::paused) {
+    ++pause_count_;
+    emit connection_paused(socket, queue.pending_byte_count());
+  }
+
+  flush(socket);
+}
+
+void server::flush(QTcpSocket* socket) {
+  auto& queue = write_queues_.at(socket);
+
+  while (!queue.empty()
+         && socket->bytesToWrite() < socket_write_buffer_limit) {
+    const auto& frame = queue.front();
+
+    if (socket->write(reinterpret_cast<const char*>(frame.data()),
+                      frame.size())
+        == -1) {
+      fprintf(stderr, "Server couldn't write response to client!\n");
       return;
     }
-  } else {
-    fprintf(stderr, "Server couldn't read packet from client!\n");
-    return;
+
+    metrics().sent_bytes.add(frame.size());
+    queue.pop();
   }
 }
 } // namespace vc
@@ -1,10 +1,36 @@
+#include <cstdio>
+
+#include <string>
+
 #include <yaml-cpp/yaml.h>
 
 #include <jaegertracing/Tracer.h>
 
 #include "setup_tracer.hpp"
+#include "trace_sampler.hpp"
 
 namespace vc {
+namespace {
+void setup_span_sampler(const YAML::Node& config_yaml) {
+  const auto sampler_yaml = config_yaml["span_sampler"];
+
+  if (!sampler_yaml)
+    return;
+
+  const auto exp_config = parse_sampler_config(
+    sampler_yaml["type"].as<std::string>("const"),
+    sampler_yaml["param"].as<double>(1.0));
+
+  if (!exp_config.has_value()) {
+    fprintf(stderr, "Ignoring span_sampler: %s\n",
+            exp_config.error().message().c_str());
+    return;
+  }
+
+  trace_sampler::init_global(*exp_config);
+}
+} // namespace
+
 void setup_tracer(pl::string_view config_filepath) {
   auto config_yaml = YAML::LoadFile(config_filepath.to_string());
   auto config = jaegertracing::Config::parse(config_yaml);
@@ -13,5 +39,6 @@ void setup_tracer(pl::string_view config_filepath) {
 
   opentracing::Tracer::InitGlobal(
     std::static_pointer_cast<opentracing::Tracer>(tracer));
+  setup_span_sampler(config_yaml);
 }
 } // namespace vc
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <utility>
+
+#include "simulator.hpp"
+
+namespace vc {
+namespace {
+/**
+ * The size of the memory that events are processed in. Large enough for the
+ * packets and vector timestamps of some thousand actors, larger ones fall
+ * back to the heap.
+ */
+constexpr size_t arena_byte_count = 1024U * 1024U;
+
+/**
+ * Mixes a 64 bit word into an FNV-1a hash.
+ * @param hash The hash so far.
+ * @param word The word to mix in.
+ * @return The resulting hash.
+ */
+uint64_t fnv1a(uint64_t hash, uint64_t word) noexcept {
+  constexpr uint64_t prime = 0x100000001B3ULL;
+
+  for (unsigned i = 0; i < sizeof(word); ++i) {
+    hash ^= (word >> (i * 8U)) & 0xFFU;
+    hash *= prime;
+  }
+
+  return hash;
+}
+} // namespace
+
+simulator::simulator(sim_options options)
+  : options_(std::move(options)),
+    random_engine_(options_.seed),
+    vstamps_(),
+    clocks_(),
+    payload_(std::max<size_t>(options_.payload_byte_count, 1),
+             pl::byte{0x2A}),
+    events_(),
+    next_sequence_(0),
+    now_(0),
+    stats_(),
+    clock_samples_(),
+    arena_buffer_(std::make_unique<std::byte[]>(arena_byte_count)),
+    arena_(arena_buffer_.get(), arena_byte_count) {
+  options_.server_count = std::max<size_t>(options_.server_count, 1);
+
+  vstamps_.reserve(actor_count());
+
+  for (size_t i = 0; i < actor_count(); ++i)
+    vstamps_.emplace_back(actor_id(i + 1));
+
+  // vstamps_ doesn't grow any more, so that the clocks may refer to it.
+  clocks_.reserve(actor_count());
+
+  for (size_t i = 0; i < actor_count(); ++i)
+    clocks_.emplace_back(actor_id(i + 1), vstamps_[i], &arena_);
+
+  // Spread the first requests across the first interval, so that the clients
+  // don't all send at once.
+  for (size_t i = options_.server_count; i < actor_count(); ++i)
+    schedule(event{next_duration(sim_time(0), options_.request_interval), 0,
+                   event_kind::request_due, i, i, {}});
+
+  if (options_.sample_interval.count() > 0)
+    schedule(event{sim_time(0), 0, event_kind::sample, 0, 0, {}});
+}
+
+void simulator::run_until(sim_time end) {
+  while (!events_.empty() && events_.front().at <= end) {
+    std::pop_heap(events_.begin(), events_.end(), later());
+    auto e = std::move(events_.back());
+    events_.pop_back();
+
+    now_ = e.at;
+    ++stats_.event_count;
+    process(e);
+
+    // Whatever the event decoded or encoded is gone by now.
+    arena_.release();
+  }
+
+  now_ = std::max(now_, end);
+}
+
+[[nodiscard]] sim_time simulator::now() const noexcept {
+  return now_;
+}
+
+[[nodiscard]] const sim_stats& simulator::stats() const noexcept {
+  return stats_;
+}
+
+[[nodiscard]] const std::vector<clock_sample>&
+simulator::clock_samples() const noexcept {
+  return clock_samples_;
+}
+
+[[nodiscard]] size_t simulator::actor_count() const noexcept {
+  return options_.server_count + options_.client_count;
+}
+
+[[nodiscard]] const vector_timestamp&
+simulator::vstamp_of(size_t index) const {
+  return vstamps_.at(index);
+}
+
+[[nodiscard]] uint64_t simulator::fingerprint() const {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  std::vector<std::pair<uint64_t, uint64_t>> entries;
+
+  for (const auto& vstamp : vstamps_) {
+    entries.clear();
+
+    for (const auto& [aid, clock] : vstamp.entries())
+      entries.emplace_back(aid.value(), clock);
+
+    // The order of the entries of an unordered_map is unspecified.
+    std::sort(entries.begin(), entries.end());
+    hash = fnv1a(hash, entries.size());
+
+    for (const auto& [aid, clock] : entries)
+      hash = fnv1a(fnv1a(hash, aid), clock);
+  }
+
+  return hash;
+}
+
+bool simulator::later::operator()(const event& lhs, const event& rhs) const
+  noexcept {
+  return lhs.at != rhs.at ? lhs.at > rhs.at : lhs.sequence > rhs.sequence;
+}
+
+void simulator::schedule(event e) {
+  e.sequence = next_sequence_++;
+  events_.push_back(std::move(e));
+  std::push_heap(events_.begin(), events_.end(), later());
+}
+
+void simulator::process(event& e) {
+  switch (e.kind) {
+    case event_kind::request_due: {
+      const auto server = static_cast<size_t>(random_engine_()
+                                              % options_.server_count);
+      (void) clocks_[e.to].send(options_.request_op, 0, byte_order::big_endian,
+                                sent_entries::all, payload_.data(),
+                                payload_.size(), network_sink(e.to, server));
+      schedule(event{now_ + options_.request_interval, 0,
+                     event_kind::request_due, e.to, e.to, {}});
+      break;
+    }
+    case event_kind::delivery:
+      deliver(e);
+      break;
+    case event_kind::sample:
+      take_sample();
+      schedule(event{now_ + options_.sample_interval, 0, event_kind::sample, 0,
+                     0, {}});
+      break;
+  }
+}
+
+packet_sink simulator::network_sink(size_t from, size_t to) {
+  return [this, from, to](const packet& pkt) { transmit(from, to, pkt); };
+}
+
+void simulator::transmit(size_t from, size_t to, const packet& pkt) {
+  auto frame = pkt.serialize_to_binary();
+
+  ++stats_.sent_count;
+  stats_.sent_bytes += frame.size();
+
+  if (next_unit() < options_.network.loss_probability) {
+    ++stats_.dropped_count;
+    return;
+  }
+
+  auto latency = next_duration(options_.network.min_latency,
+                               options_.network.max_latency);
+
+  if (next_unit() < options_.network.reorder_probability) {
+    ++stats_.reordered_count;
+    latency += options_.network.reorder_delay;
+  }
+
+  schedule(
+    event{now_ + latency, 0, event_kind::delivery, from, to, std::move(frame)});
+}
+
+void simulator::deliver(event& e) {
+  ++stats_.delivered_count;
+
+  const auto exp_pkt = packet::deserialize_from_binary(
+    e.frame.data(), e.frame.size(), &arena_);
+
+  if (!exp_pkt.has_value()) {
+    ++stats_.decode_failures;
+    return;
+  }
+
+  const auto receive_start = std::chrono::steady_clock::now();
+  const auto exp_merged_entries = clocks_[e.to].receive(*exp_pkt);
+  stats_.merge_wall_time += std::chrono::steady_clock::now() - receive_start;
+
+  if (!exp_merged_entries.has_value()) {
+    ++stats_.decode_failures;
+    return;
+  }
+
+  ++stats_.merge_count;
+  stats_.merged_entries += *exp_merged_entries;
+
+  if (!exp_pkt->is_response())
+    (void) clocks_[e.to].answer(*exp_pkt, byte_order::big_endian,
+                                options_.response_entries,
+                                network_sink(e.to, e.from));
+}
+
+void simulator::take_sample() {
+  size_t total_entries = 0;
+  size_t max_entries = 0;
+
+  for (const auto& vstamp : vstamps_) {
+    total_entries += vstamp.size();
+    max_entries = std::max(max_entries, vstamp.size());
+  }
+
+  clock_samples_.push_back(clock_sample{
+    now_,
+    static_cast<double>(total_entries) / static_cast<double>(vstamps_.size()),
+    max_entries});
+}
+
+double simulator::next_unit() {
+  // The 53 most significant bits, as std::uniform_real_distribution may draw
+  // differently on another standard library.
+  return static_cast<double>(random_engine_() >> 11U) * 0x1.0p-53;
+}
+
+sim_time simulator::next_duration(sim_time min, sim_time max) {
+  if (max <= min)
+    return min;
+
+  const auto range = static_cast<uint64_t>((max - min).count()) + 1U;
+  return min + sim_time(static_cast<sim_time::rep>(random_engine_() % range));
+}
+} // namespace vc
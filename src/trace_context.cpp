@@ -0,0 +1,40 @@
+#include <sstream>
+#include <string>
+
+#include "trace_context.hpp"
+
+namespace vc {
+void inject_trace_context(packet& pkt, const opentracing::Span& span) {
+  std::ostringstream oss(std::ios_base::out | std::ios_base::binary);
+
+  if (!opentracing::Tracer::Global()->Inject(span.context(), oss))
+    return;
+
+  const auto trace_context = oss.str();
+
+  if (trace_context.empty()
+      || trace_context.size() > packet::max_trace_context_byte_count)
+    return;
+
+  pkt.set_trace_context(trace_context.data(), trace_context.size());
+}
+
+tl::expected<std::unique_ptr<opentracing::SpanContext>, error>
+extract_trace_context(const packet& pkt) {
+  if (!pkt.has_trace_context() || pkt.trace_context_buffer().empty())
+    return nullptr;
+
+  const auto& buffer = pkt.trace_context_buffer();
+  std::istringstream iss(
+    std::string(reinterpret_cast<const char*>(buffer.data()), buffer.size()),
+    std::ios_base::in | std::ios_base::binary);
+
+  auto exp_context = opentracing::Tracer::Global()->Extract(iss);
+
+  if (!exp_context)
+    return VC_UNEXPECTED("Couldn't extract the trace context: "
+                         + exp_context.error().message());
+
+  return std::move(*exp_context);
+}
+} // namespace vc
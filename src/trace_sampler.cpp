@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "trace_sampler.hpp"
+
+namespace vc {
+namespace {
+/**
+ * The credits of the rate limiter needed for a single trace, one trace per
+ * second refills a credit per nanosecond.
+ */
+constexpr int64_t credits_per_trace = 1000000000;
+
+/**
+ * The time after which the adaptive mode recalculates its probability.
+ */
+constexpr int64_t adaptive_window_ns = 1000000000;
+
+/**
+ * The lowest probability of the adaptive mode, so that rare operations are
+ * still traced now and then.
+ */
+constexpr double min_adaptive_probability = 0.001;
+
+int64_t to_ns(trace_sampler::clock::time_point time_point) noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           time_point.time_since_epoch())
+    .count();
+}
+
+/**
+ * Scales a probability to the range of uint64_t.
+ */
+uint64_t to_threshold(double probability) noexcept {
+  constexpr auto max = std::numeric_limits<uint64_t>::max();
+  constexpr auto two_to_the_64 = 18446744073709551616.0;
+
+  if (probability <= 0.0)
+    return 0;
+
+  const auto scaled = probability * two_to_the_64;
+
+  if (scaled >= two_to_the_64)
+    return max;
+
+  return static_cast<uint64_t>(scaled);
+}
+
+double initial_probability(const sampler_config& config) noexcept {
+  switch (config.mode) {
+    case sampling_mode::never:
+      return 0.0;
+    case sampling_mode::probabilistic:
+      return config.param;
+    default:
+      return 1.0;
+  }
+}
+
+std::unique_ptr<trace_sampler>& global_sampler() {
+  static auto instance = std::make_unique<trace_sampler>();
+  return instance;
+}
+} // namespace
+
+tl::expected<sampler_config, error> parse_sampler_config(
+  const std::string& type, double param) {
+  sampler_config config;
+  config.param = param;
+
+  if (type == "always" || type == "const")
+    config.mode = param != 0.0 ? sampling_mode::always : sampling_mode::never;
+  else if (type == "never")
+    config.mode = sampling_mode::never;
+  else if (type == "probabilistic")
+    config.mode = sampling_mode::probabilistic;
+  else if (type == "rate_limiting" || type == "ratelimiting")
+    config.mode = sampling_mode::rate_limiting;
+  else if (type == "adaptive")
+    config.mode = sampling_mode::adaptive;
+  else
+    return VC_UNEXPECTED("Unknown sampler type \"" + type
+                         + "\", expected always, never, probabilistic, "
+                           "rate_limiting or adaptive.");
+
+  if (config.mode == sampling_mode::probabilistic
+      && (param < 0.0 || param > 1.0))
+    return VC_UNEXPECTED("The probability of the sampler must be in [0, 1].");
+
+  if ((config.mode == sampling_mode::rate_limiting
+       || config.mode == sampling_mode::adaptive)
+      && param <= 0.0)
+    return VC_UNEXPECTED("The traces per second must be greater than 0.");
+
+  return config;
+}
+
+trace_sampler::trace_sampler(sampler_config config)
+  : config_(config),
+    threshold_(to_threshold(initial_probability(config_))),
+    credits_(max_credits()),
+    last_refill_ns_(to_ns(clock::now())),
+    window_request_count_(0),
+    window_start_ns_(to_ns(clock::now())) {
+}
+
+bool trace_sampler::should_sample() noexcept {
+  switch (config_.mode) {
+    case sampling_mode::always:
+      return true;
+    case sampling_mode::never:
+      return false;
+    case sampling_mode::probabilistic:
+      return draw(threshold_.load(std::memory_order_relaxed));
+    default:
+      return should_sample(clock::now());
+  }
+}
+
+bool trace_sampler::should_sample(clock::time_point now) noexcept {
+  switch (config_.mode) {
+    case sampling_mode::rate_limiting:
+      return take_token(now);
+    case sampling_mode::adaptive:
+      adapt(now);
+      return draw(threshold_.load(std::memory_order_relaxed));
+    default:
+      return should_sample();
+  }
+}
+
+const sampler_config& trace_sampler::config() const noexcept {
+  return config_;
+}
+
+double trace_sampler::probability() const noexcept {
+  constexpr auto two_to_the_64 = 18446744073709551616.0;
+
+  if (config_.mode == sampling_mode::rate_limiting)
+    return 1.0;
+
+  return static_cast<double>(threshold_.load(std::memory_order_relaxed))
+         / two_to_the_64;
+}
+
+trace_sampler& trace_sampler::global() noexcept {
+  return *global_sampler();
+}
+
+void trace_sampler::init_global(sampler_config config) {
+  global_sampler() = std::make_unique<trace_sampler>(config);
+}
+
+bool trace_sampler::draw(uint64_t threshold) noexcept {
+  if (threshold == std::numeric_limits<uint64_t>::max())
+    return true;
+
+  // splitmix64, seeded once per thread.
+  thread_local uint64_t state = std::random_device{}();
+
+  state += UINT64_C(0x9E3779B97F4A7C15);
+  auto z = state;
+  z = (z ^ (z >> 30U)) * UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27U)) * UINT64_C(0x94D049BB133111EB);
+  z ^= z >> 31U;
+
+  return z < threshold;
+}
+
+int64_t trace_sampler::max_credits() const noexcept {
+  return static_cast<int64_t>(std::max(1.0, config_.param)
+                              * static_cast<double>(credits_per_trace));
+}
+
+bool trace_sampler::take_token(clock::time_point now) noexcept {
+  const auto now_ns = to_ns(now);
+  auto last_ns = last_refill_ns_.load(std::memory_order_relaxed);
+
+  // Only the thread that advances the refill time adds the credits.
+  if (now_ns > last_ns
+      && last_refill_ns_.compare_exchange_strong(last_ns, now_ns,
+                                                 std::memory_order_relaxed)) {
+    const auto elapsed_ns = std::min(now_ns - last_ns, credits_per_trace);
+    const auto refill = static_cast<int64_t>(
+      static_cast<double>(elapsed_ns) * config_.param);
+    const auto max = max_credits();
+    auto credits = credits_.fetch_add(refill, std::memory_order_relaxed)
+                   + refill;
+
+    while (credits > max
+           && !credits_.compare_exchange_weak(credits, max,
+                                              std::memory_order_relaxed)) {
+    }
+  }
+
+  auto credits = credits_.load(std::memory_order_relaxed);
+
+  while (credits >= credits_per_trace) {
+    if (credits_.compare_exchange_weak(credits, credits - credits_per_trace,
+                                       std::memory_order_relaxed))
+      return true;
+  }
+
+  return false;
+}
+
+void trace_sampler::adapt(clock::time_point now) noexcept {
+  window_request_count_.fetch_add(1, std::memory_order_relaxed);
+
+  const auto now_ns = to_ns(now);
+  auto start_ns = window_start_ns_.load(std::memory_order_relaxed);
+
+  if (now_ns - start_ns < adaptive_window_ns)
+    return;
+
+  // Only the thread that closes the window recalculates the probability.
+  if (!window_start_ns_.compare_exchange_strong(start_ns, now_ns,
+                                                std::memory_order_relaxed))
+    return;
+
+  const auto request_count = window_request_count_.exchange(
+    0, std::memory_order_relaxed);
+  const auto requests_per_second = static_cast<double>(request_count)
+                                   * static_cast<double>(adaptive_window_ns)
+                                   / static_cast<double>(now_ns - start_ns);
+  const auto probability = std::clamp(config_.param / requests_per_second,
+                                      min_adaptive_probability, 1.0);
+
+  threshold_.store(to_threshold(probability), std::memory_order_relaxed);
+}
+
+std::unique_ptr<opentracing::Span>
+start_sampled_span(opentracing::string_view operation_name) {
+  if (!trace_sampler::global().should_sample())
+    return nullptr;
+
+  return opentracing::Tracer::Global()->StartSpan(operation_name);
+}
+
+std::unique_ptr<opentracing::Span>
+start_child_span(opentracing::string_view operation_name,
+                 const opentracing::Span* parent) {
+  if (parent == nullptr)
+    return nullptr;
+
+  return opentracing::Tracer::Global()->StartSpan(
+    operation_name, {opentracing::ChildOf(&parent->context())});
+}
+} // namespace vc
@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+#include <string>
+
+#include <QString>
+
+#include "setup_tracer.hpp"
+#include "trace_sampler.hpp"
+
+namespace {
+/**
+ * Simulates the tracing done by the server for a single request.
+ * @param response The response to tag the request's span with.
+ * @return true if the request was traced; otherwise false.
+ */
+bool trace_request(const QString& response) {
+  auto root = vc::start_sampled_span("server: on_ready_read");
+  auto read = vc::start_child_span("server: read_client_request", root.get());
+  read.reset();
+
+  auto handle = vc::start_child_span("server: handle_client_request",
+                                     root.get());
+
+  if (handle == nullptr)
+    return false;
+
+  handle->SetTag("Response", response.toStdString());
+  return true;
+}
+
+/**
+ * Measures the tracing overhead of a sampling mode and prints it.
+ * @param name The name of the mode to print.
+ * @param config The configuration of the sampler.
+ * @param request_count The amount of requests to simulate.
+ */
+void run(const char* name, vc::sampler_config config, uint64_t request_count) {
+  vc::trace_sampler::init_global(config);
+
+  const QString response("Mon, 19 Oct 2026 12:00:00 +0000");
+  uint64_t traced_count = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t i = 0; i < request_count; ++i)
+    traced_count += trace_request(response) ? 1U : 0U;
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+
+  printf("%-14s %10.1f ns/request %12llu traced\n", name,
+         ns / static_cast<double>(request_count),
+         static_cast<unsigned long long>(traced_count));
+}
+} // namespace
+
+/**
+ * Entry point of the tracing overhead benchmark.
+ * @param argc Argument count.
+ * @param argv Command line arguments.
+ * @return 0 on success; otherwise a non-zero error code.
+ *
+ * Simulates the spans of the server's requests with every sampling mode.
+ * Without a configuration file the spans go to the no-op tracer, so only the
+ * cost of the sampling decision and of building the spans' names and tags
+ * is measured; with one they are reported to Jaeger.
+ */
+int main(int argc, char* argv[]) {
+  constexpr auto request_count_index = 1;
+  constexpr auto config_file_path_index = 2;
+
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "Usage: %s <request_count> [config.yml]\n", argv[0]);
+    return -1;
+  }
+
+  const auto request_count = std::strtoull(argv[request_count_index],
+                                           nullptr, 10);
+
+  if (request_count == 0) {
+    fprintf(stderr, "The request count must be a positive integer.\n");
+    return -1;
+  }
+
+  if (argc == 3)
+    vc::setup_tracer(argv[config_file_path_index]);
+
+  run("never", {vc::sampling_mode::never, 0.0}, request_count);
+  run("always", {vc::sampling_mode::always, 1.0}, request_count);
+  run("probabilistic", {vc::sampling_mode::probabilistic, 0.01},
+      request_count);
+  run("rate_limiting", {vc::sampling_mode::rate_limiting, 100.0},
+      request_count);
+  run("adaptive", {vc::sampling_mode::adaptive, 100.0}, request_count);
+
+  if (argc == 3)
+    opentracing::Tracer::Global()->Close();
+
+  return 0;
+}
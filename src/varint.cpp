@@ -0,0 +1,36 @@
+#include "varint.hpp"
+
+namespace vc {
+void append_varint(std::string& buffer, uint64_t value) {
+  while (value >= 0x80U) {
+    buffer.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+    value >>= 7U;
+  }
+
+  buffer.push_back(static_cast<char>(value));
+}
+
+tl::expected<uint64_t, error> read_varint(const char*& cursor,
+                                          const char* end) {
+  uint64_t value = 0;
+
+  for (unsigned i = 0; i < max_varint_byte_count; ++i) {
+    if (cursor == end)
+      return VC_UNEXPECTED("Truncated varint.");
+
+    const auto byte = static_cast<uint8_t>(*cursor++);
+    const auto shift = 7U * i;
+
+    // The last byte only has room for the most significant bit.
+    if (shift == 63U && (byte & 0x7FU) > 1U)
+      return VC_UNEXPECTED("Varint exceeds 64 bits.");
+
+    value |= uint64_t(byte & 0x7FU) << shift;
+
+    if ((byte & 0x80U) == 0)
+      return value;
+  }
+
+  return VC_UNEXPECTED("Overlong varint.");
+}
+} // namespace vc
@@ -1,50 +1,57 @@
 #include <cstring>
 
+#include <iterator>
 #include <ostream>
 #include <utility>
 
-#include "hton.hpp"
-#include "ntoh.hpp"
 #include "vector_timestamp.hpp"
 
 namespace vc {
-vector_timestamp::vector_timestamp(actor_id aid) : data_{{aid, 0}} {
+vector_timestamp::vector_timestamp(actor_id aid,
+                                   std::pmr::memory_resource* resource)
+  : data_({{aid, 0}}, resource) {
 }
 
 [[nodiscard]] tl::expected<vector_timestamp, error>
 vector_timestamp::deserialize_from_binary(const void* pointer,
-                                          size_t byte_count) {
+                                          size_t byte_count,
+                                          byte_order order,
+                                          std::pmr::memory_resource* resource) {
   if (byte_count < sizeof(uint64_t))
-    return VC_UNEXPECTED("Too few bytes were supplied.");
+    return VC_UNEXPECTED_CODE(errc::too_few_vstamp_bytes);
 
-  const auto* ptr = static_cast<const pl::byte*>(pointer);
+  const auto* const ptr = static_cast<const pl::byte*>(pointer);
 
-  const auto read = [&ptr] {
-    uint64_t buffer;
-    memcpy(&buffer, ptr, sizeof(uint64_t));
+  uint64_t pair_count;
+  load_in_order(&pair_count, ptr, 1, order);
 
-    ptr += sizeof(uint64_t);
+  // Divided rather than multiplied, so that a hostile count can't overflow.
+  constexpr auto pair_byte_count = 2U * sizeof(uint64_t);
+  const auto pairs_byte_count = byte_count - sizeof(uint64_t);
 
-    return ntoh(buffer);
-  };
-
-  const auto pair_count = read();
-
-  if ((pair_count * (2 * sizeof(uint64_t))) != (byte_count - sizeof(uint64_t)))
-    return VC_UNEXPECTED("The pair count given was invalid.");
+  if (pairs_byte_count % pair_byte_count != 0
+      || pair_count != pairs_byte_count / pair_byte_count)
+    return VC_UNEXPECTED_CODE(errc::invalid_pair_count);
 
-  std::unordered_map<actor_id, uint64_t> map;
+  // Converts all of the pairs at once, which is vectorized, or merely
+  // copies them if they are in the host's byte order.
+  std::pmr::vector<uint64_t> words(2U * pair_count, resource);
+  load_in_order(words.data(), ptr + sizeof(uint64_t), words.size(), order);
 
-  for (uint64_t i = 0; i < pair_count; ++i) {
-    const actor_id aid(read());
-    const auto clock = read();
+  map_type map(resource);
+  map.reserve(pair_count);
 
-    map.emplace(aid, clock);
-  }
+  for (size_t i = 0; i < words.size(); i += 2U)
+    map.emplace(actor_id(words[i]), words[i + 1U]);
 
   return vector_timestamp(std::move(map));
 }
 
+[[nodiscard]] vector_timestamp vector_timestamp::from_entries(
+  std::unordered_map<actor_id, uint64_t> entries) {
+  return vector_timestamp(map_type(entries.begin(), entries.end()));
+}
+
 [[nodiscard]] tl::optional<uint64_t> vector_timestamp::tick(actor_id aid) {
   const auto it = data_.find(aid);
 
@@ -69,45 +76,68 @@ vector_timestamp& vector_timestamp::merge(const vector_timestamp& other) {
   return *this;
 }
 
-[[nodiscard]] QString vector_timestamp::to_json() const {
-  QString buffer;
+[[nodiscard]] bool
+vector_timestamp::happened_before(const vector_timestamp& other) const {
+  const auto clock_of = [](const auto& map, actor_id aid) -> uint64_t {
+    const auto it = map.find(aid);
+    return it == map.end() ? 0 : it->second;
+  };
 
-  buffer += '{';
+  auto is_less = false;
 
-  for (const auto [aid, clock] : data_)
-    buffer += '"' + aid.to_string() + "\":" + QString::number(clock) + ", ";
+  for (const auto [aid, own_clock] : data_) {
+    const auto their_clock = clock_of(other.data_, aid);
 
-  // ", " are two characters (not including the null-terminator)
-  buffer.remove(buffer.size() - 2, 2);
+    if (own_clock > their_clock)
+      return false;
 
-  buffer += '}';
+    if (own_clock < their_clock)
+      is_less = true;
+  }
 
-  return buffer;
-}
+  if (is_less)
+    return true;
 
-[[nodiscard]] std::vector<pl::byte>
-vector_timestamp::serialize_to_binary() const {
-  std::vector<pl::byte> buffer;
+  for (const auto [aid, their_clock] : other.data_) {
+    if (their_clock > clock_of(data_, aid))
+      return true;
+  }
 
-  const auto append_bytes = [&buffer](const void* pointer, size_t byte_count) {
-    const auto* const first = static_cast<const pl::byte*>(pointer);
-    const auto* const last = first + byte_count;
-    buffer.insert(buffer.end(), first, last);
-  };
+  return false;
+}
 
-  const auto append = [&append_bytes](const auto& x) {
-    append_bytes(&x, sizeof(x));
-  };
+[[nodiscard]] size_t vector_timestamp::size() const noexcept {
+  return data_.size();
+}
+
+[[nodiscard]] const vector_timestamp::map_type&
+vector_timestamp::entries() const noexcept {
+  return data_;
+}
 
-  const auto pair_count = hton(static_cast<uint64_t>(data_.size()));
+[[nodiscard]] QString vector_timestamp::to_json() const {
+  fmt::memory_buffer buffer;
+  format_json(std::back_inserter(buffer));
+  return QString::fromUtf8(buffer.data(), static_cast<int>(buffer.size()));
+}
 
-  append(pair_count);
+[[nodiscard]] std::pmr::vector<pl::byte>
+vector_timestamp::serialize_to_binary(
+  byte_order order, std::pmr::memory_resource* resource) const {
+  // Gathers the pair count and the pairs, so that they can be converted to
+  // the byte order at once, which is vectorized.
+  std::pmr::vector<uint64_t> words(resource);
+  words.reserve(1U + 2U * data_.size());
+  words.push_back(data_.size());
 
   for (const auto [aid, clock] : data_) {
-    append(hton(aid.value()));
-    append(hton(clock));
+    words.push_back(aid.value());
+    words.push_back(clock);
   }
 
+  std::pmr::vector<pl::byte> buffer(words.size() * sizeof(uint64_t),
+                                    resource);
+  store_in_order(buffer.data(), words.data(), words.size(), order);
   return buffer;
 }
 
@@ -120,11 +150,11 @@ bool operator!=(const vector_timestamp& lhs, const vector_timestamp& rhs) {
 }
 
 std::ostream& operator<<(std::ostream& os, const vector_timestamp& vstamp) {
-  return os << vstamp.to_json().toStdString();
+  vstamp.format_json(std::ostreambuf_iterator<char>(os));
+  return os;
 }
 
-vector_timestamp::vector_timestamp(
-  std::unordered_map<actor_id, uint64_t>&& map) noexcept
+vector_timestamp::vector_timestamp(map_type&& map) noexcept
   : data_(std::move(map)) {
 }
 } // namespace vc
@@ -0,0 +1,64 @@
+#include <cassert>
+
+#include <algorithm>
+#include <utility>
+
+#include "write_queue.hpp"
+
+namespace vc {
+write_queue::write_queue(watermarks limits)
+  : limits_(limits), frames_(), pending_byte_count_(0), is_paused_(false) {
+  assert(limits_.low <= limits_.high && "Invalid watermarks!");
+}
+
+write_queue::transition write_queue::push(frame f) {
+  assert(f != nullptr && "Can't push a null frame!");
+
+  pending_byte_count_ += f->size();
+  frames_.push_back(std::move(f));
+
+  if (!is_paused_ && pending_byte_count_ >= limits_.high) {
+    is_paused_ = true;
+    return transition::paused;
+  }
+
+  return transition::none;
+}
+
+write_queue::transition write_queue::push(std::vector<pl::byte> bytes) {
+  return push(std::make_shared<const std::vector<pl::byte>>(std::move(bytes)));
+}
+
+[[nodiscard]] bool write_queue::empty() const noexcept {
+  return frames_.empty();
+}
+
+[[nodiscard]] const std::vector<pl::byte>& write_queue::front() const {
+  assert(!empty() && "Can't access the front of an empty write_queue!");
+  return *frames_.front();
+}
+
+void write_queue::pop() {
+  assert(!empty() && "Can't pop from an empty write_queue!");
+  frames_.pop_front();
+}
+
+write_queue::transition write_queue::acknowledge(size_t byte_count) {
+  pending_byte_count_ -= std::min(byte_count, pending_byte_count_);
+
+  if (is_paused_ && pending_byte_count_ <= limits_.low) {
+    is_paused_ = false;
+    return transition::resumed;
+  }
+
+  return transition::none;
+}
+
+[[nodiscard]] size_t write_queue::pending_byte_count() const noexcept {
+  return pending_byte_count_;
+}
+
+[[nodiscard]] bool write_queue::is_paused() const noexcept {
+  return is_paused_;
+}
+} // namespace vc
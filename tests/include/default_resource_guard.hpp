@@ -0,0 +1,33 @@
+#pragma once
+#include <memory_resource>
+
+#include <pl/noncopyable.hpp>
+
+namespace vc::test {
+/**
+ * Replaces the default memory resource for its lifetime, so that the previous
+ * one is restored even if an assertion throws.
+ */
+class default_resource_guard {
+public:
+  PL_NONCOPYABLE(default_resource_guard);
+
+  /**
+   * Makes a memory resource the default one.
+   * @param resource The memory resource to use, must outlive the guard.
+   */
+  explicit default_resource_guard(std::pmr::memory_resource* resource) noexcept
+    : previous_(std::pmr::set_default_resource(resource)) {
+  }
+
+  /**
+   * Restores the default memory resource that was replaced.
+   */
+  ~default_resource_guard() {
+    std::pmr::set_default_resource(previous_);
+  }
+
+private:
+  std::pmr::memory_resource* previous_;
+};
+} // namespace vc::test
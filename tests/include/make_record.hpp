@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "log_record.hpp"
+
+namespace vc::test {
+/**
+ * Creates a log entry of level info, as written by a function "void f()" in
+ * "file.cpp".
+ * @param aid The actor creating the entry.
+ * @param clocks The actor_id / clock pairs of the entry's vector timestamp.
+ * @param message The formatted message.
+ * @param line The line of the calling context.
+ * @return The log entry.
+ */
+inline log_record make_record(actor_id aid,
+                              std::unordered_map<actor_id, uint64_t> clocks,
+                              std::string message = "message",
+                              unsigned line = 1) {
+  return log_record{vector_timestamp::from_entries(std::move(clocks)),
+                    log_level::info,
+                    aid,
+                    "void f()",
+                    "file.cpp",
+                    line,
+                    std::move(message)};
+}
+} // namespace vc::test
@@ -0,0 +1,118 @@
+#include <cstring>
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "actor_clock.hpp"
+
+namespace {
+/**
+ * Sends a request from one actor_clock and returns the encoded packet.
+ */
+std::vector<pl::byte> send_request(vc::actor_clock& sender, vc::opcode op,
+                                   const std::string& payload) {
+  std::vector<pl::byte> frame;
+  EXPECT_TRUE(sender.send(op, 0, vc::byte_order::big_endian,
+                          vc::sent_entries::all, payload.data(),
+                          payload.size(), [&frame](const vc::packet& pkt) {
+                            frame = pkt.serialize_to_binary();
+                          }));
+  return frame;
+}
+} // namespace
+
+TEST(actor_clock_test, answers_echo_request) {
+  std::pmr::monotonic_buffer_resource arena;
+  vc::vector_timestamp client_vstamp(vc::actor_id{2});
+  vc::vector_timestamp server_vstamp(vc::actor_id{1});
+  vc::actor_clock client(vc::actor_id{2}, client_vstamp, &arena);
+  vc::actor_clock server(vc::actor_id{1}, server_vstamp, &arena);
+
+  const auto frame = send_request(client, vc::opcode::echo, "Hello");
+  const auto exp_request = vc::packet::deserialize_from_binary(
+    frame.data(), frame.size(), &arena);
+  ASSERT_TRUE(exp_request.has_value());
+
+  const auto exp_merged_entries = server.receive(*exp_request);
+  ASSERT_TRUE(exp_merged_entries.has_value());
+  EXPECT_EQ(1U, *exp_merged_entries);
+  EXPECT_EQ(vc::vector_timestamp::from_entries(
+              {{vc::actor_id{1}, 1}, {vc::actor_id{2}, 1}}),
+            server_vstamp);
+
+  std::string echoed;
+  ASSERT_TRUE(server.answer(*exp_request, vc::byte_order::big_endian,
+                            vc::sent_entries::all,
+                            [&echoed](const vc::packet& response) {
+                              EXPECT_TRUE(response.is_response());
+                              EXPECT_EQ(vc::opcode::echo, response.op());
+                              echoed.assign(
+                                reinterpret_cast<const char*>(
+                                  response.payload_buffer().data()),
+                                response.payload_buffer().size());
+                            }));
+  EXPECT_EQ("Hello", echoed);
+  EXPECT_EQ(vc::vector_timestamp::from_entries(
+              {{vc::actor_id{1}, 2}, {vc::actor_id{2}, 1}}),
+            server_vstamp);
+}
+
+TEST(actor_clock_test, sends_own_entry_only) {
+  std::pmr::monotonic_buffer_resource arena;
+  auto vstamp = vc::vector_timestamp::from_entries(
+    {{vc::actor_id{1}, 4}, {vc::actor_id{2}, 7}});
+  vc::actor_clock clock(vc::actor_id{1}, vstamp, &arena);
+  constexpr char payload[] = "ACK";
+
+  ASSERT_TRUE(clock.send(
+    vc::opcode::clock_sync, vc::packet::response_flag,
+    vc::byte_order::little_endian, vc::sent_entries::own, payload,
+    sizeof(payload), [](const vc::packet& response) {
+      EXPECT_EQ(vc::byte_order::little_endian, response.vstamp_byte_order());
+
+      const auto exp_vstamp = vc::vector_timestamp::deserialize_from_binary(
+        response.vstamp_buffer().data(), response.vstamp_buffer().size(),
+        response.vstamp_byte_order());
+      ASSERT_TRUE(exp_vstamp.has_value());
+      EXPECT_EQ(vc::vector_timestamp::from_entries({{vc::actor_id{1}, 5}}),
+                *exp_vstamp);
+    }));
+}
+
+TEST(actor_clock_test, doesnt_answer_other_requests) {
+  std::pmr::monotonic_buffer_resource arena;
+  vc::vector_timestamp client_vstamp(vc::actor_id{2});
+  vc::vector_timestamp server_vstamp(vc::actor_id{1});
+  vc::actor_clock client(vc::actor_id{2}, client_vstamp, &arena);
+  vc::actor_clock server(vc::actor_id{1}, server_vstamp, &arena);
+
+  const auto frame = send_request(client, vc::opcode::time, "TIME");
+  const auto exp_request = vc::packet::deserialize_from_binary(
+    frame.data(), frame.size(), &arena);
+  ASSERT_TRUE(exp_request.has_value());
+
+  EXPECT_FALSE(server.answer(*exp_request, vc::byte_order::big_endian,
+                             vc::sent_entries::all,
+                             [](const vc::packet&) { FAIL(); }));
+}
+
+TEST(actor_clock_test, reports_missing_own_clock) {
+  std::pmr::monotonic_buffer_resource arena;
+  vc::vector_timestamp client_vstamp(vc::actor_id{2});
+  auto server_vstamp = vc::vector_timestamp::from_entries(
+    {{vc::actor_id{3}, 1}});
+  vc::actor_clock client(vc::actor_id{2}, client_vstamp, &arena);
+  vc::actor_clock server(vc::actor_id{1}, server_vstamp, &arena);
+
+  const auto frame = send_request(client, vc::opcode::echo, "Hello");
+  const auto exp_request = vc::packet::deserialize_from_binary(
+    frame.data(), frame.size(), &arena);
+  ASSERT_TRUE(exp_request.has_value());
+
+  const auto exp_merged_entries = server.receive(*exp_request);
+  ASSERT_FALSE(exp_merged_entries.has_value());
+  EXPECT_EQ(vc::errc::missing_own_clock, exp_merged_entries.error().code());
+}
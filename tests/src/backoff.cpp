@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "backoff.hpp"
+
+namespace {
+const vc::backoff_policy policy{std::chrono::milliseconds(100),
+                                std::chrono::milliseconds(1000), 2.0};
+} // namespace
+
+TEST(backoff_test, delays_grow_exponentially) {
+  vc::backoff b(policy, 42);
+
+  for (const auto ceiling : {100, 200, 400, 800}) {
+    const auto delay = b.next_delay();
+
+    EXPECT_GE(delay, std::chrono::milliseconds(ceiling / 2));
+    EXPECT_LE(delay, std::chrono::milliseconds(ceiling));
+  }
+}
+
+TEST(backoff_test, delays_are_capped) {
+  vc::backoff b(policy, 42);
+
+  for (int i = 0; i < 100; ++i) {
+    const auto delay = b.next_delay();
+
+    EXPECT_LE(delay, policy.max_delay);
+  }
+
+  const auto delay = b.next_delay();
+
+  EXPECT_GE(delay, policy.max_delay / 2);
+}
+
+TEST(backoff_test, reset) {
+  vc::backoff b(policy, 42);
+
+  (void) b.next_delay();
+  (void) b.next_delay();
+
+  EXPECT_EQ(2U, b.attempt_count());
+
+  b.reset();
+
+  EXPECT_EQ(0U, b.attempt_count());
+  EXPECT_LE(b.next_delay(), policy.initial_delay);
+}
+
+TEST(backoff_test, jitter_spreads_clients) {
+  vc::backoff first(policy, 1);
+  vc::backoff second(policy, 2);
+
+  bool differs = false;
+
+  for (int i = 0; i < 5; ++i)
+    differs = differs || first.next_delay() != second.next_delay();
+
+  EXPECT_TRUE(differs);
+}
@@ -0,0 +1,130 @@
+#include <cstring>
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "binary_log.hpp"
+#include "make_record.hpp"
+#include "varint.hpp"
+
+namespace {
+/**
+ * Creates an entry whose clocks take more than a byte to encode.
+ */
+vc::log_record make_record(uint64_t aid, unsigned line, std::string message) {
+  return vc::test::make_record(
+    vc::actor_id(aid),
+    {{vc::actor_id(aid), 5}, {vc::actor_id(aid + 300), 70000}},
+    std::move(message), line);
+}
+} // namespace
+
+TEST(binary_log_test, varint_round_trip) {
+  const uint64_t values[]
+    = {0, 1, 127, 128, 300, UINT64_C(1) << 32, UINT64_MAX};
+
+  for (const auto value : values) {
+    std::string buffer;
+    vc::append_varint(buffer, value);
+
+    const char* cursor = buffer.data();
+    const auto exp = vc::read_varint(cursor, buffer.data() + buffer.size());
+
+    ASSERT_TRUE(exp.has_value());
+    EXPECT_EQ(value, *exp);
+    EXPECT_EQ(buffer.data() + buffer.size(), cursor);
+  }
+}
+
+TEST(binary_log_test, truncated_varint) {
+  std::string buffer;
+  vc::append_varint(buffer, 300);
+  buffer.pop_back();
+
+  const char* cursor = buffer.data();
+
+  EXPECT_FALSE(
+    vc::read_varint(cursor, buffer.data() + buffer.size()).has_value());
+}
+
+TEST(binary_log_test, oversized_varints) {
+  // 11 bytes, the encoding of 0 padded with continuation bytes.
+  const std::string overlong("\x80\x80\x80\x80\x80\x80\x80\x80\x80\x80\x00",
+                             11);
+  // 10 bytes, setting bit 64.
+  const std::string too_wide("\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x03",
+                             10);
+
+  for (const auto& buffer : {overlong, too_wide}) {
+    const char* cursor = buffer.data();
+
+    EXPECT_FALSE(
+      vc::read_varint(cursor, buffer.data() + buffer.size()).has_value());
+  }
+}
+
+TEST(binary_log_test, round_trip) {
+  std::stringstream ss(std::ios_base::in | std::ios_base::out
+                       | std::ios_base::binary);
+
+  {
+    vc::binary_log_sink sink(ss);
+    sink.write(make_record(1, 10, "first"));
+    sink.write(make_record(2, 20, "second"));
+    sink.flush();
+  }
+
+  const auto one_record_size = [] {
+    std::stringstream s(std::ios_base::in | std::ios_base::out
+                        | std::ios_base::binary);
+    vc::binary_log_sink sink(s);
+    sink.write(make_record(1, 10, "first"));
+    return s.str().size();
+  }();
+
+  // The second entry refers to the interned function and file names.
+  EXPECT_LT(ss.str().size(), 2 * one_record_size);
+
+  vc::binary_log_reader reader(ss);
+
+  for (const auto& expected :
+       {make_record(1, 10, "first"), make_record(2, 20, "second")}) {
+    const auto exp = reader.next();
+
+    ASSERT_TRUE(exp.has_value()) << exp.error().message();
+    ASSERT_TRUE(exp->has_value());
+
+    const auto& record = **exp;
+    EXPECT_EQ(expected.vstamp, record.vstamp);
+    EXPECT_EQ(expected.level, record.level);
+    EXPECT_EQ(expected.aid, record.aid);
+    EXPECT_STREQ(expected.function, record.function);
+    EXPECT_STREQ(expected.file, record.file);
+    EXPECT_EQ(expected.line, record.line);
+    EXPECT_EQ(expected.message, record.message);
+  }
+
+  const auto exp = reader.next();
+  ASSERT_TRUE(exp.has_value());
+  EXPECT_FALSE(exp->has_value());
+}
+
+TEST(binary_log_test, bad_magic) {
+  std::stringstream ss("not a binary log");
+  vc::binary_log_reader reader(ss);
+
+  EXPECT_FALSE(reader.next().has_value());
+}
+
+TEST(binary_log_test, corrupt_record_length) {
+  std::string log("VCLOG\x01", 6);
+  vc::append_varint(log, UINT64_C(1) << 62);
+  log += "a few bytes";
+
+  std::stringstream ss(log);
+  vc::binary_log_reader reader(ss);
+
+  EXPECT_FALSE(reader.next().has_value());
+}
@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <cstring>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bswap_range.hpp"
+#include "hton.hpp"
+
+namespace {
+template <class T>
+std::vector<T> make_elements(size_t count) {
+  std::vector<T> elements(count);
+
+  for (size_t i = 0; i < count; ++i)
+    elements[i] = static_cast<T>(0x0102030405060708ULL * (i + 1U));
+
+  return elements;
+}
+
+template <class T>
+void expect_all_isas_swap(size_t count) {
+  const auto elements = make_elements<T>(count);
+
+  for (const auto isa :
+       {vc::bswap_isa::scalar, vc::bswap_isa::ssse3, vc::bswap_isa::avx2}) {
+    if (static_cast<int>(isa) > static_cast<int>(vc::active_bswap_isa()))
+      continue;
+
+    // Offset by a byte, the buffers needn't be aligned.
+    std::vector<pl::byte> buffer(count * sizeof(T) + 1U);
+    vc::bswap_copy(isa, buffer.data() + 1, elements.data(), count,
+                   sizeof(T));
+
+    for (size_t i = 0; i < count; ++i) {
+      T element;
+      memcpy(&element, buffer.data() + 1 + i * sizeof(T), sizeof(T));
+      ASSERT_EQ(pl::bswap(elements[i]), element)
+        << "isa " << static_cast<int>(isa) << ", element " << i;
+    }
+  }
+}
+} // namespace
+
+TEST(bswap_range_test, all_isas_match_scalar) {
+  // Counts around the vector widths exercise the tails.
+  for (const size_t count : {0U, 1U, 3U, 7U, 8U, 9U, 17U, 33U, 1000U}) {
+    expect_all_isas_swap<uint16_t>(count);
+    expect_all_isas_swap<uint32_t>(count);
+    expect_all_isas_swap<uint64_t>(count);
+  }
+}
+
+TEST(bswap_range_test, hton_range_in_place) {
+  auto elements = make_elements<uint64_t>(21);
+  const auto original = elements;
+
+  vc::hton_range(elements.data(), elements.size());
+
+  for (size_t i = 0; i < elements.size(); ++i)
+    EXPECT_EQ(vc::hton(original[i]), elements[i]);
+
+  vc::ntoh_range(elements.data(), elements.size());
+
+  EXPECT_EQ(original, elements);
+}
+
+TEST(bswap_range_test, copy_roundtrip) {
+  const auto elements = make_elements<uint32_t>(13);
+  std::vector<pl::byte> buffer(elements.size() * sizeof(uint32_t));
+  std::vector<uint32_t> result(elements.size());
+
+  vc::hton_copy(buffer.data(), elements.data(), elements.size());
+  vc::ntoh_copy(result.data(), buffer.data(), result.size());
+
+  EXPECT_EQ(elements, result);
+  EXPECT_EQ(0x05, buffer[0]);
+  EXPECT_EQ(0x08, buffer[3]);
+}
@@ -0,0 +1,99 @@
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "causal_merge.hpp"
+#include "make_record.hpp"
+
+namespace {
+using vc::test::make_record;
+
+std::vector<std::string> pop_messages(vc::causal_merge& merge) {
+  std::vector<std::string> messages;
+  merge.pop([&messages](vc::log_record&& record) {
+    messages.push_back(std::move(record.message));
+  });
+  return messages;
+}
+} // namespace
+
+TEST(causal_merge_test, holds_back_until_next_complete_round) {
+  vc::causal_merge merge;
+  merge.push(0, make_record(vc::actor_id{1}, {{vc::actor_id{1}, 1}}, "a"));
+
+  EXPECT_TRUE(pop_messages(merge).empty());
+
+  merge.complete_round();
+  EXPECT_TRUE(pop_messages(merge).empty());
+
+  merge.complete_round();
+  EXPECT_EQ(std::vector<std::string>{"a"}, pop_messages(merge));
+  EXPECT_EQ(0U, merge.size());
+}
+
+TEST(causal_merge_test, waits_for_predecessor_of_other_source) {
+  vc::causal_merge merge;
+
+  // The receive event was collected a round before the send event.
+  merge.push(1, make_record(vc::actor_id{2},
+                            {{vc::actor_id{1}, 1}, {vc::actor_id{2}, 1}},
+                            "receive"));
+  merge.complete_round();
+  merge.push(0, make_record(vc::actor_id{1}, {{vc::actor_id{1}, 1}}, "send"));
+  merge.complete_round();
+
+  EXPECT_TRUE(pop_messages(merge).empty());
+  EXPECT_EQ(2U, merge.size());
+
+  merge.complete_round();
+  EXPECT_EQ((std::vector<std::string>{"send", "receive"}),
+            pop_messages(merge));
+}
+
+TEST(causal_merge_test, release_all_orders_causally) {
+  vc::causal_merge merge;
+  merge.push(2, make_record(vc::actor_id{3},
+                            {{vc::actor_id{1}, 2}, {vc::actor_id{3}, 1}},
+                            "third"));
+  merge.push(1, make_record(vc::actor_id{1}, {{vc::actor_id{1}, 2}}, "second"));
+  merge.push(0, make_record(vc::actor_id{1}, {{vc::actor_id{1}, 1}}, "first"));
+  merge.push(0, make_record(vc::actor_id{4}, {{vc::actor_id{4}, 1}},
+                            "concurrent"));
+  merge.release_all();
+
+  const auto messages = pop_messages(merge);
+
+  ASSERT_EQ(4U, messages.size());
+  EXPECT_EQ("first", messages[0]);
+  EXPECT_EQ("concurrent", messages[1]);
+  EXPECT_EQ("second", messages[2]);
+  EXPECT_EQ("third", messages[3]);
+}
+
+TEST(causal_merge_test, same_event_in_two_sources_doesnt_wait) {
+  vc::causal_merge merge;
+  merge.push(0, make_record(vc::actor_id{1}, {{vc::actor_id{1}, 1}}, "a"));
+  merge.push(1, make_record(vc::actor_id{1}, {{vc::actor_id{1}, 1}}, "b"));
+  merge.release_all();
+
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), pop_messages(merge));
+  EXPECT_EQ(0U, merge.size());
+}
+
+TEST(causal_merge_test, releases_inconsistent_clocks) {
+  vc::causal_merge merge;
+
+  // Each entry claims to have seen the other one.
+  merge.push(0, make_record(vc::actor_id{1},
+                            {{vc::actor_id{1}, 1}, {vc::actor_id{2}, 1}},
+                            "a"));
+  merge.push(1, make_record(vc::actor_id{2},
+                            {{vc::actor_id{1}, 1}, {vc::actor_id{2}, 1}},
+                            "b"));
+  merge.release_all();
+
+  EXPECT_EQ(2U, pop_messages(merge).size());
+  EXPECT_EQ(0U, merge.size());
+}
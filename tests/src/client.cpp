@@ -0,0 +1,99 @@
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QHostAddress>
+
+#include <gtest/gtest.h>
+
+#include "client.hpp"
+#include "server.hpp"
+
+namespace {
+/**
+ * Creates the application whose event loop the sockets use, once.
+ */
+void ensure_application() {
+  static int argc = 1;
+  static char name[] = "vector_clocks_tests";
+  static char* argv[] = {name, nullptr};
+  static QCoreApplication application(argc, argv);
+  (void) application;
+}
+
+/**
+ * Processes events until a condition holds.
+ * @param predicate The condition.
+ * @return true if the condition holds; false if it didn't within 5 seconds.
+ */
+template <class Predicate>
+bool process_events_until(Predicate predicate) {
+  const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::seconds(5);
+
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline)
+      return false;
+
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  }
+
+  return true;
+}
+
+vc::logger_options quiet_options() {
+  vc::logger_options options;
+  options.echo_to_stdout = false;
+  return options;
+}
+
+/**
+ * Connects a client to a server and sends an echo request once the
+ * connection is established.
+ * @param s The server, listening.
+ * @param l The logger of the client.
+ * @return The echoed payload; an empty string if no response arrived.
+ */
+std::string echo_after_hello(vc::server& s, vc::logger& l) {
+  vc::client c(vc::actor_id{2}, l);
+  c.connect(QHostAddress(QHostAddress::LocalHost), s.port(),
+            vc::client_mode::poll, std::chrono::hours(1));
+
+  if (!process_events_until([&c] { return c.connected_count() == 1; }))
+    return std::string();
+
+  auto f = c.request("Hello");
+
+  if (!process_events_until([&f] { return f.is_ready(); })
+      || !f.get().has_value())
+    return std::string();
+
+  return f.get()->payload;
+}
+} // namespace
+
+TEST(client_test, echoes_after_hello) {
+  ensure_application();
+  std::ostringstream oss;
+  vc::logger l(oss, quiet_options());
+  vc::server s(vc::actor_id{1}, l);
+  ASSERT_TRUE(s.listen(QHostAddress(QHostAddress::LocalHost), 0));
+
+  EXPECT_EQ(std::string("Hello"), echo_after_hello(s, l));
+}
+
+TEST(client_test, echoes_if_server_drops_hello) {
+  ensure_application();
+  std::ostringstream oss;
+  vc::logger l(oss, quiet_options());
+  vc::server s(vc::actor_id{1}, l);
+
+  // Behaves like a server that doesn't know the hello request.
+  s.register_handler(vc::opcode::hello, [](QTcpSocket*, const vc::packet&,
+                                           opentracing::Span*) {});
+  ASSERT_TRUE(s.listen(QHostAddress(QHostAddress::LocalHost), 0));
+
+  EXPECT_EQ(std::string("Hello"), echo_after_hello(s, l));
+}
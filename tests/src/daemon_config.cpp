@@ -0,0 +1,141 @@
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "daemon_config.hpp"
+
+namespace {
+std::string write_config(const std::string& file_name,
+                         const std::string& contents) {
+  const auto path = ::testing::TempDir() + file_name;
+  std::ofstream ofs(path, std::ios_base::out | std::ios_base::trunc);
+  ofs << contents;
+  return path;
+}
+} // namespace
+
+TEST(daemon_config_test, server_and_clients) {
+  const auto path = write_config("daemon.yml", R"~(
+daemon:
+  log_file: "-"
+  log_async: true
+  log_binary: true
+  log_per_thread: true
+  log_segment_bytes: 1048576
+  log_level: debug
+  log_flush_interval_ms: 250
+  metrics_port: 9100
+  server:
+    actor_id: 7
+    host: 0.0.0.0
+    port: 12000
+    publish_interval_ms: 20
+  clients:
+    - first_actor_id: 10
+      count: 50
+      server:
+        port: 12000
+      mode: subscribe
+      pool_size: 3
+    - server:
+        host: 10.0.0.2
+        port: 12001
+      request_interval_ms: 5
+)~");
+
+  const auto exp = vc::parse_daemon_config(path);
+
+  ASSERT_TRUE(exp.has_value());
+
+  const auto& config = *exp;
+
+  EXPECT_EQ("-", config.log_file);
+  EXPECT_TRUE(config.log_options.asynchronous);
+  EXPECT_EQ(std::chrono::milliseconds(250), config.log_options.flush_interval);
+  EXPECT_TRUE(config.log_options.echo_to_stdout);
+  EXPECT_TRUE(config.log_binary);
+  EXPECT_TRUE(config.log_options.per_thread_buffers);
+  EXPECT_EQ(1048576U, config.log_segment_byte_count);
+  EXPECT_EQ(4U, config.log_max_segment_count);
+  EXPECT_EQ(vc::log_level::debug, config.log_options.level);
+  EXPECT_EQ("127.0.0.1", config.metrics_host);
+  EXPECT_EQ(9100, config.metrics_port);
+  EXPECT_FALSE(config.mesh.has_value());
+
+  ASSERT_TRUE(config.server.has_value());
+  EXPECT_EQ(vc::actor_id{7}, config.server->aid);
+  EXPECT_EQ("0.0.0.0", config.server->host);
+  EXPECT_EQ(12000, config.server->port);
+  EXPECT_EQ(std::chrono::milliseconds(20), config.server->publish_interval);
+
+  ASSERT_EQ(2U, config.clients.size());
+  EXPECT_EQ(vc::actor_id{10}, config.clients[0].first_aid);
+  EXPECT_EQ(50U, config.clients[0].count);
+  EXPECT_EQ("127.0.0.1", config.clients[0].server.host);
+  EXPECT_EQ(12000, config.clients[0].server.port);
+  EXPECT_EQ(vc::client_mode::subscribe, config.clients[0].mode);
+  EXPECT_EQ(vc::default_request_interval, config.clients[0].request_interval);
+  EXPECT_EQ(3U, config.clients[0].pool_size);
+
+  EXPECT_EQ(vc::actor_id{2}, config.clients[1].first_aid);
+  EXPECT_EQ(1U, config.clients[1].count);
+  EXPECT_EQ("10.0.0.2", config.clients[1].server.host);
+  EXPECT_EQ(12001, config.clients[1].server.port);
+  EXPECT_EQ(vc::client_mode::poll, config.clients[1].mode);
+  EXPECT_EQ(std::chrono::milliseconds(5), config.clients[1].request_interval);
+  EXPECT_EQ(1U, config.clients[1].pool_size);
+}
+
+TEST(daemon_config_test, mesh_only) {
+  const auto path = write_config("daemon_mesh.yml",
+                                 "mesh:\n  actor_id: 4\n  port: 20004\n");
+
+  const auto exp = vc::parse_daemon_config(path);
+
+  ASSERT_TRUE(exp.has_value());
+  EXPECT_FALSE(exp->server.has_value());
+  EXPECT_TRUE(exp->clients.empty());
+  ASSERT_TRUE(exp->mesh.has_value());
+  EXPECT_EQ("mesh_actor4.log", exp->log_file);
+}
+
+TEST(daemon_config_test, nothing_to_run) {
+  const auto path = write_config("daemon_empty.yml", "disabled: false\n");
+
+  EXPECT_FALSE(vc::parse_daemon_config(path).has_value());
+}
+
+TEST(daemon_config_test, unknown_client_mode) {
+  const auto path = write_config("daemon_bad_mode.yml", R"~(
+daemon:
+  clients:
+    - server:
+        port: 12000
+      mode: push
+)~");
+
+  EXPECT_FALSE(vc::parse_daemon_config(path).has_value());
+}
+
+TEST(daemon_config_test, unknown_log_level) {
+  const auto path = write_config("daemon_bad_level.yml", R"~(
+daemon:
+  log_level: verbose
+  server:
+    port: 12000
+)~");
+
+  EXPECT_FALSE(vc::parse_daemon_config(path).has_value());
+}
+
+TEST(daemon_config_test, too_small_log_queue) {
+  const auto path = write_config("daemon_small_queue.yml", R"~(
+daemon:
+  log_queue_capacity: 1
+  server:
+    port: 12000
+)~");
+
+  EXPECT_FALSE(vc::parse_daemon_config(path).has_value());
+}
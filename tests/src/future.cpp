@@ -0,0 +1,105 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "future.hpp"
+
+TEST(future_test, make_ready) {
+  auto f = vc::future<int>::make_ready(42);
+
+  ASSERT_TRUE(f.is_ready());
+  EXPECT_EQ(42, *f.get());
+
+  int seen = 0;
+  f.then([&seen](const vc::future<int>::result_type& result) {
+    seen = *result;
+  });
+
+  EXPECT_EQ(42, seen);
+}
+
+TEST(future_test, then_before_fulfilled) {
+  vc::promise<std::string> p;
+  auto f = p.get_future();
+
+  EXPECT_FALSE(f.is_ready());
+
+  std::string seen;
+  f.then([&seen](const vc::future<std::string>::result_type& result) {
+    seen = *result;
+  });
+
+  EXPECT_TRUE(seen.empty());
+
+  p.set_result(std::string("done"));
+
+  EXPECT_EQ("done", seen);
+  EXPECT_TRUE(f.is_ready());
+}
+
+TEST(future_test, error) {
+  vc::promise<int> p;
+  auto f = p.get_future();
+
+  p.set_result(VC_UNEXPECTED("failed"));
+
+  ASSERT_TRUE(f.is_ready());
+  EXPECT_FALSE(f.get().has_value());
+}
+
+TEST(future_test, then_returns_value) {
+  vc::promise<int> p;
+
+  auto doubled = p.get_future().then(
+    [](const vc::future<int>::result_type& result) { return *result * 2; });
+
+  EXPECT_FALSE(doubled.is_ready());
+
+  p.set_result(21);
+
+  ASSERT_TRUE(doubled.is_ready());
+  EXPECT_EQ(42, *doubled.get());
+}
+
+TEST(future_test, then_returns_future) {
+  vc::promise<int> first;
+  vc::promise<std::string> second;
+
+  auto chained = first.get_future().then(
+    [&second](const vc::future<int>::result_type& result) {
+      return result.has_value()
+               ? second.get_future()
+               : vc::future<std::string>::make_ready(
+                 tl::make_unexpected(result.error()));
+    });
+
+  first.set_result(1);
+
+  EXPECT_FALSE(chained.is_ready());
+
+  second.set_result(std::string("done"));
+
+  ASSERT_TRUE(chained.is_ready());
+  EXPECT_EQ("done", *chained.get());
+}
+
+TEST(future_test, then_passes_error_along) {
+  vc::promise<int> p;
+
+  auto chained = p.get_future()
+                   .then([](const vc::future<int>::result_type& result)
+                           -> tl::expected<int, vc::error> {
+                     if (!result.has_value())
+                       return tl::make_unexpected(result.error());
+
+                     return *result + 1;
+                   })
+                   .then([](const vc::future<int>::result_type& result) {
+                     EXPECT_FALSE(result.has_value());
+                   });
+
+  p.set_result(VC_UNEXPECTED("failed"));
+
+  ASSERT_TRUE(chained.is_ready());
+  EXPECT_TRUE(chained.get().has_value());
+}
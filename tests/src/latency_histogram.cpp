@@ -0,0 +1,80 @@
+#include <cstdint>
+
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "latency_histogram.hpp"
+
+TEST(latency_histogram_test, empty) {
+  const auto histogram = std::make_unique<vc::latency_histogram>();
+
+  EXPECT_EQ(0U, histogram->count());
+  EXPECT_EQ(0U, histogram->max());
+  EXPECT_EQ(0U, histogram->value_at_percentile(50.0));
+}
+
+TEST(latency_histogram_test, bucket_index_round_trips) {
+  for (uint64_t value : {uint64_t(0), uint64_t(1), uint64_t(31), uint64_t(32),
+                         uint64_t(33), uint64_t(1000), uint64_t(123456789),
+                         std::numeric_limits<uint64_t>::max()}) {
+    const auto index = vc::latency_histogram::bucket_index(value);
+
+    ASSERT_LT(index, vc::latency_histogram::bucket_count);
+
+    const auto upper = vc::latency_histogram::bucket_upper_bound(index);
+
+    EXPECT_GE(upper, value);
+    // The relative error is bounded by 2^-sub_bucket_bits.
+    EXPECT_LE(upper - value, value >> vc::latency_histogram::sub_bucket_bits);
+  }
+}
+
+TEST(latency_histogram_test, percentiles) {
+  const auto histogram = std::make_unique<vc::latency_histogram>();
+
+  for (uint64_t value = 1; value <= 10000; ++value)
+    histogram->record(value);
+
+  EXPECT_EQ(10000U, histogram->count());
+  EXPECT_EQ(10000U, histogram->max());
+
+  const auto p50 = histogram->value_at_percentile(50.0);
+  EXPECT_GE(p50, 5000U);
+  EXPECT_LE(p50, 5000U + 5000U / 32U);
+
+  const auto p99 = histogram->value_at_percentile(99.0);
+  EXPECT_GE(p99, 9900U);
+  EXPECT_LE(p99, 10000U);
+
+  EXPECT_EQ(10000U, histogram->value_at_percentile(100.0));
+
+  histogram->reset();
+
+  EXPECT_EQ(0U, histogram->count());
+  EXPECT_EQ(0U, histogram->max());
+}
+
+TEST(latency_histogram_test, concurrent_recording) {
+  const auto histogram = std::make_unique<vc::latency_histogram>();
+
+  constexpr auto thread_count = 4;
+  constexpr uint64_t values_per_thread = 10000;
+
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < thread_count; ++i)
+    threads.emplace_back([&histogram] {
+      for (uint64_t value = 0; value < values_per_thread; ++value)
+        histogram->record(value);
+    });
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(thread_count * values_per_thread, histogram->count());
+  EXPECT_EQ(values_per_thread - 1U, histogram->max());
+}
@@ -0,0 +1,31 @@
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "load_report.hpp"
+
+TEST(load_report_test, nearest_rank) {
+  std::vector<uint64_t> values(100);
+  std::iota(values.begin(), values.end(), 1U);
+
+  EXPECT_EQ(1U, vc::nearest_rank(values, 0.0));
+  EXPECT_EQ(50U, vc::nearest_rank(values, 50.0));
+  EXPECT_EQ(99U, vc::nearest_rank(values, 99.0));
+  EXPECT_EQ(100U, vc::nearest_rank(values, 99.9));
+  EXPECT_EQ(100U, vc::nearest_rank(values, 100.0));
+  EXPECT_EQ(0U, vc::nearest_rank({}, 50.0));
+}
+
+TEST(load_report_test, make_load_report) {
+  const vc::load_report report = vc::make_load_report(
+    {40, 10, 30, 20}, 5, 1, std::chrono::seconds(2));
+
+  EXPECT_EQ(5U, report.sent_count);
+  EXPECT_EQ(4U, report.received_count);
+  EXPECT_EQ(1U, report.error_count);
+  EXPECT_DOUBLE_EQ(2.0, report.throughput);
+  EXPECT_EQ(20U, report.latency_p50_us);
+  EXPECT_EQ(40U, report.latency_p99_us);
+  EXPECT_EQ(40U, report.latency_max_us);
+}
@@ -0,0 +1,162 @@
+#include <memory>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.hpp"
+
+namespace {
+class recording_sink : public vc::log_sink {
+public:
+  explicit recording_sink(std::vector<vc::log_record>& records)
+    : records_(&records) {
+  }
+
+  void write(const vc::log_record& record) override {
+    records_->push_back(record);
+  }
+
+  void flush() override {
+  }
+
+private:
+  std::vector<vc::log_record>* records_;
+};
+
+vc::logger_options quiet_options() {
+  vc::logger_options options;
+  options.echo_to_stdout = false;
+  return options;
+}
+} // namespace
+
+TEST(logger_test, writes_enabled_levels) {
+  std::vector<vc::log_record> records;
+  vc::logger l(std::make_unique<recording_sink>(records), quiet_options());
+  const vc::actor_id aid(1);
+  const vc::vector_timestamp vstamp(aid);
+
+  VC_LOG_INFO(l, vstamp, aid, "info {}", 1);
+  VC_LOG_ERROR(l, vstamp, aid, "error {}", 2);
+
+  ASSERT_EQ(2U, records.size());
+  EXPECT_EQ(vc::log_level::info, records[0].level);
+  EXPECT_EQ("info 1", records[0].message);
+  EXPECT_EQ(vc::log_level::error, records[1].level);
+  EXPECT_EQ("error 2", records[1].message);
+}
+
+TEST(logger_test, disabled_levels_dont_evaluate_arguments) {
+  std::vector<vc::log_record> records;
+  vc::logger l(std::make_unique<recording_sink>(records), quiet_options());
+  const vc::actor_id aid(1);
+  const vc::vector_timestamp vstamp(aid);
+  int evaluations = 0;
+  const auto expensive = [&evaluations] {
+    ++evaluations;
+    return std::string("expensive");
+  };
+
+  VC_LOG_DEBUG(l, vstamp, aid, "{}", expensive());
+
+  EXPECT_TRUE(records.empty());
+  EXPECT_EQ(0, evaluations);
+
+  l.set_level(vc::log_level::trace);
+  EXPECT_EQ(vc::log_level::trace, l.level());
+
+  VC_LOG_DEBUG(l, vstamp, aid, "{}", expensive());
+
+  ASSERT_EQ(1U, records.size());
+  EXPECT_EQ("expensive", records[0].message);
+  EXPECT_EQ(1, evaluations);
+}
+
+TEST(logger_test, per_thread_buffers_keep_causal_order) {
+  constexpr uint64_t message_count = 1000;
+  std::vector<vc::log_record> records;
+
+  {
+    auto options = quiet_options();
+    options.asynchronous = true;
+    options.per_thread_buffers = true;
+    options.thread_buffer_capacity = 16;
+    vc::logger l(std::make_unique<recording_sink>(records), options);
+    std::atomic<uint64_t> sent(0);
+    std::atomic<bool> is_receiver_ready(false);
+
+    // The receiver logs the receipt of each message the sender logged. It
+    // logs first, so that its buffer is drained before the sender's one.
+    std::thread receiver([&l, &sent, &is_receiver_ready] {
+      const vc::actor_id aid(2);
+      vc::vector_timestamp vstamp(aid);
+      VC_LOG_INFO(l, vstamp, aid, "{}", "START");
+      is_receiver_ready.store(true, std::memory_order_release);
+
+      for (uint64_t i = 1; i <= message_count; ++i) {
+        while (sent.load(std::memory_order_acquire) < i)
+          std::this_thread::yield();
+
+        (void) vstamp.tick(aid);
+        vstamp.merge(
+          vc::vector_timestamp::from_entries({{vc::actor_id(1), i}}));
+        VC_LOG_INFO(l, vstamp, aid, "RECV {}", i);
+      }
+    });
+
+    while (!is_receiver_ready.load(std::memory_order_acquire))
+      std::this_thread::yield();
+
+    const vc::actor_id aid(1);
+    vc::vector_timestamp vstamp(aid);
+
+    for (uint64_t i = 1; i <= message_count; ++i) {
+      (void) vstamp.tick(aid);
+      VC_LOG_INFO(l, vstamp, aid, "SEND {}", i);
+      sent.store(i, std::memory_order_release);
+    }
+
+    receiver.join();
+  }
+
+  ASSERT_EQ(2 * message_count + 1, records.size());
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    for (size_t j = i + 1; j < records.size(); ++j) {
+      ASSERT_FALSE(records[j].vstamp.happened_before(records[i].vstamp))
+        << records[j].message << " was written after " << records[i].message;
+    }
+  }
+}
+
+TEST(logger_test, per_thread_buffers_outlive_their_threads) {
+  constexpr uint64_t thread_count = 50;
+  std::vector<vc::log_record> records;
+
+  {
+    auto options = quiet_options();
+    options.asynchronous = true;
+    options.per_thread_buffers = true;
+    options.thread_buffer_capacity = 16;
+    vc::logger l(std::make_unique<recording_sink>(records), options);
+
+    // Each thread exits right after logging, its buffer is dropped once the
+    // writer thread has drained it.
+    for (uint64_t i = 1; i <= thread_count; ++i) {
+      std::thread([&l, i] {
+        const vc::actor_id aid(i);
+        vc::vector_timestamp vstamp(aid);
+
+        for (int j = 0; j < 20; ++j) {
+          (void) vstamp.tick(aid);
+          VC_LOG_INFO(l, vstamp, aid, "{}", j);
+        }
+      }).join();
+    }
+  }
+
+  EXPECT_EQ(thread_count * 20, records.size());
+}
@@ -0,0 +1,72 @@
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "mesh_config.hpp"
+
+namespace {
+std::string write_config(const std::string& file_name,
+                         const std::string& contents) {
+  const auto path = ::testing::TempDir() + file_name;
+  std::ofstream ofs(path, std::ios_base::out | std::ios_base::trunc);
+  ofs << contents;
+  return path;
+}
+} // namespace
+
+TEST(mesh_config_test, without_mesh_section) {
+  const auto path = write_config("no_mesh.yml", "disabled: false\n");
+
+  const auto exp = vc::parse_mesh_config(path);
+
+  ASSERT_TRUE(exp.has_value());
+  EXPECT_FALSE(exp->has_value());
+}
+
+TEST(mesh_config_test, with_mesh_section) {
+  const auto path = write_config("mesh.yml", R"~(
+mesh:
+  actor_id: 3
+  port: 20003
+  fanout: 1
+  gossip_interval_ms: 250
+  peers:
+    - port: 20001
+    - host: 10.0.0.2
+      port: 20002
+)~");
+
+  const auto exp = vc::parse_mesh_config(path);
+
+  ASSERT_TRUE(exp.has_value());
+  ASSERT_TRUE(exp->has_value());
+
+  const auto& config = **exp;
+
+  EXPECT_EQ(vc::actor_id{3}, config.aid);
+  EXPECT_EQ("127.0.0.1", config.host);
+  EXPECT_EQ(20003, config.port);
+  EXPECT_EQ(1U, config.fanout);
+  EXPECT_EQ(std::chrono::milliseconds(250), config.gossip_interval);
+  EXPECT_EQ(std::chrono::milliseconds(50), config.merge_interval);
+  EXPECT_EQ("mesh_actor3.log", config.log_file);
+
+  ASSERT_EQ(2U, config.peers.size());
+  EXPECT_EQ("127.0.0.1", config.peers[0].host);
+  EXPECT_EQ(20001, config.peers[0].port);
+  EXPECT_EQ("10.0.0.2", config.peers[1].host);
+  EXPECT_EQ(20002, config.peers[1].port);
+}
+
+TEST(mesh_config_test, missing_port) {
+  const auto path = write_config("mesh_missing_port.yml",
+                                 "mesh:\n  actor_id: 1\n");
+
+  const auto exp = vc::parse_mesh_config(path);
+
+  ASSERT_FALSE(exp.has_value());
+
+  EXPECT_EQ(std::string("The mesh section requires actor_id and port."),
+            exp.error().message().substr(0, 44));
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metrics.hpp"
+
+TEST(metrics_test, counter_sums_shards_of_all_threads) {
+  constexpr size_t thread_count = 4;
+  constexpr uint64_t increments = 10000;
+
+  vc::counter c;
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < thread_count; ++i)
+    threads.emplace_back([&c] {
+      for (uint64_t j = 0; j < increments; ++j)
+        c.add();
+    });
+
+  for (auto& t : threads)
+    t.join();
+
+  EXPECT_EQ(thread_count * increments, c.value());
+}
+
+TEST(metrics_test, histogram_buckets) {
+  vc::histogram h({1, 4, 16});
+
+  for (const uint64_t value : {0U, 1U, 2U, 4U, 5U, 100U})
+    h.observe(value);
+
+  EXPECT_EQ((std::vector<uint64_t>{2, 4, 5, 6}), h.cumulative_counts());
+  EXPECT_EQ(112U, h.sum());
+}
+
+TEST(metrics_test, exponential_buckets) {
+  EXPECT_EQ((std::vector<uint64_t>{1, 4, 16, 64}),
+            vc::exponential_buckets(1, 4, 4));
+}
+
+TEST(metrics_test, registry_returns_registered_metric) {
+  vc::metrics_registry registry;
+
+  auto& first = registry.add_counter("requests_total", "Requests.");
+  auto& second = registry.add_counter("requests_total", "Ignored.");
+
+  EXPECT_EQ(&first, &second);
+}
+
+TEST(metrics_test, prometheus_format) {
+  vc::metrics_registry registry;
+
+  registry.add_counter("requests_total", "Requests handled.").add(3);
+  registry.add_gauge("clock_entries", "Entries of the clock.").set(-2);
+  registry.add_histogram("merge_entries", "Entries merged.", {1, 8})
+    .observe(5);
+
+  EXPECT_EQ("# HELP clock_entries Entries of the clock.\n"
+            "# TYPE clock_entries gauge\n"
+            "clock_entries -2\n"
+            "# HELP merge_entries Entries merged.\n"
+            "# TYPE merge_entries histogram\n"
+            "merge_entries_bucket{le=\"1\"} 0\n"
+            "merge_entries_bucket{le=\"8\"} 1\n"
+            "merge_entries_bucket{le=\"+Inf\"} 1\n"
+            "merge_entries_sum 5\n"
+            "merge_entries_count 1\n"
+            "# HELP requests_total Requests handled.\n"
+            "# TYPE requests_total counter\n"
+            "requests_total 3\n",
+            registry.to_prometheus());
+}
+
+TEST(metrics_test, prometheus_format_of_labelled_series) {
+  vc::metrics_registry registry;
+
+  auto& first = registry.add_gauge("clock_entries", "Entries of the clock.",
+                                   "actor_id=\"1\"");
+  auto& second = registry.add_gauge("clock_entries", "Ignored.",
+                                    "actor_id=\"2\"");
+  EXPECT_NE(&first, &second);
+  EXPECT_EQ(&first, &registry.add_gauge("clock_entries", "Ignored.",
+                                        "actor_id=\"1\""));
+
+  first.set(3);
+  second.set(4);
+  registry
+    .add_histogram("merge_entries", "Entries merged.", {8}, "actor_id=\"1\"")
+    .observe(5);
+
+  EXPECT_EQ("# HELP clock_entries Entries of the clock.\n"
+            "# TYPE clock_entries gauge\n"
+            "clock_entries{actor_id=\"1\"} 3\n"
+            "clock_entries{actor_id=\"2\"} 4\n"
+            "# HELP merge_entries Entries merged.\n"
+            "# TYPE merge_entries histogram\n"
+            "merge_entries_bucket{actor_id=\"1\",le=\"8\"} 1\n"
+            "merge_entries_bucket{actor_id=\"1\",le=\"+Inf\"} 1\n"
+            "merge_entries_sum{actor_id=\"1\"} 5\n"
+            "merge_entries_count{actor_id=\"1\"} 1\n",
+            registry.to_prometheus());
+}
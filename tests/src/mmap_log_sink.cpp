@@ -0,0 +1,82 @@
+#include <cstdio>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "make_record.hpp"
+#include "mmap_log_sink.hpp"
+
+namespace {
+vc::log_record make_record(unsigned line) {
+  return vc::test::make_record(vc::actor_id{1}, {{vc::actor_id{1}, 0}},
+                               "message", line);
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+std::string expected_segment(unsigned first_line, unsigned line_count) {
+  std::string result = std::string(vc::shiviz_regex) + "\n\n";
+
+  for (unsigned i = 0; i < line_count; ++i)
+    result += vc::to_shiviz(make_record(first_line + i)) + '\n';
+
+  return result;
+}
+} // namespace
+
+TEST(mmap_log_sink_test, segment_path) {
+  EXPECT_EQ("a.log", vc::mmap_log_sink::segment_path("a.log", 0));
+  EXPECT_EQ("a.log.2", vc::mmap_log_sink::segment_path("a.log", 2));
+}
+
+TEST(mmap_log_sink_test, trims_segment) {
+  const auto path = ::testing::TempDir() + "mmap_trim.log";
+  std::remove(path.c_str());
+
+  {
+    auto exp = vc::mmap_log_sink::create({path, 4096, 2});
+    ASSERT_TRUE(exp.has_value()) << exp.error().message();
+
+    (*exp)->write(make_record(1));
+    (*exp)->write(make_record(2));
+  }
+
+  EXPECT_EQ(expected_segment(1, 2), read_file(path));
+}
+
+TEST(mmap_log_sink_test, rotates_by_size) {
+  const auto path = ::testing::TempDir() + "mmap_rotate.log";
+  const auto segment_byte_count = expected_segment(1, 2).size();
+
+  for (size_t i = 0; i < 4; ++i)
+    std::remove(vc::mmap_log_sink::segment_path(path, i).c_str());
+
+  {
+    auto exp = vc::mmap_log_sink::create({path, segment_byte_count, 3});
+    ASSERT_TRUE(exp.has_value()) << exp.error().message();
+
+    // Two entries fit into a segment, the oldest segment is dropped.
+    for (unsigned line = 1; line <= 7; ++line)
+      (*exp)->write(make_record(line));
+  }
+
+  EXPECT_EQ(expected_segment(7, 1), read_file(path));
+  EXPECT_EQ(expected_segment(5, 2),
+            read_file(vc::mmap_log_sink::segment_path(path, 1)));
+  EXPECT_EQ(expected_segment(3, 2),
+            read_file(vc::mmap_log_sink::segment_path(path, 2)));
+  EXPECT_FALSE(
+    std::ifstream(vc::mmap_log_sink::segment_path(path, 3)).is_open());
+}
+
+TEST(mmap_log_sink_test, no_segments) {
+  EXPECT_FALSE(vc::mmap_log_sink::create({"unused.log", 4096, 0}).has_value());
+}
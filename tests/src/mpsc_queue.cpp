@@ -0,0 +1,126 @@
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mpsc_queue.hpp"
+
+TEST(mpsc_queue_test, capacity_is_rounded_up) {
+  const vc::mpsc_queue<int> queue(5);
+
+  EXPECT_EQ(8U, queue.capacity());
+}
+
+TEST(mpsc_queue_test, capacity_of_one) {
+  vc::mpsc_queue<std::string> queue(1);
+  EXPECT_EQ(2U, queue.capacity());
+
+  EXPECT_TRUE(queue.try_push("a"));
+  EXPECT_TRUE(queue.try_push("b"));
+  EXPECT_FALSE(queue.try_push("c"));
+
+  std::string value;
+  ASSERT_TRUE(queue.try_pop(value));
+  EXPECT_EQ("a", value);
+  ASSERT_TRUE(queue.try_pop(value));
+  EXPECT_EQ("b", value);
+  EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(mpsc_queue_test, fifo) {
+  vc::mpsc_queue<std::string> queue(4);
+  std::string value;
+
+  EXPECT_FALSE(queue.try_pop(value));
+
+  EXPECT_TRUE(queue.try_push("a"));
+  EXPECT_TRUE(queue.try_push("b"));
+  EXPECT_EQ(2U, queue.size());
+
+  ASSERT_TRUE(queue.try_pop(value));
+  EXPECT_EQ("a", value);
+  ASSERT_TRUE(queue.try_pop(value));
+  EXPECT_EQ("b", value);
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_EQ(0U, queue.size());
+}
+
+TEST(mpsc_queue_test, full) {
+  vc::mpsc_queue<std::unique_ptr<int>> queue(2);
+
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(2)));
+
+  auto rejected = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_push(std::move(rejected)));
+  ASSERT_NE(nullptr, rejected);
+
+  std::unique_ptr<int> value;
+  ASSERT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(1, *value);
+
+  EXPECT_TRUE(queue.try_push(std::move(rejected)));
+}
+
+TEST(mpsc_queue_test, multiple_producers) {
+  vc::mpsc_queue<int> queue(64);
+
+  constexpr int producer_count = 4;
+  constexpr int values_per_producer = 10000;
+
+  std::vector<std::thread> producers;
+
+  for (int p = 0; p < producer_count; ++p)
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < values_per_producer; ++i) {
+        auto value = p * values_per_producer + i;
+
+        while (!queue.try_push(std::move(value)))
+          std::this_thread::yield();
+      }
+    });
+
+  // Every value must arrive exactly once, in order per producer.
+  std::vector<int> next(producer_count, 0);
+  int received = 0;
+
+  while (received < producer_count * values_per_producer) {
+    int value;
+
+    if (!queue.try_pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const auto p = value / values_per_producer;
+    ASSERT_EQ(next[p], value % values_per_producer);
+    ++next[p];
+    ++received;
+  }
+
+  for (auto& producer : producers)
+    producer.join();
+}
+
+TEST(mpsc_queue_test, try_consume) {
+  struct no_default {
+    explicit no_default(int v) : value(v) {
+    }
+
+    int value;
+  };
+
+  vc::mpsc_queue<no_default> queue(2);
+  int consumed = 0;
+
+  EXPECT_FALSE(queue.try_consume([&consumed](no_default&& x) {
+    consumed = x.value;
+  }));
+  EXPECT_TRUE(queue.try_push(no_default(42)));
+  EXPECT_TRUE(queue.try_consume([&consumed](no_default&& x) {
+    consumed = x.value;
+  }));
+  EXPECT_EQ(42, consumed);
+}
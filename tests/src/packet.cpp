@@ -1,7 +1,12 @@
+#include <cstddef>
 #include <cstring>
 
+#include <array>
+#include <memory_resource>
+
 #include <gtest/gtest.h>
 
+#include "default_resource_guard.hpp"
 #include "packet.hpp"
 
 constexpr pl::byte vstamp[40] = {
@@ -18,9 +23,13 @@ constexpr pl::byte vstamp[40] = {
 
 constexpr char payload[13] = "Hello World!";
 
-constexpr pl::byte
-  buf[sizeof(uint64_t) + sizeof(vstamp) + sizeof(uint64_t) + sizeof(payload)]
+constexpr pl::byte buf[vc::packet::header_byte_count + sizeof(uint64_t)
+                      + sizeof(vstamp) + sizeof(uint64_t) + sizeof(payload)]
   = {
+    /* opcode */
+    0x00, 0x02,
+    /* flags */
+    0x00, 0x01,
     /* vstamp_size */
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x28,
     /* pair count */
@@ -40,7 +49,8 @@ constexpr pl::byte
     0x00};
 
 TEST(packet, it_should_construct) {
-  const vc::packet pkt(vstamp, sizeof(vstamp), payload, sizeof(payload));
+  const vc::packet pkt(vc::opcode::echo, vc::packet::response_flag, vstamp,
+                       sizeof(vstamp), payload, sizeof(payload));
 
   EXPECT_EQ(0, memcmp(pkt.vstamp_buffer().data(), vstamp, sizeof(vstamp)));
   EXPECT_EQ(0, memcmp(pkt.payload_buffer().data(), payload, sizeof(payload)));
@@ -53,6 +63,8 @@ TEST(packet, it_should_deserialize) {
 
   const auto pkt = *exp;
 
+  EXPECT_EQ(vc::opcode::echo, pkt.op());
+  EXPECT_EQ(vc::packet::response_flag, pkt.flags());
   EXPECT_EQ(0, memcmp(pkt.vstamp_buffer().data(), vstamp, sizeof(vstamp)));
   EXPECT_EQ(0, memcmp(pkt.payload_buffer().data(), payload, sizeof(payload)));
 }
@@ -70,7 +82,7 @@ TEST(packet, it_should_not_deserialize_an_empty_timestamp) {
   pl::byte buffer[sizeof(buf)];
   memcpy(buffer, buf, sizeof(buf));
 
-  memset(buffer, 0, sizeof(uint64_t));
+  memset(buffer + vc::packet::header_byte_count, 0, sizeof(uint64_t));
 
   const auto exp = vc::packet::deserialize_from_binary(buffer, sizeof(buffer));
 
@@ -84,7 +96,7 @@ TEST(packet, it_should_not_deserialize_an_empty_payload) {
   pl::byte buffer[sizeof(buf)];
   memcpy(buffer, buf, sizeof(buf));
 
-  memset(buffer + 48, 0, sizeof(uint64_t));
+  memset(buffer + vc::packet::header_byte_count + 48, 0, sizeof(uint64_t));
 
   const auto exp = vc::packet::deserialize_from_binary(buffer, sizeof(buffer));
 
@@ -94,20 +106,59 @@ TEST(packet, it_should_not_deserialize_an_empty_payload) {
             exp.error().message().substr(0, 34));
 }
 
+TEST(packet, it_should_not_deserialize_a_truncated_timestamp) {
+  pl::byte buffer[sizeof(buf)];
+  memcpy(buffer, buf, sizeof(buf));
+
+  // A size that would overflow if added to the offset.
+  memset(buffer + vc::packet::header_byte_count, 0xFF, sizeof(uint64_t));
+
+  const auto exp = vc::packet::deserialize_from_binary(buffer, sizeof(buffer));
+
+  ASSERT_FALSE(exp.has_value());
+  EXPECT_EQ(vc::errc::truncated_vstamp, exp.error().code());
+}
+
+TEST(packet, it_should_not_deserialize_a_truncated_payload) {
+  const auto exp = vc::packet::deserialize_from_binary(buf, sizeof(buf) - 1);
+
+  ASSERT_FALSE(exp.has_value());
+  EXPECT_EQ(vc::errc::truncated_payload, exp.error().code());
+  EXPECT_NE(std::string::npos, exp.error().message().find("packet.cpp"));
+}
+
+TEST(packet, it_should_return_the_header) {
+  const vc::packet request(vc::opcode::time, 0, vstamp, sizeof(vstamp),
+                           payload, sizeof(payload));
+
+  EXPECT_EQ(vc::opcode::time, request.op());
+  EXPECT_EQ(0, request.flags());
+  EXPECT_FALSE(request.is_response());
+
+  const vc::packet response(vc::opcode::time, vc::packet::response_flag,
+                            vstamp, sizeof(vstamp), payload, sizeof(payload));
+
+  EXPECT_EQ(vc::opcode::time, response.op());
+  EXPECT_TRUE(response.is_response());
+}
+
 TEST(packet, it_should_return_the_vstamp_buffer) {
-  const vc::packet pkt(vstamp, sizeof(vstamp), payload, sizeof(payload));
+  const vc::packet pkt(vc::opcode::echo, vc::packet::response_flag, vstamp,
+                       sizeof(vstamp), payload, sizeof(payload));
 
   EXPECT_EQ(0, memcmp(pkt.vstamp_buffer().data(), vstamp, sizeof(vstamp)));
 }
 
 TEST(packet, it_should_return_the_payload_buffer) {
-  const vc::packet pkt(vstamp, sizeof(vstamp), payload, sizeof(payload));
+  const vc::packet pkt(vc::opcode::echo, vc::packet::response_flag, vstamp,
+                       sizeof(vstamp), payload, sizeof(payload));
 
   EXPECT_EQ(0, memcmp(pkt.payload_buffer().data(), payload, sizeof(payload)));
 }
 
 TEST(packet, it_should_serialize_to_binary) {
-  const vc::packet pkt(vstamp, sizeof(vstamp), payload, sizeof(payload));
+  const vc::packet pkt(vc::opcode::echo, vc::packet::response_flag, vstamp,
+                       sizeof(vstamp), payload, sizeof(payload));
 
   const auto result = pkt.serialize_to_binary();
 
@@ -122,8 +173,75 @@ TEST(packet, it_should_serialize_to_binary) {
 
   const auto deserialized_packet = *exp;
 
+  EXPECT_EQ(pkt.op(), deserialized_packet.op());
+  EXPECT_EQ(pkt.flags(), deserialized_packet.flags());
   EXPECT_EQ(0, memcmp(deserialized_packet.vstamp_buffer().data(), vstamp,
                       sizeof(vstamp)));
   EXPECT_EQ(0, memcmp(deserialized_packet.payload_buffer().data(), payload,
                       sizeof(payload)));
 }
+
+TEST(packet, it_should_roundtrip_a_trace_context) {
+  constexpr char trace_context[] = "trace";
+
+  vc::packet pkt(vc::opcode::echo, 0, vstamp, sizeof(vstamp), payload,
+                 sizeof(payload));
+
+  EXPECT_FALSE(pkt.has_trace_context());
+
+  pkt.set_trace_context(trace_context, sizeof(trace_context));
+
+  EXPECT_TRUE(pkt.has_trace_context());
+  EXPECT_EQ(vc::packet::trace_context_flag, pkt.flags());
+
+  const auto result = pkt.serialize_to_binary();
+
+  ASSERT_EQ(sizeof(buf) + sizeof(uint16_t) + sizeof(trace_context),
+            result.size());
+
+  const auto exp = vc::packet::deserialize_from_binary(result.data(),
+                                                       result.size());
+
+  ASSERT_TRUE(exp.has_value());
+  ASSERT_TRUE(exp->has_trace_context());
+  ASSERT_EQ(sizeof(trace_context), exp->trace_context_buffer().size());
+  EXPECT_EQ(0, memcmp(exp->trace_context_buffer().data(), trace_context,
+                      sizeof(trace_context)));
+
+  // The trace context must not be truncated.
+  EXPECT_FALSE(
+    vc::packet::deserialize_from_binary(result.data(), result.size() - 1)
+      .has_value());
+}
+
+TEST(packet, it_should_return_the_vstamp_byte_order) {
+  const vc::packet big(vc::opcode::echo, vc::packet::response_flag, vstamp,
+                       sizeof(vstamp), payload, sizeof(payload));
+
+  EXPECT_EQ(vc::byte_order::big_endian, big.vstamp_byte_order());
+
+  const vc::packet little(vc::opcode::echo,
+                          vc::packet::response_flag
+                            | vc::packet::little_endian_vstamp_flag,
+                          vstamp, sizeof(vstamp), payload, sizeof(payload));
+
+  EXPECT_EQ(vc::byte_order::little_endian, little.vstamp_byte_order());
+}
+
+TEST(packet, it_should_deserialize_into_an_arena) {
+  std::array<std::byte, 1024> storage;
+  std::pmr::monotonic_buffer_resource arena(
+    storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+  const auto exp = [&arena] {
+    // Any allocation that bypasses the arena throws.
+    const vc::test::default_resource_guard guard(
+      std::pmr::null_memory_resource());
+    return vc::packet::deserialize_from_binary(buf, sizeof(buf), &arena);
+  }();
+
+  ASSERT_TRUE(exp.has_value());
+  EXPECT_EQ(&arena, exp->vstamp_buffer().get_allocator().resource());
+  EXPECT_EQ(0, memcmp(exp->payload_buffer().data(), payload,
+                      sizeof(payload)));
+}
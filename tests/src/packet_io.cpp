@@ -0,0 +1,146 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <vector>
+
+#include <QBuffer>
+#include <QByteArray>
+
+#include <gtest/gtest.h>
+
+#include "packet_io.hpp"
+
+namespace {
+/**
+ * Builds the start of a packet, allowing for any length fields.
+ */
+class frame_builder {
+public:
+  frame_builder& u16(uint16_t value) {
+    for (int shift = 8; shift >= 0; shift -= 8)
+      bytes_.push_back(static_cast<char>((value >> shift) & 0xFFU));
+
+    return *this;
+  }
+
+  frame_builder& u64(uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8)
+      bytes_.push_back(static_cast<char>((value >> shift) & 0xFFU));
+
+    return *this;
+  }
+
+  frame_builder& fill(size_t byte_count) {
+    bytes_.insert(bytes_.end(), byte_count, 0x01);
+    return *this;
+  }
+
+  [[nodiscard]] QByteArray bytes() const {
+    return QByteArray(bytes_.data(), static_cast<int>(bytes_.size()));
+  }
+
+private:
+  std::vector<char> bytes_;
+};
+
+constexpr auto unlimited = std::numeric_limits<uint64_t>::max();
+constexpr uint16_t echo_op = 2;
+
+vc::errc check_error(const QByteArray& frame, uint64_t max_byte_count) {
+  auto bytes = frame;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::ReadOnly);
+
+  const auto exp_complete = vc::has_complete_packet(buffer, max_byte_count);
+  return exp_complete.has_value() ? vc::errc::generic
+                                  : exp_complete.error().code();
+}
+
+bool check_complete(const QByteArray& frame, uint64_t max_byte_count) {
+  auto bytes = frame;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::ReadOnly);
+
+  const auto exp_complete = vc::has_complete_packet(buffer, max_byte_count);
+  EXPECT_TRUE(exp_complete.has_value());
+  return exp_complete.has_value() && *exp_complete;
+}
+} // namespace
+
+TEST(packet_io_test, incomplete_packets) {
+  EXPECT_FALSE(check_complete(frame_builder().u16(echo_op).bytes(), 1000));
+  EXPECT_FALSE(
+    check_complete(frame_builder().u16(echo_op).u16(0).u64(16).fill(16).bytes(),
+                   1000));
+  EXPECT_FALSE(check_complete(
+    frame_builder().u16(echo_op).u16(0).u64(16).fill(16).u64(4).fill(3).bytes(),
+    1000));
+}
+
+TEST(packet_io_test, complete_packet) {
+  EXPECT_TRUE(check_complete(
+    frame_builder().u16(echo_op).u16(0).u64(16).fill(16).u64(4).fill(4).bytes(),
+    1000));
+}
+
+TEST(packet_io_test, hostile_vstamp_sizes) {
+  // Would wrap an offset of type qint64 or uint64_t.
+  for (const auto vstamp_size :
+       {std::numeric_limits<uint64_t>::max(),
+        uint64_t(std::numeric_limits<int64_t>::max()),
+        std::numeric_limits<uint64_t>::max() - 19U,
+        vc::max_packet_byte_count + 1U}) {
+    EXPECT_EQ(vc::errc::vstamp_too_large,
+              check_error(
+                frame_builder().u16(echo_op).u16(0).u64(vstamp_size).bytes(),
+                unlimited));
+  }
+
+  EXPECT_EQ(vc::errc::vstamp_too_large,
+            check_error(frame_builder().u16(echo_op).u16(0).u64(101).bytes(),
+                        100));
+}
+
+TEST(packet_io_test, hostile_payload_sizes) {
+  for (const auto payload_size :
+       {std::numeric_limits<uint64_t>::max(),
+        std::numeric_limits<uint64_t>::max() - 35U,
+        vc::max_packet_byte_count + 1U}) {
+    EXPECT_EQ(vc::errc::payload_too_large,
+              check_error(frame_builder()
+                            .u16(echo_op)
+                            .u16(0)
+                            .u64(16)
+                            .fill(16)
+                            .u64(payload_size)
+                            .bytes(),
+                          unlimited));
+  }
+}
+
+TEST(packet_io_test, sizes_exceeding_the_limit_together) {
+  // Neither size exceeds the limit, their sum does.
+  EXPECT_EQ(vc::errc::packet_too_large,
+            check_error(frame_builder()
+                          .u16(echo_op)
+                          .u16(0)
+                          .u64(600)
+                          .fill(600)
+                          .u64(600)
+                          .bytes(),
+                        1000));
+
+  // The trace context pushes the packet over the limit.
+  const auto frame = frame_builder()
+                       .u16(echo_op)
+                       .u16(vc::packet::trace_context_flag)
+                       .u64(16)
+                       .fill(16)
+                       .u64(16)
+                       .fill(16)
+                       .u16(std::numeric_limits<uint16_t>::max())
+                       .bytes();
+  EXPECT_EQ(vc::errc::packet_too_large, check_error(frame, 1000));
+  EXPECT_FALSE(check_complete(frame, unlimited));
+}
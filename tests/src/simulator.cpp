@@ -0,0 +1,145 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "simulator.hpp"
+
+namespace {
+vc::sim_options small_options(uint64_t seed) {
+  vc::sim_options options;
+  options.seed = seed;
+  options.server_count = 2;
+  options.client_count = 20;
+  options.request_interval = vc::sim_time(1000);
+  options.sample_interval = vc::sim_time(10000);
+  options.network.min_latency = vc::sim_time(50);
+  options.network.max_latency = vc::sim_time(500);
+  options.network.loss_probability = 0.05;
+  options.network.reorder_probability = 0.1;
+  options.network.reorder_delay = vc::sim_time(2000);
+  return options;
+}
+
+void expect_same_stats(const vc::sim_stats& lhs, const vc::sim_stats& rhs) {
+  EXPECT_EQ(lhs.event_count, rhs.event_count);
+  EXPECT_EQ(lhs.sent_count, rhs.sent_count);
+  EXPECT_EQ(lhs.delivered_count, rhs.delivered_count);
+  EXPECT_EQ(lhs.dropped_count, rhs.dropped_count);
+  EXPECT_EQ(lhs.reordered_count, rhs.reordered_count);
+  EXPECT_EQ(lhs.decode_failures, rhs.decode_failures);
+  EXPECT_EQ(lhs.merge_count, rhs.merge_count);
+  EXPECT_EQ(lhs.merged_entries, rhs.merged_entries);
+  EXPECT_EQ(lhs.sent_bytes, rhs.sent_bytes);
+}
+} // namespace
+
+TEST(simulator_test, same_seed_same_outcome) {
+  vc::simulator first(small_options(42));
+  vc::simulator second(small_options(42));
+
+  first.run_until(vc::sim_time(100000));
+  second.run_until(vc::sim_time(100000));
+
+  EXPECT_EQ(first.fingerprint(), second.fingerprint());
+  expect_same_stats(first.stats(), second.stats());
+  ASSERT_EQ(first.clock_samples().size(), second.clock_samples().size());
+
+  for (size_t i = 0; i < first.clock_samples().size(); ++i) {
+    EXPECT_EQ(first.clock_samples()[i].at, second.clock_samples()[i].at);
+    EXPECT_EQ(first.clock_samples()[i].max_entries,
+              second.clock_samples()[i].max_entries);
+  }
+}
+
+TEST(simulator_test, run_in_steps) {
+  vc::simulator whole(small_options(7));
+  vc::simulator steps(small_options(7));
+
+  whole.run_until(vc::sim_time(50000));
+
+  for (int i = 1; i <= 10; ++i)
+    steps.run_until(vc::sim_time(i * 5000));
+
+  EXPECT_EQ(vc::sim_time(50000), steps.now());
+  EXPECT_EQ(whole.fingerprint(), steps.fingerprint());
+  expect_same_stats(whole.stats(), steps.stats());
+}
+
+TEST(simulator_test, different_seed_different_outcome) {
+  vc::simulator first(small_options(1));
+  vc::simulator second(small_options(2));
+
+  first.run_until(vc::sim_time(100000));
+  second.run_until(vc::sim_time(100000));
+
+  EXPECT_NE(first.fingerprint(), second.fingerprint());
+}
+
+TEST(simulator_test, total_loss) {
+  auto options = small_options(3);
+  options.network.loss_probability = 1.0;
+  vc::simulator sim(options);
+
+  sim.run_until(vc::sim_time(100000));
+
+  EXPECT_GT(sim.stats().sent_count, 0U);
+  EXPECT_EQ(sim.stats().sent_count, sim.stats().dropped_count);
+  EXPECT_EQ(0U, sim.stats().delivered_count);
+  EXPECT_EQ(0U, sim.stats().merge_count);
+
+  // Only the own entry ever gets ticked.
+  for (size_t i = 0; i < sim.actor_count(); ++i)
+    EXPECT_LE(sim.vstamp_of(i).size(), 1U);
+}
+
+TEST(simulator_test, causality) {
+  auto options = small_options(5);
+  options.network.loss_probability = 0.0;
+  vc::simulator sim(options);
+
+  sim.run_until(vc::sim_time(100000));
+
+  const auto& stats = sim.stats();
+  EXPECT_EQ(0U, stats.decode_failures);
+  EXPECT_EQ(stats.delivered_count, stats.merge_count);
+  EXPECT_GT(stats.reordered_count, 0U);
+
+  // No actor can know more about another actor than that actor itself.
+  for (size_t i = 0; i < sim.actor_count(); ++i) {
+    const vc::actor_id aid(i + 1);
+    const auto own = sim.vstamp_of(i).entries().at(aid);
+
+    for (size_t j = 0; j < sim.actor_count(); ++j) {
+      const auto& entries = sim.vstamp_of(j).entries();
+      const auto it = entries.find(aid);
+
+      if (it != entries.end())
+        EXPECT_LE(it->second, own);
+    }
+  }
+
+  // Through the clients, the servers hear of every actor.
+  EXPECT_EQ(sim.actor_count(), sim.vstamp_of(0).size());
+  ASSERT_FALSE(sim.clock_samples().empty());
+  EXPECT_GE(sim.clock_samples().back().mean_entries,
+            sim.clock_samples().front().mean_entries);
+}
+
+TEST(simulator_test, own_entry_responses_keep_client_clocks_small) {
+  auto options = small_options(6);
+  options.network.loss_probability = 0.0;
+  options.response_entries = vc::sent_entries::own;
+  vc::simulator sim(options);
+
+  sim.run_until(vc::sim_time(100000));
+
+  EXPECT_EQ(sim.stats().delivered_count, sim.stats().merge_count);
+
+  // The clients only learn of themselves and the servers, while the servers
+  // still hear of every actor.
+  for (size_t i = options.server_count; i < sim.actor_count(); ++i)
+    EXPECT_LE(sim.vstamp_of(i).size(), options.server_count + 1U);
+
+  EXPECT_EQ(sim.actor_count(), sim.vstamp_of(0).size());
+}
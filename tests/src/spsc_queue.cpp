@@ -0,0 +1,67 @@
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "spsc_queue.hpp"
+
+TEST(spsc_queue_test, capacity_is_rounded_up) {
+  const vc::spsc_queue<int> queue(3);
+
+  EXPECT_EQ(4U, queue.capacity());
+}
+
+TEST(spsc_queue_test, fifo_and_full) {
+  vc::spsc_queue<std::unique_ptr<int>> queue(2);
+  int value = 0;
+  const auto pop = [&queue, &value] {
+    return queue.try_consume(
+      [&value](std::unique_ptr<int>&& p) { value = *p; });
+  };
+
+  EXPECT_FALSE(pop());
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(2)));
+
+  auto rejected = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_push(std::move(rejected)));
+  ASSERT_NE(nullptr, rejected);
+
+  ASSERT_TRUE(pop());
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(queue.try_push(std::move(rejected)));
+  ASSERT_TRUE(pop());
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(pop());
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(pop());
+}
+
+TEST(spsc_queue_test, producer_and_consumer_threads) {
+  constexpr int count = 100000;
+  vc::spsc_queue<std::string> queue(64);
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < count; ++i) {
+      auto value = std::to_string(i);
+
+      while (!queue.try_push(std::move(value)))
+        std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+
+  while (expected < count) {
+    const auto consumed = queue.try_consume([&expected](std::string&& value) {
+      EXPECT_EQ(std::to_string(expected), value);
+      ++expected;
+    });
+
+    if (!consumed)
+      std::this_thread::yield();
+  }
+
+  producer.join();
+}
@@ -0,0 +1,86 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "trace_sampler.hpp"
+
+namespace {
+using namespace std::chrono_literals;
+
+int count_samples(vc::trace_sampler& sampler, int request_count,
+                  vc::trace_sampler::clock::time_point now) {
+  int sampled = 0;
+
+  for (int i = 0; i < request_count; ++i)
+    sampled += sampler.should_sample(now) ? 1 : 0;
+
+  return sampled;
+}
+} // namespace
+
+TEST(trace_sampler_test, always_and_never) {
+  vc::trace_sampler always({vc::sampling_mode::always, 1.0});
+  vc::trace_sampler never({vc::sampling_mode::never, 0.0});
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(always.should_sample());
+    EXPECT_FALSE(never.should_sample());
+  }
+}
+
+TEST(trace_sampler_test, probabilistic) {
+  vc::trace_sampler sampler({vc::sampling_mode::probabilistic, 0.25});
+  int sampled = 0;
+
+  for (int i = 0; i < 100000; ++i)
+    sampled += sampler.should_sample() ? 1 : 0;
+
+  EXPECT_NEAR(25000, sampled, 1500);
+  EXPECT_NEAR(0.25, sampler.probability(), 1e-9);
+}
+
+TEST(trace_sampler_test, rate_limiting) {
+  vc::trace_sampler sampler({vc::sampling_mode::rate_limiting, 10.0});
+  const auto start = vc::trace_sampler::clock::now();
+
+  // Starts with a second worth of traces.
+  EXPECT_EQ(10, count_samples(sampler, 100, start));
+
+  // Refills a trace every 100 ms.
+  EXPECT_EQ(1, count_samples(sampler, 100, start + 100ms));
+  EXPECT_EQ(5, count_samples(sampler, 100, start + 600ms));
+
+  // Never holds more than a second worth of traces.
+  EXPECT_EQ(10, count_samples(sampler, 100, start + 60s));
+}
+
+TEST(trace_sampler_test, adaptive) {
+  vc::trace_sampler sampler({vc::sampling_mode::adaptive, 100.0});
+  const auto start = vc::trace_sampler::clock::now();
+
+  // Samples everything until the request rate is known.
+  EXPECT_EQ(10000, count_samples(sampler, 10000, start));
+  EXPECT_DOUBLE_EQ(1.0, sampler.probability());
+
+  // 10000 requests per second, 100 traces per second wanted.
+  (void) sampler.should_sample(start + 1s);
+  EXPECT_NEAR(0.01, sampler.probability(), 1e-4);
+  EXPECT_NEAR(100, count_samples(sampler, 10000, start + 1500ms), 40);
+}
+
+TEST(trace_sampler_test, parse_sampler_config) {
+  const auto exp = vc::parse_sampler_config("rate_limiting", 50.0);
+
+  ASSERT_TRUE(exp.has_value());
+  EXPECT_EQ(vc::sampling_mode::rate_limiting, exp->mode);
+  EXPECT_DOUBLE_EQ(50.0, exp->param);
+
+  const auto exp_const = vc::parse_sampler_config("const", 0.0);
+
+  ASSERT_TRUE(exp_const.has_value());
+  EXPECT_EQ(vc::sampling_mode::never, exp_const->mode);
+
+  EXPECT_FALSE(vc::parse_sampler_config("probabilistic", 1.5).has_value());
+  EXPECT_FALSE(vc::parse_sampler_config("adaptive", 0.0).has_value());
+  EXPECT_FALSE(vc::parse_sampler_config("sometimes", 1.0).has_value());
+}
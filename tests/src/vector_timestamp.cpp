@@ -1,12 +1,18 @@
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
 #include <array>
+#include <memory_resource>
+#include <sstream>
+#include <utility>
 
 #include <gtest/gtest.h>
 
+#include "default_resource_guard.hpp"
 #include "hton.hpp"
+#include "log_level.hpp"
 #include "vector_timestamp.hpp"
 
 TEST(vector_timestamp_test, construction) {
@@ -36,10 +42,21 @@ TEST(vector_timestamp_test, deserialization_invalid_pair_count) {
 
   ASSERT_FALSE(exp.has_value());
 
+  EXPECT_EQ(vc::errc::invalid_pair_count, exp.error().code());
   EXPECT_EQ(std::string("The pair count given was invalid."),
             exp.error().message().substr(0, 33));
 }
 
+TEST(vector_timestamp_test, deserialization_overflowing_pair_count) {
+  // 2^60 pairs of 16 bytes would wrap around to 0 bytes.
+  const uint64_t pair_count = vc::hton(uint64_t(1) << 60U);
+  const auto exp = vc::vector_timestamp::deserialize_from_binary(
+    &pair_count, sizeof(pair_count));
+
+  ASSERT_FALSE(exp.has_value());
+  EXPECT_EQ(vc::errc::invalid_pair_count, exp.error().code());
+}
+
 TEST(vector_timestamp_test, deserialization) {
   uint64_t pair_count = 3;
 
@@ -128,6 +145,19 @@ TEST(vector_timestamp_test, tick) {
   EXPECT_EQ(expected_json, vstamp.to_json());
 }
 
+TEST(vector_timestamp_test, fmt_formatters) {
+  auto vstamp = vc::vector_timestamp::from_entries(
+    {{vc::actor_id{1}, 3}, {vc::actor_id{25}, 7}});
+
+  EXPECT_EQ(vstamp.to_json().toStdString(), fmt::format("{}", vstamp));
+  EXPECT_EQ("actor25", fmt::format("{}", vc::actor_id{25}));
+  EXPECT_EQ("WARNING", fmt::format("{}", vc::log_level::warning));
+
+  std::ostringstream oss;
+  oss << vstamp << ' ' << vc::actor_id{25};
+  EXPECT_EQ(fmt::format("{} actor25", vstamp), oss.str());
+}
+
 TEST(vector_timestamp_test, merge_should_add_new_clock) {
   vc::vector_timestamp vstamp1(vc::actor_id{1});
   const auto opt = vstamp1.tick(vc::actor_id{1});
@@ -165,6 +195,39 @@ TEST(vector_timestamp_test, merge_should_pick_maximum) {
   EXPECT_EQ(expected_json, vstamp1.to_json());
 }
 
+TEST(vector_timestamp_test, happened_before) {
+  const auto a = vc::vector_timestamp::from_entries(
+    {{vc::actor_id{1}, 1}, {vc::actor_id{2}, 0}});
+  const auto b = vc::vector_timestamp::from_entries(
+    {{vc::actor_id{1}, 1}, {vc::actor_id{2}, 1}});
+  const auto c = vc::vector_timestamp::from_entries({{vc::actor_id{1}, 2}});
+  const auto d = vc::vector_timestamp::from_entries(
+    {{vc::actor_id{1}, 1}, {vc::actor_id{3}, 1}});
+
+  EXPECT_TRUE(a.happened_before(b));
+  EXPECT_FALSE(b.happened_before(a));
+  EXPECT_FALSE(a.happened_before(a));
+  EXPECT_TRUE(a.happened_before(c));
+  EXPECT_FALSE(b.happened_before(c));
+  EXPECT_FALSE(c.happened_before(b));
+  EXPECT_TRUE(a.happened_before(d));
+  EXPECT_FALSE(d.happened_before(a));
+}
+
+TEST(vector_timestamp_test, size) {
+  vc::vector_timestamp vstamp(vc::actor_id{1});
+
+  EXPECT_EQ(1U, vstamp.size());
+
+  vstamp.merge(vc::vector_timestamp(vc::actor_id{2}));
+
+  EXPECT_EQ(2U, vstamp.size());
+
+  vstamp.merge(vc::vector_timestamp(vc::actor_id{1}));
+
+  EXPECT_EQ(2U, vstamp.size());
+}
+
 TEST(vector_timestamp_test, to_json) {
   const vc::vector_timestamp vstamp(vc::actor_id{0});
 
@@ -226,3 +289,78 @@ TEST(vector_timestamp_test, serialization) {
 
   EXPECT_EQ(vstamp, stamp);
 }
+
+TEST(vector_timestamp_test, little_endian_serialization) {
+  const std::unordered_map<vc::actor_id, uint64_t> map{
+    {vc::actor_id{0}, 5}, {vc::actor_id{1}, 8}, {vc::actor_id{2}, 20}};
+
+  const auto vstamp = create(map);
+
+  // Big-endian is the default.
+  EXPECT_EQ(vstamp.serialize_to_binary(),
+            vstamp.serialize_to_binary(vc::byte_order::big_endian));
+
+  const auto buffer = vstamp.serialize_to_binary(
+    vc::byte_order::little_endian);
+
+  ASSERT_EQ(56U, buffer.size());
+
+  // The pair count comes first.
+  EXPECT_EQ(0x03, buffer[0]);
+  EXPECT_EQ(0x00, buffer[7]);
+
+  const auto exp_stamp = vc::vector_timestamp::deserialize_from_binary(
+    buffer.data(), buffer.size(), vc::byte_order::little_endian);
+
+  ASSERT_TRUE(exp_stamp.has_value());
+  EXPECT_EQ(vstamp, *exp_stamp);
+
+  // Read in the wrong byte order the pair count is far too large.
+  EXPECT_FALSE(vc::vector_timestamp::deserialize_from_binary(
+                 buffer.data(), buffer.size(), vc::byte_order::big_endian)
+                 .has_value());
+}
+
+TEST(vector_timestamp_test, negotiate_byte_order) {
+  EXPECT_EQ(vc::host_byte_order,
+            vc::negotiate_byte_order(vc::offered_byte_orders));
+  EXPECT_EQ(vc::byte_order::big_endian,
+            vc::negotiate_byte_order(
+              static_cast<uint8_t>(vc::byte_order::big_endian)));
+  EXPECT_EQ(vc::byte_order::big_endian, vc::negotiate_byte_order(0));
+}
+
+TEST(vector_timestamp_test, deserialization_into_arena) {
+  const std::unordered_map<vc::actor_id, uint64_t> map{
+    {vc::actor_id{0}, 5}, {vc::actor_id{1}, 8}, {vc::actor_id{2}, 20}};
+
+  const auto vstamp = create(map);
+  const auto buffer = vstamp.serialize_to_binary();
+
+  std::array<std::byte, 4096> storage;
+  std::pmr::monotonic_buffer_resource arena(
+    storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+  const auto [exp_stamp, serialized] = [&buffer, &arena] {
+    // Any allocation that bypasses the arena throws.
+    const vc::test::default_resource_guard guard(
+      std::pmr::null_memory_resource());
+
+    auto exp = vc::vector_timestamp::deserialize_from_binary(
+      buffer.data(), buffer.size(), vc::byte_order::big_endian, &arena);
+    auto bytes
+      = exp.has_value()
+          ? exp->serialize_to_binary(vc::byte_order::big_endian, &arena)
+          : std::pmr::vector<pl::byte>(&arena);
+    return std::make_pair(std::move(exp), std::move(bytes));
+  }();
+
+  ASSERT_TRUE(exp_stamp.has_value());
+  EXPECT_EQ(vstamp, *exp_stamp);
+  EXPECT_EQ(buffer.size(), serialized.size());
+
+  // Copies don't use the arena.
+  const auto copy = *exp_stamp;
+  EXPECT_EQ(std::pmr::get_default_resource(),
+            copy.entries().get_allocator().resource());
+}
@@ -0,0 +1,102 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "write_queue.hpp"
+
+namespace {
+constexpr vc::watermarks limits{4, 8};
+} // namespace
+
+TEST(write_queue_test, construction) {
+  const vc::write_queue queue(limits);
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(0U, queue.pending_byte_count());
+  EXPECT_FALSE(queue.is_paused());
+}
+
+TEST(write_queue_test, push_and_pop) {
+  vc::write_queue queue(limits);
+
+  EXPECT_EQ(vc::write_queue::transition::none,
+            queue.push(std::vector<pl::byte>{0x01, 0x02}));
+  EXPECT_EQ(vc::write_queue::transition::none,
+            queue.push(std::vector<pl::byte>{0x03}));
+
+  ASSERT_FALSE(queue.empty());
+  EXPECT_EQ((std::vector<pl::byte>{0x01, 0x02}), queue.front());
+
+  queue.pop();
+
+  ASSERT_FALSE(queue.empty());
+  EXPECT_EQ(std::vector<pl::byte>{0x03}, queue.front());
+
+  queue.pop();
+
+  EXPECT_TRUE(queue.empty());
+
+  // Popped bytes are pending until they're acknowledged.
+  EXPECT_EQ(3U, queue.pending_byte_count());
+}
+
+TEST(write_queue_test, should_pause_at_high_watermark) {
+  vc::write_queue queue(limits);
+
+  EXPECT_EQ(vc::write_queue::transition::none,
+            queue.push(std::vector<pl::byte>(7)));
+  EXPECT_FALSE(queue.is_paused());
+
+  EXPECT_EQ(vc::write_queue::transition::paused,
+            queue.push(std::vector<pl::byte>(1)));
+  EXPECT_TRUE(queue.is_paused());
+
+  // Only the transition is reported.
+  EXPECT_EQ(vc::write_queue::transition::none,
+            queue.push(std::vector<pl::byte>(1)));
+  EXPECT_TRUE(queue.is_paused());
+  EXPECT_EQ(9U, queue.pending_byte_count());
+}
+
+TEST(write_queue_test, should_resume_at_low_watermark) {
+  vc::write_queue queue(limits);
+
+  ASSERT_EQ(vc::write_queue::transition::paused,
+            queue.push(std::vector<pl::byte>(10)));
+  queue.pop();
+
+  EXPECT_EQ(vc::write_queue::transition::none, queue.acknowledge(5));
+  EXPECT_TRUE(queue.is_paused());
+
+  EXPECT_EQ(vc::write_queue::transition::resumed, queue.acknowledge(1));
+  EXPECT_FALSE(queue.is_paused());
+  EXPECT_EQ(4U, queue.pending_byte_count());
+
+  EXPECT_EQ(vc::write_queue::transition::none, queue.acknowledge(4));
+  EXPECT_EQ(0U, queue.pending_byte_count());
+}
+
+TEST(write_queue_test, acknowledge_should_not_underflow) {
+  vc::write_queue queue(limits);
+
+  ASSERT_EQ(vc::write_queue::transition::none,
+            queue.push(std::vector<pl::byte>(2)));
+
+  EXPECT_EQ(vc::write_queue::transition::none, queue.acknowledge(5));
+  EXPECT_EQ(0U, queue.pending_byte_count());
+}
+
+TEST(write_queue_test, should_share_frames) {
+  vc::write_queue queue1(limits);
+  vc::write_queue queue2(limits);
+
+  const auto frame = std::make_shared<const std::vector<pl::byte>>(
+    std::vector<pl::byte>{0x01, 0x02, 0x03});
+
+  EXPECT_EQ(vc::write_queue::transition::none, queue1.push(frame));
+  EXPECT_EQ(vc::write_queue::transition::none, queue2.push(frame));
+
+  EXPECT_EQ(3U, queue1.pending_byte_count());
+  EXPECT_EQ(3U, queue2.pending_byte_count());
+  EXPECT_EQ(&queue1.front(), &queue2.front());
+}